@@ -2,5 +2,5 @@
 mkdir -p build
 cd build
 cmake -S ../ -B .
-make && make Shaders && ./VulkanEngine
+make && make Shaders && make Textures && ./VulkanEngine
 cd ..
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout (location = 0) in vec3 fragColor;
 layout (location = 1) in vec3 fragWorldPos;
@@ -23,12 +24,14 @@ layout(set = 0, binding = 0) uniform GlobalUbo
 	int numLights;
 } ubo;
 
-layout(binding = 1) uniform sampler2D texSampler;
+// TextureManager's bindless array, indexed per draw so the index is uniform
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
 layout(push_constant) uniform Push
 {
 	mat4 modelMatrix;
-	mat4 normalMatrix;
+	mat3 normalMatrix;
+	uint textureIndex;
 } push;
 
 void main()
@@ -56,5 +59,5 @@ void main()
 //	}
 //
 //	outColor = vec4(fragColor * (diffuseLight + specularLight), 1.0);
-	outColor = texture(texSampler, fragTexCoord);;
+	outColor = texture(textures[push.textureIndex], fragTexCoord);
 }
\ No newline at end of file
@@ -29,7 +29,8 @@ layout(set = 0, binding = 0) uniform GlobalUbo
 layout(push_constant) uniform Push
 {
 	mat4 modelMatrix;
-	mat4 normalMatrix;
+	mat3 normalMatrix;
+	uint textureIndex;
 } push;
 
 void main()
@@ -0,0 +1,57 @@
+#version 450
+
+// Model::CompactVertex, positions are dequantized by the model matrix
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 normal;
+layout(location = 3) in vec2 texcoord;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragWorldPos;
+layout(location = 2) out vec3 fragWorldNormal;
+layout(location = 3) out vec2 fragTexCoord;
+
+struct PointLight
+{
+	vec4 position;
+	vec4 color;
+};
+
+layout(set = 0, binding = 0) uniform GlobalUbo
+{
+	mat4 project;
+	mat4 view;
+	mat4 invView;
+	vec4 ambientLightColor;
+	PointLight pointLights[10];
+	int numLights;
+} ubo;
+
+layout(push_constant) uniform Push
+{
+	mat4 modelMatrix;
+	mat3 normalMatrix;
+	uint textureIndex;
+} push;
+
+vec3 octahedralDecode(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	if(n.z < 0.0)
+	{
+		n.xy = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	vec4 wPos = push.modelMatrix * vec4(position.xyz, 1.0);
+
+	gl_Position = ubo.project * ubo.view * wPos;
+
+	fragColor = color.rgb;
+	fragWorldPos = wPos.xyz;
+	fragWorldNormal = normalize(mat3(push.normalMatrix) * octahedralDecode(normal));
+	fragTexCoord = texcoord;
+}
@@ -22,7 +22,6 @@ namespace VulkanEngine
 
 App::App()
 {
-	globalPool.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2 * Device::MAX_FRAMES_IN_FLIGHT);
 	globalPool.addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, Device::MAX_FRAMES_IN_FLIGHT);
 	globalPool.setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
 	globalPool.build();
@@ -37,8 +36,11 @@ App::~App()
 
 void App::run()
 {
-	GameObjectPass gameObjectPass{ device, globalPool };
-	PointLightPass pointLightPass{ device, globalPool };
+	GameObjectPass gameObjectPass{ device, uniformRing, geometryArena, textureManager };
+	PointLightPass pointLightPass{ device, uniformRing };
+
+	// everything loaded so far goes to the GPU in one submission
+	uploadBatch.flush();
 	Camera camera{};
 
 	// for store the camera state
@@ -53,6 +55,9 @@ void App::run()
 	while(!window.shouldClose())
 	{
 		glfwPollEvents();
+		assetStreamer.update();
+		textureManager.update();
+		geometryArena.update();
 
 		auto currTime = std::chrono::high_resolution_clock::now();
 		float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(currTime - lastTime).count();
@@ -67,6 +72,7 @@ void App::run()
 		if(VkCommandBuffer commandBuffer = device.beginFrame())
 		{
 			int frameIndex = device.getFrameIndex();
+			uniformRing.beginFrame(frameIndex);
 
 			FrameInfo frameInfo{ frameIndex, frameTime, commandBuffer, camera, gameObjects };
 
@@ -80,6 +86,8 @@ void App::run()
 			ui.render(frameInfo);
 
 			device.endRenderPass(commandBuffer);
+			// everything the passes pushed reaches the device with the submission
+			uniformRing.flush();
 			device.endFrame();
 		}
 	}
@@ -89,23 +97,26 @@ void App::run()
 
 void App::loadGameObjects()
 {
-	std::shared_ptr<Model> pModel = Model::createModelFromFile(device, "models/flat_vase.obj");
+	Model::LoadConfig flatVaseConfig{};
+	flatVaseConfig.generateLods = true;
 	GameObject flatVase = GameObject::createGameObject();
-	flatVase.pModel = pModel;
+	streamModel(flatVase, "models/flat_vase.obj", flatVaseConfig);
 	flatVase.transform.translation = { -0.5f, 0.5f, 0.0f };
 	flatVase.transform.scale = { 3.0f, 1.5f, 3.0f };
 	gameObjects.emplace(flatVase.getId(), std::move(flatVase));
 
-	pModel = Model::createModelFromFile(device, "models/smooth_vase.obj");
+	Model::LoadConfig smoothVaseConfig{};
+	smoothVaseConfig.vertexFormat = Model::VertexFormat::Compact;
+	smoothVaseConfig.buildMeshlets = true;
+	smoothVaseConfig.generateLods = true;
 	GameObject smoothVase = GameObject::createGameObject();
-	smoothVase.pModel = pModel;
+	streamModel(smoothVase, "models/smooth_vase.obj", smoothVaseConfig);
 	smoothVase.transform.translation = { 0.5f, 0.5f, 0.0f };
 	smoothVase.transform.scale = { 3.0f, 1.5f, 3.0f };
 	gameObjects.emplace(smoothVase.getId(), std::move(smoothVase));
 
-	pModel = Model::createModelFromFile(device, "models/quad.obj");
 	GameObject quad = GameObject::createGameObject();
-	quad.pModel = pModel;
+	streamModel(quad, "models/quad.obj");
 	quad.transform.translation = { 0.0f, 0.5f, 0.0f };
 	quad.transform.scale = { 3.0f, 1.0f, 3.0f };
 	gameObjects.emplace(quad.getId(), std::move(quad));
@@ -133,4 +144,17 @@ void App::loadGameObjects()
 	}
 }
 
+void App::streamModel(GameObject& gameObject, const std::string& filepath, const Model::LoadConfig& config)
+{
+	GameObject::id_t id = gameObject.getId();
+	assetStreamer.loadModel(filepath, config, [this, id](std::shared_ptr<Model> pModel)
+	{
+		auto it = gameObjects.find(id);
+		if(it != gameObjects.end())
+		{
+			it->second.pModel = pModel;
+		}
+	});
+}
+
 }
\ No newline at end of file
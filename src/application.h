@@ -4,6 +4,12 @@
 #include "device.h"
 #include "gameobject.h"
 #include "descriptor.h"
+#include "uploadBatch.h"
+#include "uniformRing.h"
+#include "textureManager.h"
+#include "geometryArena.h"
+#include "modelRegistry.h"
+#include "assetStreamer.h"
 #include "ui.h"
 
 #include <memory>
@@ -28,11 +34,19 @@ public:
 
 private:
 	void loadGameObjects();
+	// The model is attached once streamed in, the object is skipped by the passes until then
+	void streamModel(GameObject& gameObject, const std::string& filepath, const Model::LoadConfig& config = {});
 
 	Window window{ WIDTH, HEIGHT, "Vulkan Window" };
 	Device device{ window };
 
 	DescriptorPool globalPool{ device };
+	UniformRing uniformRing{ device };
+	UploadBatch uploadBatch{ device };
+	TextureManager textureManager{ device, uploadBatch };
+	GeometryArena geometryArena{ device, uploadBatch };
+	ModelRegistry modelRegistry{ geometryArena };
+	AssetStreamer assetStreamer{ device, geometryArena, modelRegistry };
 	GameObject::Map gameObjects;
 };
 
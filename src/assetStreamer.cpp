@@ -0,0 +1,211 @@
+#include "assetStreamer.h"
+
+#include "threadPool.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+AssetStreamer::AssetStreamer(Device& device, GeometryArena& geometryArena, ModelRegistry& modelRegistry) :
+	m_device(device), m_geometryArena(geometryArena), m_modelRegistry(modelRegistry)
+{
+
+}
+
+AssetStreamer::~AssetStreamer()
+{
+	// tasks only wait on files and the CPU, so they finish without further updates
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_tasksDone.wait(lock, [this] { return m_runningTasks == 0; });
+	}
+
+	for(TransferBatch& batch : m_batches)
+	{
+		vkWaitForFences(m_device.getDevice(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+		vkDestroyFence(m_device.getDevice(), batch.fence, nullptr);
+		vkFreeCommandBuffers(m_device.getDevice(), m_device.getCommandPool(), 1, &batch.commandBuffer);
+
+		for(std::shared_ptr<PendingModel>& pPending : batch.models)
+		{
+			m_geometryArena.releaseUpload(pPending->upload);
+		}
+	}
+
+	// staged but never submitted
+	for(std::shared_ptr<PendingModel>& pPending : m_staged)
+	{
+		m_geometryArena.releaseUpload(pPending->upload);
+	}
+}
+
+void AssetStreamer::loadModel(const std::string& filepath, const Model::LoadConfig& config, ModelCallback onLoaded)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_runningTasks++;
+		m_pendingCount++;
+	}
+
+	ThreadPool::get().submit([this, filepath, config, onLoaded]()
+	{
+		loadInBackground(filepath, config, onLoaded);
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_runningTasks--;
+		m_tasksDone.notify_all();
+	});
+}
+
+void AssetStreamer::loadInBackground(const std::string& filepath, const Model::LoadConfig& config, ModelCallback onLoaded)
+{
+	std::shared_ptr<PendingModel> pPending;
+	try
+	{
+		uint64_t contentKey = m_modelRegistry.getContentKey(filepath, config);
+
+		// update() registers a finished model before it stops tracking its load, so one of the two always finds it
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		auto loadingIt = m_loading.find(contentKey);
+		if(loadingIt != m_loading.end())
+		{
+			loadingIt->second->callbacks.push_back(onLoaded);
+			return;
+		}
+
+		if(std::shared_ptr<Model> pModel = m_modelRegistry.find(contentKey))
+		{
+			m_ready.push_back({ pModel, onLoaded });
+			return;
+		}
+
+		pPending = std::make_shared<PendingModel>();
+		pPending->contentKey = contentKey;
+		pPending->callbacks.push_back(onLoaded);
+		m_loading[contentKey] = pPending;
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "failed to stream " << filepath << ": " << e.what() << std::endl;
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_pendingCount--;
+		return;
+	}
+
+	try
+	{
+		std::shared_ptr<Model> pModel = Model::createModelFromFile(m_geometryArena, filepath, config, pPending->upload);
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		pPending->pModel = std::move(pModel);
+		m_staged.push_back(pPending);
+	}
+	catch(const std::exception& e)
+	{
+		std::cerr << "failed to stream " << filepath << ": " << e.what() << std::endl;
+		m_geometryArena.releaseUpload(pPending->upload);
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_pendingCount -= static_cast<uint32_t>(pPending->callbacks.size());
+		m_loading.erase(pPending->contentKey);
+	}
+}
+
+void AssetStreamer::update()
+{
+	std::vector<std::shared_ptr<PendingModel>> staged;
+	std::vector<ReadyModel> ready;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		staged.swap(m_staged);
+		ready.swap(m_ready);
+	}
+
+	if(!staged.empty())
+	{
+		submitBatch(staged);
+	}
+
+	for(auto batchIt = m_batches.begin(); batchIt != m_batches.end();)
+	{
+		if(vkGetFenceStatus(m_device.getDevice(), batchIt->fence) != VK_SUCCESS)
+		{
+			++batchIt;
+			continue;
+		}
+
+		vkDestroyFence(m_device.getDevice(), batchIt->fence, nullptr);
+		vkFreeCommandBuffers(m_device.getDevice(), m_device.getCommandPool(), 1, &batchIt->commandBuffer);
+
+		for(std::shared_ptr<PendingModel>& pPending : batchIt->models)
+		{
+			m_geometryArena.releaseUpload(pPending->upload);
+			std::shared_ptr<Model> pModel = m_modelRegistry.insert(pPending->contentKey, pPending->pModel);
+
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_loading.erase(pPending->contentKey);
+			for(ModelCallback& callback : pPending->callbacks)
+			{
+				ready.push_back({ pModel, std::move(callback) });
+			}
+		}
+
+		batchIt = m_batches.erase(batchIt);
+	}
+
+	for(ReadyModel& readyModel : ready)
+	{
+		readyModel.callback(readyModel.pModel);
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_pendingCount -= static_cast<uint32_t>(ready.size());
+}
+
+void AssetStreamer::submitBatch(std::vector<std::shared_ptr<PendingModel>>& models)
+{
+	TransferBatch batch{};
+	batch.commandBuffer = m_device.beginSingleTimeCommands();
+
+	for(const std::shared_ptr<PendingModel>& pPending : models)
+	{
+		m_geometryArena.recordUpload(batch.commandBuffer, pPending->upload);
+	}
+
+	// draws in later submissions read the copied ranges
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+	vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+	vkEndCommandBuffer(batch.commandBuffer);
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	if(vkCreateFence(m_device.getDevice(), &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create transfer fence!");
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &batch.commandBuffer;
+	if(vkQueueSubmit(m_device.getGraphicsQueue(), 1, &submitInfo, batch.fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit transfer batch!");
+	}
+
+	batch.models = std::move(models);
+	m_batches.push_back(std::move(batch));
+}
+
+uint32_t AssetStreamer::getPendingCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_pendingCount;
+}
+
+}
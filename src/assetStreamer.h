@@ -0,0 +1,84 @@
+#pragma once
+
+#include "device.h"
+#include "geometryArena.h"
+#include "modelRegistry.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Loads models in the background, so the frame loop never waits on file I/O, parsing or uploads.
+// Files are hashed, imported and written to staging memory on the engine thread pool. Each update() records the copies
+// staged since the last one into a single command buffer, submits it with a fence and hands out the models of batches
+// whose fence has signaled, so a model only reaches the scene once its geometry is on the GPU.
+// Models already in the registry are handed out without loading, and concurrent requests for the same content share one load.
+class AssetStreamer
+{
+public:
+	// Runs on the thread calling update()
+	using ModelCallback = std::function<void(std::shared_ptr<Model>)>;
+
+	AssetStreamer(Device& device, GeometryArena& geometryArena, ModelRegistry& modelRegistry);
+	~AssetStreamer();
+
+	AssetStreamer(const AssetStreamer&) = delete;
+	AssetStreamer& operator=(const AssetStreamer&) = delete;
+
+	// Failed loads are reported on std::cerr and never call back
+	void loadModel(const std::string& filepath, const Model::LoadConfig& config, ModelCallback onLoaded);
+
+	// Call once per frame on the thread that submits to the graphics queue, it never blocks on the GPU
+	void update();
+
+	// Requests that have not called back yet
+	uint32_t getPendingCount() const;
+
+private:
+	struct PendingModel
+	{
+		uint64_t contentKey = 0;
+		std::shared_ptr<Model> pModel;
+		GeometryArena::StagedUpload upload;
+		std::vector<ModelCallback> callbacks;
+	};
+
+	struct TransferBatch
+	{
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		std::vector<std::shared_ptr<PendingModel>> models;
+	};
+
+	struct ReadyModel
+	{
+		std::shared_ptr<Model> pModel;
+		ModelCallback callback;
+	};
+
+	void loadInBackground(const std::string& filepath, const Model::LoadConfig& config, ModelCallback onLoaded);
+	void submitBatch(std::vector<std::shared_ptr<PendingModel>>& models);
+
+	Device& m_device;
+	GeometryArena& m_geometryArena;
+	ModelRegistry& m_modelRegistry;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_tasksDone;
+	uint32_t m_runningTasks = 0;
+	uint32_t m_pendingCount = 0;
+	std::unordered_map<uint64_t, std::shared_ptr<PendingModel>> m_loading;	// by content key, until handed out
+	std::vector<std::shared_ptr<PendingModel>> m_staged;	// waiting for the next update to submit them
+	std::vector<ReadyModel> m_ready;	// found in the registry, handed out on the next update
+
+	std::vector<TransferBatch> m_batches;	// in flight, only touched by update()
+};
+
+}
@@ -0,0 +1,775 @@
+#include "blockCompression.h"
+
+#include "threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+static constexpr uint32_t TEXELS_PER_BLOCK = 16;
+// least squares rounds refining the endpoints, later rounds rarely improve them
+static constexpr int REFINE_ITERATIONS = 2;
+
+// interpolation weights of BC7 4 bit indices, in 64ths of the second endpoint
+static const uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+uint32_t getBlockSize(BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+size_t getCompressedSize(BlockFormat format, uint32_t width, uint32_t height)
+{
+	return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+bool getBlockFormat(VkFormat vkFormat, BlockFormat& format)
+{
+	switch(vkFormat)
+	{
+	case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		format = BlockFormat::BC1;
+		return true;
+	case VK_FORMAT_BC3_UNORM_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		format = BlockFormat::BC3;
+		return true;
+	case VK_FORMAT_BC7_UNORM_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		format = BlockFormat::BC7;
+		return true;
+	default:
+		return false;
+	}
+}
+
+VkFormat getVkFormat(BlockFormat format, bool srgb)
+{
+	switch(format)
+	{
+	case BlockFormat::BC1:
+		return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+	case BlockFormat::BC3:
+		return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+	default:
+		return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+	}
+}
+
+bool isSrgbFormat(VkFormat vkFormat)
+{
+	switch(vkFormat)
+	{
+	case VK_FORMAT_R8G8B8A8_SRGB:
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+	case VK_FORMAT_BC7_SRGB_BLOCK:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Little endian bit stream over a 16 byte block, as BC7 fields are laid out
+class BlockBits
+{
+public:
+	BlockBits(uint8_t* data) : m_data(data) {}
+
+	void write(uint32_t value, uint32_t bitCount)
+	{
+		for(uint32_t i = 0; i < bitCount; i++, m_position++)
+		{
+			if((value >> i) & 1)
+			{
+				m_data[m_position >> 3] |= static_cast<uint8_t>(1 << (m_position & 7));
+			}
+		}
+	}
+
+	uint32_t read(uint32_t bitCount)
+	{
+		uint32_t value = 0;
+		for(uint32_t i = 0; i < bitCount; i++, m_position++)
+		{
+			value |= ((m_data[m_position >> 3] >> (m_position & 7)) & 1u) << i;
+		}
+		return value;
+	}
+
+private:
+	uint8_t* m_data;
+	uint32_t m_position = 0;
+};
+
+// Mean and dominant direction of the texels in their first channelCount channels, a zero axis for uniform blocks
+static void computePrincipalAxis(const float (*texels)[4], uint32_t channelCount, float* mean, float* axis)
+{
+	for(uint32_t c = 0; c < 4; c++)
+	{
+		mean[c] = 0.0f;
+		axis[c] = 0.0f;
+	}
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		for(uint32_t c = 0; c < channelCount; c++)
+		{
+			mean[c] += texels[i][c] / TEXELS_PER_BLOCK;
+		}
+	}
+
+	float covariance[4][4] = {};
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		for(uint32_t a = 0; a < channelCount; a++)
+		{
+			for(uint32_t b = 0; b < channelCount; b++)
+			{
+				covariance[a][b] += (texels[i][a] - mean[a]) * (texels[i][b] - mean[b]);
+			}
+		}
+	}
+
+	// power iteration, started from the channel spreads so it is never orthogonal to the answer
+	float direction[4] = {};
+	for(uint32_t c = 0; c < channelCount; c++)
+	{
+		direction[c] = covariance[c][c];
+	}
+
+	for(int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {};
+		float length = 0.0f;
+		for(uint32_t a = 0; a < channelCount; a++)
+		{
+			for(uint32_t b = 0; b < channelCount; b++)
+			{
+				next[a] += covariance[a][b] * direction[b];
+			}
+			length += next[a] * next[a];
+		}
+
+		if(length < 1e-12f)
+		{
+			return;
+		}
+		length = std::sqrt(length);
+		for(uint32_t c = 0; c < channelCount; c++)
+		{
+			direction[c] = next[c] / length;
+		}
+	}
+
+	for(uint32_t c = 0; c < channelCount; c++)
+	{
+		axis[c] = direction[c];
+	}
+}
+
+// Endpoints at the extreme projections of the texels onto the principal axis
+static void fitEndpoints(const float (*texels)[4], uint32_t channelCount, float* endpoint0, float* endpoint1)
+{
+	float mean[4];
+	float axis[4];
+	computePrincipalAxis(texels, channelCount, mean, axis);
+
+	float minProjection = 0.0f;
+	float maxProjection = 0.0f;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		float projection = 0.0f;
+		for(uint32_t c = 0; c < channelCount; c++)
+		{
+			projection += (texels[i][c] - mean[c]) * axis[c];
+		}
+		minProjection = std::min(minProjection, projection);
+		maxProjection = std::max(maxProjection, projection);
+	}
+
+	for(uint32_t c = 0; c < channelCount; c++)
+	{
+		endpoint0[c] = std::clamp(mean[c] + axis[c] * maxProjection, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp(mean[c] + axis[c] * minProjection, 0.0f, 255.0f);
+	}
+}
+
+// Endpoints minimizing the squared error for fixed indices, weights[i] being the share of endpoint0 in texel i.
+// Returns false when the indices do not determine them, as when all of them are equal.
+static bool solveEndpoints(const float (*texels)[4], uint32_t channelCount, const float* weights, float* endpoint0, float* endpoint1)
+{
+	float aa = 0.0f;
+	float ab = 0.0f;
+	float bb = 0.0f;
+	float ap[4] = {};
+	float bp[4] = {};
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		float a = weights[i];
+		float b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for(uint32_t c = 0; c < channelCount; c++)
+		{
+			ap[c] += a * texels[i][c];
+			bp[c] += b * texels[i][c];
+		}
+	}
+
+	float determinant = aa * bb - ab * ab;
+	if(std::abs(determinant) < 1e-6f)
+	{
+		return false;
+	}
+
+	for(uint32_t c = 0; c < channelCount; c++)
+	{
+		endpoint0[c] = std::clamp((ap[c] * bb - bp[c] * ab) / determinant, 0.0f, 255.0f);
+		endpoint1[c] = std::clamp((bp[c] * aa - ap[c] * ab) / determinant, 0.0f, 255.0f);
+	}
+	return true;
+}
+
+static void toFloatTexels(const uint8_t* texels, float (*values)[4])
+{
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			values[i][c] = texels[i * 4 + c];
+		}
+	}
+}
+
+// BC1 color
+
+static uint16_t packRgb565(const float* color)
+{
+	uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+	uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+	uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpackRgb565(uint16_t packed, int32_t* color)
+{
+	int32_t r = (packed >> 11) & 31;
+	int32_t g = (packed >> 5) & 63;
+	int32_t b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// Palette of a color block, four colors unless opaque is false and color0 <= color1
+static void getColorPalette(uint16_t color0, uint16_t color1, bool fourColors, int32_t (*palette)[4])
+{
+	unpackRgb565(color0, palette[0]);
+	unpackRgb565(color1, palette[1]);
+	palette[0][3] = 255;
+	palette[1][3] = 255;
+	palette[2][3] = 255;
+
+	if(fourColors || color0 > color1)
+	{
+		palette[3][3] = 255;
+		for(uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	}
+	else
+	{
+		palette[3][3] = 0;
+		for(uint32_t c = 0; c < 3; c++)
+		{
+			palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+			palette[3][c] = 0;
+		}
+	}
+}
+
+// Nearest four color palette entry of every texel, returns the summed squared error
+static float assignColorIndices(const float (*texels)[4], uint16_t color0, uint16_t color1, uint32_t* indices)
+{
+	int32_t palette[4][4];
+	getColorPalette(color0, color1, true, palette);
+
+	float totalError = 0.0f;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		float bestError = INFINITY;
+		for(uint32_t k = 0; k < 4; k++)
+		{
+			float error = 0.0f;
+			for(uint32_t c = 0; c < 3; c++)
+			{
+				float difference = texels[i][c] - palette[k][c];
+				error += difference * difference;
+			}
+			if(error < bestError)
+			{
+				bestError = error;
+				indices[i] = k;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+// Writes an 8 byte color block in four color mode, which BC3 always decodes it as
+static void encodeColorBlock(const float (*texels)[4], uint8_t* block)
+{
+	static const float ENDPOINT0_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float endpoint0[4];
+	float endpoint1[4];
+	fitEndpoints(texels, 3, endpoint0, endpoint1);
+
+	uint16_t color0 = packRgb565(endpoint0);
+	uint16_t color1 = packRgb565(endpoint1);
+	uint32_t indices[TEXELS_PER_BLOCK];
+	float error = assignColorIndices(texels, color0, color1, indices);
+
+	for(int iteration = 0; iteration < REFINE_ITERATIONS; iteration++)
+	{
+		float weights[TEXELS_PER_BLOCK];
+		for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+		{
+			weights[i] = ENDPOINT0_WEIGHTS[indices[i]];
+		}
+		if(!solveEndpoints(texels, 3, weights, endpoint0, endpoint1))
+		{
+			break;
+		}
+
+		uint16_t refined0 = packRgb565(endpoint0);
+		uint16_t refined1 = packRgb565(endpoint1);
+		uint32_t refinedIndices[TEXELS_PER_BLOCK];
+		float refinedError = assignColorIndices(texels, refined0, refined1, refinedIndices);
+		if(refinedError >= error)
+		{
+			break;
+		}
+
+		color0 = refined0;
+		color1 = refined1;
+		error = refinedError;
+		std::memcpy(indices, refinedIndices, sizeof(indices));
+	}
+
+	// four color mode needs color0 > color1, swapping the endpoints swaps indices 0 and 1 as well as 2 and 3
+	if(color0 < color1)
+	{
+		std::swap(color0, color1);
+		for(uint32_t& index : indices)
+		{
+			index ^= 1;
+		}
+	}
+	else if(color0 == color1)
+	{
+		// decodes in three color mode, where index 3 is transparent
+		std::fill(indices, indices + TEXELS_PER_BLOCK, 0);
+	}
+
+	uint32_t packedIndices = 0;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		packedIndices |= indices[i] << (2 * i);
+	}
+
+	std::memcpy(block, &color0, 2);
+	std::memcpy(block + 2, &color1, 2);
+	std::memcpy(block + 4, &packedIndices, 4);
+}
+
+static void decodeColorBlock(const uint8_t* block, bool fourColors, uint8_t* texels)
+{
+	uint16_t color0;
+	uint16_t color1;
+	uint32_t packedIndices;
+	std::memcpy(&color0, block, 2);
+	std::memcpy(&color1, block + 2, 2);
+	std::memcpy(&packedIndices, block + 4, 4);
+
+	int32_t palette[4][4];
+	getColorPalette(color0, color1, fourColors, palette);
+
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		const int32_t* color = palette[(packedIndices >> (2 * i)) & 3];
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			texels[i * 4 + c] = static_cast<uint8_t>(color[c]);
+		}
+	}
+}
+
+// BC3 alpha
+
+static void getAlphaPalette(uint32_t alpha0, uint32_t alpha1, uint32_t* palette)
+{
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	if(alpha0 > alpha1)
+	{
+		for(uint32_t k = 2; k < 8; k++)
+		{
+			palette[k] = ((8 - k) * alpha0 + (k - 1) * alpha1) / 7;
+		}
+	}
+	else
+	{
+		for(uint32_t k = 2; k < 6; k++)
+		{
+			palette[k] = ((6 - k) * alpha0 + (k - 1) * alpha1) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+}
+
+static void encodeAlphaBlock(const uint8_t* texels, uint8_t* block)
+{
+	uint32_t minAlpha = 255;
+	uint32_t maxAlpha = 0;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		minAlpha = std::min<uint32_t>(minAlpha, texels[i * 4 + 3]);
+		maxAlpha = std::max<uint32_t>(maxAlpha, texels[i * 4 + 3]);
+	}
+
+	// eight interpolated values, a uniform block just uses index 0
+	uint32_t palette[8];
+	getAlphaPalette(maxAlpha, minAlpha, palette);
+
+	uint64_t packedIndices = 0;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK && maxAlpha > minAlpha; i++)
+	{
+		uint32_t alpha = texels[i * 4 + 3];
+		uint32_t bestIndex = 0;
+		uint32_t bestError = UINT32_MAX;
+		for(uint32_t k = 0; k < 8; k++)
+		{
+			uint32_t error = alpha > palette[k] ? alpha - palette[k] : palette[k] - alpha;
+			if(error < bestError)
+			{
+				bestError = error;
+				bestIndex = k;
+			}
+		}
+		packedIndices |= static_cast<uint64_t>(bestIndex) << (3 * i);
+	}
+
+	block[0] = static_cast<uint8_t>(maxAlpha);
+	block[1] = static_cast<uint8_t>(minAlpha);
+	std::memcpy(block + 2, &packedIndices, 6);
+}
+
+static void decodeAlphaBlock(const uint8_t* block, uint8_t* texels)
+{
+	uint32_t palette[8];
+	getAlphaPalette(block[0], block[1], palette);
+
+	uint64_t packedIndices = 0;
+	std::memcpy(&packedIndices, block + 2, 6);
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		texels[i * 4 + 3] = static_cast<uint8_t>(palette[(packedIndices >> (3 * i)) & 7]);
+	}
+}
+
+void encodeBC1Block(const uint8_t* texels, uint8_t* block)
+{
+	float values[TEXELS_PER_BLOCK][4];
+	toFloatTexels(texels, values);
+	encodeColorBlock(values, block);
+}
+
+void encodeBC3Block(const uint8_t* texels, uint8_t* block)
+{
+	float values[TEXELS_PER_BLOCK][4];
+	toFloatTexels(texels, values);
+	encodeAlphaBlock(texels, block);
+	encodeColorBlock(values, block + 8);
+}
+
+void decodeBC1Block(const uint8_t* block, uint8_t* texels)
+{
+	decodeColorBlock(block, false, texels);
+}
+
+void decodeBC3Block(const uint8_t* block, uint8_t* texels)
+{
+	decodeColorBlock(block + 8, true, texels);
+	decodeAlphaBlock(block, texels);
+}
+
+// BC7 mode 6: one subset, 7 bit RGBA endpoints with a shared bit each, 4 bit indices
+
+struct Bc7Endpoint
+{
+	uint32_t values[4];	// 7 bit channels
+	uint32_t pBit;
+
+	uint32_t get(uint32_t channel) const { return (values[channel] << 1) | pBit; }
+};
+
+static Bc7Endpoint quantizeBc7Endpoint(const float* endpoint)
+{
+	Bc7Endpoint best{};
+	float bestError = INFINITY;
+	for(uint32_t pBit = 0; pBit < 2; pBit++)
+	{
+		Bc7Endpoint candidate{};
+		candidate.pBit = pBit;
+		float error = 0.0f;
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			float value = std::floor((endpoint[c] - pBit) * 0.5f + 0.5f);
+			candidate.values[c] = static_cast<uint32_t>(std::clamp(value, 0.0f, 127.0f));
+			float difference = static_cast<float>(candidate.get(c)) - endpoint[c];
+			error += difference * difference;
+		}
+		if(error < bestError)
+		{
+			bestError = error;
+			best = candidate;
+		}
+	}
+	return best;
+}
+
+static uint32_t interpolateBc7(uint32_t value0, uint32_t value1, uint32_t weight)
+{
+	return ((64 - weight) * value0 + weight * value1 + 32) >> 6;
+}
+
+static float assignBc7Indices(const float (*texels)[4], const Bc7Endpoint& endpoint0, const Bc7Endpoint& endpoint1, uint32_t* indices)
+{
+	float palette[16][4];
+	for(uint32_t k = 0; k < 16; k++)
+	{
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			palette[k][c] = static_cast<float>(interpolateBc7(endpoint0.get(c), endpoint1.get(c), BC7_WEIGHTS4[k]));
+		}
+	}
+
+	float totalError = 0.0f;
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		float bestError = INFINITY;
+		for(uint32_t k = 0; k < 16; k++)
+		{
+			float error = 0.0f;
+			for(uint32_t c = 0; c < 4; c++)
+			{
+				float difference = texels[i][c] - palette[k][c];
+				error += difference * difference;
+			}
+			if(error < bestError)
+			{
+				bestError = error;
+				indices[i] = k;
+			}
+		}
+		totalError += bestError;
+	}
+	return totalError;
+}
+
+void encodeBC7Block(const uint8_t* texels, uint8_t* block)
+{
+	float values[TEXELS_PER_BLOCK][4];
+	toFloatTexels(texels, values);
+
+	float endpoint0[4];
+	float endpoint1[4];
+	fitEndpoints(values, 4, endpoint0, endpoint1);
+
+	Bc7Endpoint quantized0 = quantizeBc7Endpoint(endpoint0);
+	Bc7Endpoint quantized1 = quantizeBc7Endpoint(endpoint1);
+	uint32_t indices[TEXELS_PER_BLOCK];
+	float error = assignBc7Indices(values, quantized0, quantized1, indices);
+
+	for(int iteration = 0; iteration < REFINE_ITERATIONS; iteration++)
+	{
+		float weights[TEXELS_PER_BLOCK];
+		for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+		{
+			weights[i] = 1.0f - BC7_WEIGHTS4[indices[i]] / 64.0f;
+		}
+		if(!solveEndpoints(values, 4, weights, endpoint0, endpoint1))
+		{
+			break;
+		}
+
+		Bc7Endpoint refined0 = quantizeBc7Endpoint(endpoint0);
+		Bc7Endpoint refined1 = quantizeBc7Endpoint(endpoint1);
+		uint32_t refinedIndices[TEXELS_PER_BLOCK];
+		float refinedError = assignBc7Indices(values, refined0, refined1, refinedIndices);
+		if(refinedError >= error)
+		{
+			break;
+		}
+
+		quantized0 = refined0;
+		quantized1 = refined1;
+		error = refinedError;
+		std::memcpy(indices, refinedIndices, sizeof(indices));
+	}
+
+	// the first index is stored without its top bit, swapping the endpoints mirrors all indices
+	if(indices[0] >= 8)
+	{
+		std::swap(quantized0, quantized1);
+		for(uint32_t& index : indices)
+		{
+			index = 15 - index;
+		}
+	}
+
+	std::memset(block, 0, 16);
+	BlockBits bits{ block };
+	bits.write(1 << 6, 7);
+	for(uint32_t c = 0; c < 4; c++)
+	{
+		bits.write(quantized0.values[c], 7);
+		bits.write(quantized1.values[c], 7);
+	}
+	bits.write(quantized0.pBit, 1);
+	bits.write(quantized1.pBit, 1);
+
+	bits.write(indices[0], 3);
+	for(uint32_t i = 1; i < TEXELS_PER_BLOCK; i++)
+	{
+		bits.write(indices[i], 4);
+	}
+}
+
+void decodeBC7Block(const uint8_t* block, uint8_t* texels)
+{
+	// the mode is the number of zero bits before the first set one
+	if((block[0] & 0x7f) != 0x40)
+	{
+		throw std::runtime_error("unsupported BC7 block mode!");
+	}
+
+	uint8_t data[16];
+	std::memcpy(data, block, 16);
+	BlockBits bits{ data };
+	bits.read(7);
+
+	Bc7Endpoint endpoint0{};
+	Bc7Endpoint endpoint1{};
+	for(uint32_t c = 0; c < 4; c++)
+	{
+		endpoint0.values[c] = bits.read(7);
+		endpoint1.values[c] = bits.read(7);
+	}
+	endpoint0.pBit = bits.read(1);
+	endpoint1.pBit = bits.read(1);
+
+	for(uint32_t i = 0; i < TEXELS_PER_BLOCK; i++)
+	{
+		uint32_t index = bits.read(i == 0 ? 3 : 4);
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			texels[i * 4 + c] = static_cast<uint8_t>(interpolateBc7(endpoint0.get(c), endpoint1.get(c), BC7_WEIGHTS4[index]));
+		}
+	}
+}
+
+// Whole images
+
+std::vector<uint8_t> compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, BlockFormat format)
+{
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	uint32_t blockSize = getBlockSize(format);
+	std::vector<uint8_t> blocks(getCompressedSize(format, width, height));
+
+	ThreadPool::get().parallelFor(blocksHigh, [&](uint32_t blockY)
+	{
+		uint8_t texels[TEXELS_PER_BLOCK * 4];
+		for(uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			for(uint32_t y = 0; y < 4; y++)
+			{
+				uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+				for(uint32_t x = 0; x < 4; x++)
+				{
+					uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+					std::memcpy(texels + (y * 4 + x) * 4, pixels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+				}
+			}
+
+			uint8_t* block = blocks.data() + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockSize;
+			switch(format)
+			{
+			case BlockFormat::BC1:
+				encodeBC1Block(texels, block);
+				break;
+			case BlockFormat::BC3:
+				encodeBC3Block(texels, block);
+				break;
+			case BlockFormat::BC7:
+				encodeBC7Block(texels, block);
+				break;
+			}
+		}
+	});
+
+	return blocks;
+}
+
+void decompressImage(const uint8_t* blocks, uint32_t width, uint32_t height, BlockFormat format, uint8_t* pixels)
+{
+	uint32_t blocksWide = (width + 3) / 4;
+	uint32_t blocksHigh = (height + 3) / 4;
+	uint32_t blockSize = getBlockSize(format);
+
+	uint8_t texels[TEXELS_PER_BLOCK * 4];
+	for(uint32_t blockY = 0; blockY < blocksHigh; blockY++)
+	{
+		for(uint32_t blockX = 0; blockX < blocksWide; blockX++)
+		{
+			const uint8_t* block = blocks + (static_cast<size_t>(blockY) * blocksWide + blockX) * blockSize;
+			switch(format)
+			{
+			case BlockFormat::BC1:
+				decodeBC1Block(block, texels);
+				break;
+			case BlockFormat::BC3:
+				decodeBC3Block(block, texels);
+				break;
+			case BlockFormat::BC7:
+				decodeBC7Block(block, texels);
+				break;
+			}
+
+			for(uint32_t y = 0; y < 4 && blockY * 4 + y < height; y++)
+			{
+				for(uint32_t x = 0; x < 4 && blockX * 4 + x < width; x++)
+				{
+					std::memcpy(pixels + (static_cast<size_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4, texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU encoding and decoding of BC texture blocks, independent of any GPU state.
+// Blocks cover 4x4 texels given as 64 bytes of RGBA8 in row order. Color is encoded in the space it is given in,
+// so sRGB data goes to the _SRGB_BLOCK formats unchanged.
+
+enum class BlockFormat
+{
+	BC1,	// opaque RGB, 8 bytes per block
+	BC3,	// RGB with interpolated alpha, 16 bytes per block
+	BC7	// high quality RGBA, 16 bytes per block
+};
+
+uint32_t getBlockSize(BlockFormat format);
+size_t getCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+// False for formats that are not one of the block formats above
+bool getBlockFormat(VkFormat vkFormat, BlockFormat& format);
+VkFormat getVkFormat(BlockFormat format, bool srgb);
+bool isSrgbFormat(VkFormat vkFormat);
+
+// Encoders fit the endpoints along the principal axis of the block and refine them by least squares.
+// BC1 ignores alpha, BC7 only writes mode 6 blocks.
+void encodeBC1Block(const uint8_t* texels, uint8_t* block);
+void encodeBC3Block(const uint8_t* texels, uint8_t* block);
+void encodeBC7Block(const uint8_t* texels, uint8_t* block);
+
+// BC1 decodes both the opaque and the punch-through alpha mode. BC7 decodes mode 6 only and throws on
+// other modes, which the encoder above never writes.
+void decodeBC1Block(const uint8_t* block, uint8_t* texels);
+void decodeBC3Block(const uint8_t* block, uint8_t* texels);
+void decodeBC7Block(const uint8_t* block, uint8_t* texels);
+
+// Whole images of any size, edge blocks repeat the last row and column. Encoding runs on the engine thread pool.
+std::vector<uint8_t> compressImage(const uint8_t* pixels, uint32_t width, uint32_t height, BlockFormat format);
+void decompressImage(const uint8_t* blocks, uint32_t width, uint32_t height, BlockFormat format, uint8_t* pixels);
+
+}
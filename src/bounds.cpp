@@ -0,0 +1,102 @@
+#include "bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define BOUNDS_USE_SSE
+#endif
+
+namespace VulkanEngine
+{
+
+static glm::vec3 loadPosition(const float* positions, size_t positionStride, size_t index)
+{
+	glm::vec3 position;
+	std::memcpy(&position, reinterpret_cast<const char*>(positions) + positionStride * index, sizeof(glm::vec3));
+	return position;
+}
+
+#ifdef BOUNDS_USE_SSE
+// Loads xyz into the low lanes. Reading a full 16 bytes is only safe when another position follows,
+// so the last one is assembled from scalars.
+static __m128 loadPositionSse(const float* positions, size_t positionStride, size_t index, size_t positionCount)
+{
+	const float* position = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + positionStride * index);
+	if(index + 1 < positionCount || positionStride >= 4 * sizeof(float))
+	{
+		return _mm_loadu_ps(position);
+	}
+	return _mm_set_ps(0.0f, position[2], position[1], position[0]);
+}
+#endif
+
+BoundingBox computeBoundingBox(const float* positions, size_t positionStride, size_t positionCount)
+{
+	BoundingBox box{};
+	if(positionCount == 0)
+	{
+		return box;
+	}
+
+#ifdef BOUNDS_USE_SSE
+	__m128 minimum = loadPositionSse(positions, positionStride, 0, positionCount);
+	__m128 maximum = minimum;
+	for(size_t i = 1; i < positionCount; i++)
+	{
+		__m128 position = loadPositionSse(positions, positionStride, i, positionCount);
+		minimum = _mm_min_ps(minimum, position);
+		maximum = _mm_max_ps(maximum, position);
+	}
+
+	float lanes[4];
+	_mm_storeu_ps(lanes, minimum);
+	box.min = { lanes[0], lanes[1], lanes[2] };
+	_mm_storeu_ps(lanes, maximum);
+	box.max = { lanes[0], lanes[1], lanes[2] };
+#else
+	box.min = box.max = loadPosition(positions, positionStride, 0);
+	for(size_t i = 1; i < positionCount; i++)
+	{
+		glm::vec3 position = loadPosition(positions, positionStride, i);
+		box.min = glm::min(box.min, position);
+		box.max = glm::max(box.max, position);
+	}
+#endif
+
+	return box;
+}
+
+BoundingSphere computeBoundingSphere(const float* positions, size_t positionStride, size_t positionCount, const BoundingBox& box)
+{
+	BoundingSphere sphere{};
+	sphere.center = box.getCenter();
+
+	float maxDistanceSquared = 0.0f;
+	for(size_t i = 0; i < positionCount; i++)
+	{
+		glm::vec3 offset = loadPosition(positions, positionStride, i) - sphere.center;
+		maxDistanceSquared = std::max(maxDistanceSquared, glm::dot(offset, offset));
+	}
+	sphere.radius = std::sqrt(maxDistanceSquared);
+
+	return sphere;
+}
+
+BoundingBox transformBoundingBox(const BoundingBox& box, const glm::mat4& transform)
+{
+	glm::vec3 center = glm::vec3(transform * glm::vec4(box.getCenter(), 1.0f));
+
+	glm::mat3 absolute{ transform };
+	for(int c = 0; c < 3; c++)
+	{
+		absolute[c] = glm::abs(absolute[c]);
+	}
+	glm::vec3 extents = absolute * box.getExtents();
+
+	return { center - extents, center + extents };
+}
+
+}
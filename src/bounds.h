@@ -0,0 +1,39 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+namespace VulkanEngine
+{
+
+// Pure CPU bounding volumes over positions, independent of any GPU state
+
+struct BoundingBox
+{
+	glm::vec3 min{};
+	glm::vec3 max{};
+
+	glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+	glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+};
+
+struct BoundingSphere
+{
+	glm::vec3 center{};
+	float radius = 0.0f;
+};
+
+// Positions are xyz floats spaced by positionStride bytes, an empty range gives empty bounds at the origin
+BoundingBox computeBoundingBox(const float* positions, size_t positionStride, size_t positionCount);
+
+// Sphere around the box center enclosing every position, a little larger than the minimal one but stable
+BoundingSphere computeBoundingSphere(const float* positions, size_t positionStride, size_t positionCount, const BoundingBox& box);
+
+// Smallest axis aligned box around the transformed box: the center goes through the matrix,
+// the extents through its absolute upper 3x3, so the corners never have to be transformed
+BoundingBox transformBoundingBox(const BoundingBox& box, const glm::mat4& transform);
+
+}
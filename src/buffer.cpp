@@ -8,6 +8,7 @@
 #include "buffer.h"
 
  // std
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -44,12 +45,14 @@ Buffer::~Buffer()
 {
 	unmap();
 	vkDestroyBuffer(m_device.getDevice(), m_buffer, nullptr);
-	vkFreeMemory(m_device.getDevice(), m_memory, nullptr);
+	m_device.getMemoryAllocator().free(m_memory);
 }
 
 /**
  * Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
  *
+ * @note Host visible memory blocks stay mapped by the allocator, so this only points into them
+ *
  * @param size (Optional) Size of the memory range to map. Pass VK_WHOLE_SIZE to map the complete
  * buffer range.
  * @param offset (Optional) Byte offset from beginning
@@ -58,22 +61,24 @@ Buffer::~Buffer()
  */
 VkResult Buffer::map(VkDeviceSize size, VkDeviceSize offset)
 {
-	assert(m_buffer && m_memory && "Called map on buffer before create");
-	return vkMapMemory(m_device.getDevice(), m_memory, offset, size, 0, &m_pData);
+	assert(m_buffer && m_memory.memory && "Called map on buffer before create");
+	if(!m_memory.pMapped)
+	{
+		return VK_ERROR_MEMORY_MAP_FAILED;
+	}
+
+	m_pData = static_cast<char*>(m_memory.pMapped) + offset;
+	return VK_SUCCESS;
 }
 
 /**
  * Unmap a mapped memory range
  *
- * @note Does not return a result as vkUnmapMemory can't fail
+ * @note The memory block stays mapped, only the pointer is dropped
  */
 void Buffer::unmap()
 {
-	if(m_pData)
-	{
-		vkUnmapMemory(m_device.getDevice(), m_memory);
-		m_pData = nullptr;
-	}
+	m_pData = nullptr;
 }
 
 /**
@@ -114,11 +119,7 @@ void Buffer::writeToBuffer(void* data, VkDeviceSize size, VkDeviceSize offset)
  */
 VkResult Buffer::flush(VkDeviceSize size, VkDeviceSize offset)
 {
-	VkMappedMemoryRange mappedRange = {};
-	mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-	mappedRange.memory = m_memory;
-	mappedRange.offset = offset;
-	mappedRange.size = size;
+	VkMappedMemoryRange mappedRange = getMappedRange(size, offset);
 	return vkFlushMappedMemoryRanges(m_device.getDevice(), 1, &mappedRange);
 }
 
@@ -135,12 +136,33 @@ VkResult Buffer::flush(VkDeviceSize size, VkDeviceSize offset)
  */
 VkResult Buffer::invalidate(VkDeviceSize size, VkDeviceSize offset)
 {
+	VkMappedMemoryRange mappedRange = getMappedRange(size, offset);
+	return vkInvalidateMappedMemoryRanges(m_device.getDevice(), 1, &mappedRange);
+}
+
+/**
+ * Memory range of the buffer range, rounded out to whole nonCoherentAtomSize atoms
+ *
+ * @note The allocation is aligned and padded to atoms, so the rounded range stays inside of it
+ *
+ * @param size Size of the buffer range, VK_WHOLE_SIZE for the rest of the buffer
+ * @param offset Byte offset from beginning
+ *
+ * @return VkMappedMemoryRange to flush or invalidate
+ */
+VkMappedMemoryRange Buffer::getMappedRange(VkDeviceSize size, VkDeviceSize offset) const
+{
+	VkDeviceSize atomSize = m_device.getMemoryAllocator().getNonCoherentAtomSize();
+	VkDeviceSize allocationEnd = m_memory.offset + m_memory.size;
+	VkDeviceSize begin = (m_memory.offset + offset) / atomSize * atomSize;
+	VkDeviceSize end = size == VK_WHOLE_SIZE ? allocationEnd : std::min((m_memory.offset + offset + size + atomSize - 1) / atomSize * atomSize, allocationEnd);
+
 	VkMappedMemoryRange mappedRange = {};
 	mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-	mappedRange.memory = m_memory;
-	mappedRange.offset = offset;
-	mappedRange.size = size;
-	return vkInvalidateMappedMemoryRanges(m_device.getDevice(), 1, &mappedRange);
+	mappedRange.memory = m_memory.memory;
+	mappedRange.offset = begin;
+	mappedRange.size = end - begin;
+	return mappedRange;
 }
 
 /**
@@ -36,11 +36,12 @@ public:
 
 private:
 	static VkDeviceSize getAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+	VkMappedMemoryRange getMappedRange(VkDeviceSize size, VkDeviceSize offset) const;
 
 	Device& m_device;
 	void* m_pData = nullptr;
 	VkBuffer m_buffer = VK_NULL_HANDLE;
-	VkDeviceMemory m_memory = VK_NULL_HANDLE;
+	MemoryAllocation m_memory;
 
 	VkDeviceSize bufferSize;
 	uint32_t instanceCount;
@@ -17,30 +17,50 @@ DescriptorSetLayout::~DescriptorSetLayout()
 	vkDestroyDescriptorSetLayout(device.getDevice(), descriptorSetLayout, nullptr);
 }
 
-void DescriptorSetLayout::addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags)
+void DescriptorSetLayout::addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t descriptorCount, VkDescriptorBindingFlags flags)
 {
 	assert(bindings.count(binding) == 0 && "Binding already in use");
 	VkDescriptorSetLayoutBinding layoutBinding{};
 	layoutBinding.binding = binding;
 	layoutBinding.descriptorType = descriptorType;
-	layoutBinding.descriptorCount = 1;
+	layoutBinding.descriptorCount = descriptorCount;
 	layoutBinding.stageFlags = stageFlags;
 	bindings[binding] = layoutBinding;
+	bindingFlags[binding] = flags;
 }
 
 void DescriptorSetLayout::build()
 {
 	std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+	std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
+	VkDescriptorBindingFlags usedFlags = 0;
 	for(auto kv : bindings)
 	{
 		setLayoutBindings.push_back(kv.second);
+		setLayoutBindingFlags.push_back(bindingFlags[kv.first]);
+		usedFlags |= bindingFlags[kv.first];
 	}
 
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
 	VkDescriptorSetLayoutCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	createInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
 	createInfo.pBindings = setLayoutBindings.data();
 
+	// layouts without any flags stay plain Vulkan 1.0 ones
+	if(usedFlags != 0)
+	{
+		createInfo.pNext = &bindingFlagsInfo;
+	}
+	if(usedFlags & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT)
+	{
+		createInfo.flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	}
+
 	if(vkCreateDescriptorSetLayout(device.getDevice(), &createInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
 	{
 		throw std::runtime_error("failed to create descriptor set layout!");
@@ -101,16 +121,30 @@ DescriptorPool::~DescriptorPool()
 }
 
 void DescriptorPool::allocateDescriptorSet(const DescriptorSetLayout& descriptorSetLayout, std::vector<DescriptorDesc>& descriptorDescs, VkDescriptorSet& descriptorSet)
+{
+	allocateDescriptorSet(descriptorSetLayout, descriptorDescs, descriptorSet, 0);
+}
+
+void DescriptorPool::allocateDescriptorSet(const DescriptorSetLayout& descriptorSetLayout, std::vector<DescriptorDesc>& descriptorDescs, VkDescriptorSet& descriptorSet, uint32_t variableDescriptorCount)
 {
 	std::vector<VkWriteDescriptorSet> writes;
 
 	VkDescriptorSetLayout setLayout = descriptorSetLayout.getDescriptorSetLayout();
 
+	VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+	variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+	variableCountInfo.descriptorSetCount = 1;
+	variableCountInfo.pDescriptorCounts = &variableDescriptorCount;
+
 	VkDescriptorSetAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	allocInfo.descriptorPool = m_descriptorPool;
 	allocInfo.pSetLayouts = &setLayout;
 	allocInfo.descriptorSetCount = 1;
+	if(variableDescriptorCount > 0)
+	{
+		allocInfo.pNext = &variableCountInfo;
+	}
 
 	if(vkAllocateDescriptorSets(m_device.getDevice(), &allocInfo, &descriptorSet) != VK_SUCCESS)
 	{
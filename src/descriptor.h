@@ -18,7 +18,9 @@ public:
 	DescriptorSetLayout(const DescriptorSetLayout&) = delete;
 	DescriptorSetLayout& operator=(const DescriptorSetLayout&) = delete;
 
-	void addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags);
+	// Arrays of descriptorCount elements; with VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT that is the upper bound.
+	// Update-after-bind bindings make the layout allocate from pools created with VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT.
+	void addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t descriptorCount = 1, VkDescriptorBindingFlags bindingFlags = 0);
 	void build();
 
 	VkDescriptorType getDescriptorType(uint32_t binding) const;
@@ -29,6 +31,7 @@ private:
 	Device& device;
 	VkDescriptorSetLayout descriptorSetLayout;
 	std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+	std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags;
 
 	friend class DescriptorPool;
 };
@@ -56,6 +59,8 @@ public:
 	void build();
 
 	void allocateDescriptorSet(const DescriptorSetLayout& descriptorSetLayout, std::vector<DescriptorDesc>& descriptorDescs, VkDescriptorSet& descriptorSet);
+	// For layouts whose last binding has a variable descriptor count, allocates that binding with variableDescriptorCount elements
+	void allocateDescriptorSet(const DescriptorSetLayout& descriptorSetLayout, std::vector<DescriptorDesc>& descriptorDescs, VkDescriptorSet& descriptorSet, uint32_t variableDescriptorCount);
 
 	void freeDescriptors(std::vector<VkDescriptorSet>& descriptors) const;
 
@@ -39,6 +39,46 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
 	}
 }
 
+// Hands the blocks of the memory allocator out of the logical device
+class DeviceMemorySource : public MemoryAllocator::BlockSource
+{
+public:
+	DeviceMemorySource(VkDevice device) : m_device(device) {}
+
+	VkDeviceMemory allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size) override
+	{
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		if(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		{
+			return VK_NULL_HANDLE;
+		}
+		return memory;
+	}
+
+	void freeMemory(VkDeviceMemory memory) override
+	{
+		vkFreeMemory(m_device, memory, nullptr);
+	}
+
+	void* mapMemory(VkDeviceMemory memory) override
+	{
+		void* pData = nullptr;
+		if(vkMapMemory(m_device, memory, 0, VK_WHOLE_SIZE, 0, &pData) != VK_SUCCESS)
+		{
+			return nullptr;
+		}
+		return pData;
+	}
+
+private:
+	VkDevice m_device;
+};
+
 // class member functions
 Device::Device(Window& window) : m_window{ window }
 {
@@ -47,6 +87,7 @@ Device::Device(Window& window) : m_window{ window }
 	createSurface();
 	pickPhysicalDevice();
 	createLogicalDevice();
+	createMemoryAllocator();
 	createSwapchain();
 	createImageViews();
 	createDepthResources();
@@ -72,6 +113,9 @@ Device::~Device()
 	}
 
 	vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+
+	m_pMemoryAllocator.reset();
+	m_pMemorySource.reset();
 	vkDestroyDevice(m_device, nullptr);
 
 	if(enableValidationLayers)
@@ -96,7 +140,8 @@ void Device::createInstance()
 	appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
 	appInfo.pEngineName = "No Engine";
 	appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-	appInfo.apiVersion = VK_API_VERSION_1_0;
+	// descriptor indexing for the bindless texture array is core in 1.2
+	appInfo.apiVersion = VK_API_VERSION_1_2;
 
 	VkInstanceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -157,9 +202,23 @@ bool Device::isSuitablePhysicalDevice(VkPhysicalDevice physicalDevice)
 	if(details.formats.empty() || details.presentModes.empty())
 		return false;
 
-	VkPhysicalDeviceFeatures features;
-	vkGetPhysicalDeviceFeatures(physicalDevice, &features);
-	if(!features.samplerAnisotropy)
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	if(properties.apiVersion < VK_API_VERSION_1_2)
+		return false;
+
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+	VkPhysicalDeviceFeatures2 features{};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &indexingFeatures;
+	vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+	if(!features.features.samplerAnisotropy)
+		return false;
+
+	if(!indexingFeatures.runtimeDescriptorArray || !indexingFeatures.descriptorBindingVariableDescriptorCount || !indexingFeatures.descriptorBindingPartiallyBound ||
+		!indexingFeatures.descriptorBindingSampledImageUpdateAfterBind || !indexingFeatures.descriptorBindingUpdateUnusedWhilePending)
 		return false;
 
 	return true;
@@ -214,8 +273,19 @@ void Device::createLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
-	VkPhysicalDeviceFeatures enabledFeatures = {};
-	enabledFeatures.samplerAnisotropy = VK_TRUE;
+	// what TextureManager needs for its bindless texture array
+	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+	indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+	indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+	indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+	indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+	VkPhysicalDeviceFeatures2 enabledFeatures = {};
+	enabledFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	enabledFeatures.pNext = &indexingFeatures;
+	enabledFeatures.features.samplerAnisotropy = VK_TRUE;
 
 	std::vector<const char*> deviceExtensions = getRequiredDeviceExtensions();
 
@@ -227,7 +297,7 @@ void Device::createLogicalDevice()
 	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 	createInfo.enabledLayerCount = 0;
 	createInfo.ppEnabledLayerNames = nullptr;
-	createInfo.pEnabledFeatures = &enabledFeatures;
+	createInfo.pNext = &enabledFeatures;
 
 	if(vkCreateDevice(m_physicalDevice, &createInfo, nullptr, &m_device) != VK_SUCCESS)
 	{
@@ -238,6 +308,18 @@ void Device::createLogicalDevice()
 	vkGetDeviceQueue(m_device, indices.presentFamily.value(), 0, &m_presentQueue);
 }
 
+void Device::createMemoryAllocator()
+{
+	VkPhysicalDeviceMemoryProperties memProperties;
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+
+	m_pMemorySource = std::make_unique<DeviceMemorySource>(m_device);
+	m_pMemoryAllocator = std::make_unique<MemoryAllocator>(*m_pMemorySource, memProperties, properties.limits.bufferImageGranularity, properties.limits.nonCoherentAtomSize);
+}
+
 void Device::createSwapchain()
 {
 	SwapChainSupportDetails details = getSwapChainSupportDetails(m_physicalDevice);
@@ -342,28 +424,7 @@ void Device::createDepthResources()
 	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 	imageInfo.flags = 0;
 
-	if(vkCreateImage(m_device, &imageInfo, nullptr, &m_depthImage) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create image!");
-	}
-
-	VkMemoryRequirements memRequirements;
-	vkGetImageMemoryRequirements(m_device, m_depthImage, &memRequirements);
-
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-
-	if(vkAllocateMemory(m_device, &allocInfo, nullptr, &m_depthImageMemory) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to allocate image memory!");
-	}
-
-	if(vkBindImageMemory(m_device, m_depthImage, m_depthImageMemory, 0) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to bind image memory!");
-	}
+	createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_depthImage, m_depthImageMemory);
 
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -786,20 +847,10 @@ VkFormat Device::findSupportedFormat(const std::vector<VkFormat>& candidates, Vk
 
 uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
-	for(uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-	{
-		if((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-		{
-			return i;
-		}
-	}
-
-	throw std::runtime_error("failed to find suitable memory type!");
+	return m_pMemoryAllocator->findMemoryType(typeFilter, properties);
 }
 
-void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory)
 {
 	VkBufferCreateInfo bufferInfo{};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -815,17 +866,25 @@ void Device::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryP
 	VkMemoryRequirements memRequirements;
 	vkGetBufferMemoryRequirements(m_device, buffer, &memRequirements);
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+	bufferMemory = m_pMemoryAllocator->allocate(memRequirements, properties, true);
+	vkBindBufferMemory(m_device, buffer, bufferMemory.memory, bufferMemory.offset);
+}
 
-	if(vkAllocateMemory(m_device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+void Device::createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory)
+{
+	if(vkCreateImage(m_device, &imageInfo, nullptr, &image) != VK_SUCCESS)
 	{
-		throw std::runtime_error("failed to allocate vertex buffer memory!");
+		throw std::runtime_error("failed to create image!");
 	}
 
-	vkBindBufferMemory(m_device, buffer, bufferMemory, 0);
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(m_device, image, &memRequirements);
+
+	imageMemory = m_pMemoryAllocator->allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
+	if(vkBindImageMemory(m_device, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to bind image memory!");
+	}
 }
 
 VkCommandBuffer Device::beginSingleTimeCommands()
@@ -862,40 +921,6 @@ void Device::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
 }
 
-void Device::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
-{
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-	VkBufferCopy copyRegion{};
-	copyRegion.srcOffset = 0;
-	copyRegion.dstOffset = 0;
-	copyRegion.size = size;
-	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-	endSingleTimeCommands(commandBuffer);
-}
-
-void Device::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount)
-{
-	VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-	VkBufferImageCopy region{};
-	region.bufferOffset = 0;
-	region.bufferRowLength = 0;
-	region.bufferImageHeight = 0;
-
-	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	region.imageSubresource.mipLevel = 0;
-	region.imageSubresource.baseArrayLayer = 0;
-	region.imageSubresource.layerCount = layerCount;
-
-	region.imageOffset = { 0, 0, 0 };
-	region.imageExtent = { width, height, 1 };
-
-	vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-	endSingleTimeCommands(commandBuffer);
-}
-
 void Device::createCommandBuffers()
 {
 	m_commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
@@ -951,7 +976,7 @@ void Device::cleanupSwapchain()
 
 	vkDestroyImageView(m_device, m_depthImageView, nullptr);
 	vkDestroyImage(m_device, m_depthImage, nullptr);
-	vkFreeMemory(m_device, m_depthImageMemory, nullptr);
+	m_pMemoryAllocator->free(m_depthImageMemory);
 
 	for(auto framebuffer : m_swapchainFramebuffers)
 	{
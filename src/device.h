@@ -1,8 +1,10 @@
 #pragma once
 
 #include "window.h"
+#include "memoryAllocator.h"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
@@ -61,17 +63,20 @@ public:
 	QueueFamilyIndices getQueueFamilyIndices() { return getQueueFamilyIndices(m_physicalDevice); }
 	VkFormat findSupportedFormat(const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
+	// Device memory of buffers and images is sub-allocated from shared blocks, free it through the allocator
+	MemoryAllocator& getMemoryAllocator() { return *m_pMemoryAllocator; }
+
 	// Buffer Helper Functions
-	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+	void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, MemoryAllocation& bufferMemory);
+	void createImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, MemoryAllocation& imageMemory);
 	VkCommandBuffer beginSingleTimeCommands();
 	void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
-	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
 	void waitIdle();
 
 	VkImageView getImageView(int index) { return m_swapchainImageViews[index]; }
 
+	VkExtent2D getSwapchainExtent() const { return m_swapchainExtent; }
 	float getAspectRatio() { return static_cast<float>(m_swapchainExtent.width) / static_cast<float>(m_swapchainExtent.height); }
 	VkFormat findDepthFormat();
 
@@ -91,6 +96,7 @@ private:
 	void createSurface();
 	void pickPhysicalDevice();
 	void createLogicalDevice();
+	void createMemoryAllocator();
 	void createSwapchain();
 	void createImageViews();
 	void createDepthResources();
@@ -129,6 +135,9 @@ private:
 	VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;	// physical device handle
 	VkDevice m_device = VK_NULL_HANDLE;					// logical device handle
 
+	std::unique_ptr<MemoryAllocator::BlockSource> m_pMemorySource;
+	std::unique_ptr<MemoryAllocator> m_pMemoryAllocator;
+
 	VkQueue m_graphicsQueue;
 	VkQueue m_presentQueue;
 
@@ -149,7 +158,7 @@ private:
 	std::vector<VkImageView> m_swapchainImageViews;
 
 	VkImage m_depthImage;
-	VkDeviceMemory m_depthImageMemory;
+	MemoryAllocation m_depthImageMemory;
 	VkImageView m_depthImageView;
 
 	VkExtent2D m_windowExtent;
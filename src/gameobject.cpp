@@ -1,5 +1,13 @@
 #include "gameobject.h"
 
+#include "glbParser.h"
+
+#include <cmath>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
 namespace VulkanEngine
 {
 
@@ -61,6 +69,81 @@ glm::mat3 TransformComponent::normalMatrix()
 		} };
 }
 
+void TransformComponent::setMatrix(const glm::mat4& matrix)
+{
+	translation = glm::vec3(matrix[3]);
+
+	glm::vec3 axes[3] = { glm::vec3(matrix[0]), glm::vec3(matrix[1]), glm::vec3(matrix[2]) };
+	scale = { glm::length(axes[0]), glm::length(axes[1]), glm::length(axes[2]) };
+	if(glm::dot(glm::cross(axes[0], axes[1]), axes[2]) < 0.0f)
+	{
+		scale.x = -scale.x;
+	}
+	for(int c = 0; c < 3; c++)
+	{
+		if(scale[c] != 0.0f)
+		{
+			axes[c] /= scale[c];
+		}
+	}
+
+	// inverts mat4(), where the third axis is (c2 * s1, -s2, c1 * c2) and the y of the first two c2 * s3 and c2 * c3
+	const float c2 = std::sqrt(axes[2].x * axes[2].x + axes[2].z * axes[2].z);
+	rotation.x = std::atan2(-axes[2].y, c2);
+	if(c2 > 1e-6f)
+	{
+		rotation.y = std::atan2(axes[2].x, axes[2].z);
+		rotation.z = std::atan2(axes[0].y, axes[1].y);
+	}
+	else
+	{
+		// gimbal lock, only the sum or difference of y and z is defined so all of it goes into y
+		rotation.y = std::atan2(-axes[0].z, axes[0].x);
+		rotation.z = 0.0f;
+	}
+}
+
+BoundingBox TransformComponent::worldBoundingBox(const BoundingBox& localBounds)
+{
+	return transformBoundingBox(localBounds, mat4());
+}
+
+BoundingSphere TransformComponent::worldBoundingSphere(const BoundingSphere& localBounds)
+{
+	// rotation keeps lengths, so only the largest scale grows the radius
+	const glm::vec3 absScale = glm::abs(scale);
+	return { glm::vec3(mat4() * glm::vec4(localBounds.center, 1.0f)), localBounds.radius * glm::max(absScale.x, glm::max(absScale.y, absScale.z)) };
+}
+
+std::vector<GameObject> GameObject::createGameObjectsFromGlb(GeometryArena& arena, const std::string& filepath)
+{
+	GlbFile file{ ENGINE_DIR + filepath };
+
+	// models are created on first use, so meshes no node refers to are never uploaded
+	std::vector<std::shared_ptr<Model>> models(file.getMeshes().size());
+	std::vector<GameObject> gameObjects;
+	for(const GlbNode& node : file.getNodes())
+	{
+		if(node.mesh < 0 || file.getMeshes()[node.mesh].primitives.empty())
+		{
+			continue;
+		}
+
+		std::shared_ptr<Model>& pModel = models[node.mesh];
+		if(!pModel)
+		{
+			pModel = Model::createModelFromGlb(arena, file, node.mesh);
+		}
+
+		GameObject gameObject = GameObject::createGameObject();
+		gameObject.pModel = pModel;
+		gameObject.transform.setMatrix(node.worldTransform);
+		gameObjects.push_back(std::move(gameObject));
+	}
+
+	return gameObjects;
+}
+
 GameObject GameObject::createPointLight(float intensity, float radius, glm::vec3 color)
 {
 	GameObject gameObj = GameObject::createGameObject();
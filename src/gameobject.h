@@ -5,11 +5,15 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace VulkanEngine
 {
 
+class Texture;
+
 struct TransformComponent
 {
 	glm::vec3 translation{};
@@ -19,6 +23,13 @@ struct TransformComponent
 	// Matrix correspond to translate * Ry * Rx * Rz * scale transformation
 	glm::mat4 mat4();
 	glm::mat3 normalMatrix();
+
+	// Decomposes an affine matrix without shear back into translation, rotation and scale, mirroring goes into scale.x
+	void setMatrix(const glm::mat4& matrix);
+
+	// World space bounds of model space ones, the box is refitted around the rotated one
+	BoundingBox worldBoundingBox(const BoundingBox& localBounds);
+	BoundingSphere worldBoundingSphere(const BoundingSphere& localBounds);
 };
 
 struct PointLightComponent
@@ -40,6 +51,9 @@ public:
 
 	static GameObject createPointLight(float intensity, float radius, glm::vec3 color);
 
+	// One game object per node of the file's default scene that has a mesh, nodes sharing a mesh share its model
+	static std::vector<GameObject> createGameObjectsFromGlb(GeometryArena& arena, const std::string& filepath);
+
 	GameObject(const GameObject&) = delete;
 	GameObject& operator=(const GameObject&) = delete;
 	GameObject(GameObject&&) = default;
@@ -51,6 +65,8 @@ public:
 	TransformComponent transform{};
 
 	std::shared_ptr<Model> pModel{};
+	std::shared_ptr<Texture> pTexture{};	// the pass's default texture when empty
+	uint32_t lod = 0;	// level of detail drawn last frame, kept for hysteresis
 	std::unique_ptr<PointLightComponent> pPointLightComponent;
 
 private:
@@ -0,0 +1,292 @@
+#include "geometryArena.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace VulkanEngine
+{
+
+static VkDeviceSize getIndexSize(VkIndexType indexType)
+{
+	return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+VkDeviceSize GeometryArena::VertexLayout::getVertexSize() const
+{
+	VkDeviceSize vertexSize = 0;
+	for(uint32_t s = 0; s < streamCount; s++)
+	{
+		vertexSize += streamStrides[s];
+	}
+	return vertexSize;
+}
+
+bool GeometryArena::VertexLayout::operator==(const VertexLayout& other) const
+{
+	if(streamCount != other.streamCount)
+	{
+		return false;
+	}
+
+	for(uint32_t s = 0; s < streamCount; s++)
+	{
+		if(streamStrides[s] != other.streamStrides[s])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+GeometryArena::VertexPool::VertexPool(Device& device, const VertexLayout& layout, VkDeviceSize capacity) :
+	layout(layout), vertexCapacity(static_cast<uint32_t>(capacity / layout.getVertexSize())), vertices(vertexCapacity)
+{
+	VkDeviceSize offset = 0;
+	for(uint32_t s = 0; s < layout.streamCount; s++)
+	{
+		streamOffsets[s] = offset;
+		offset += layout.streamStrides[s] * vertexCapacity;
+	}
+
+	buffer = std::make_unique<Buffer>(device, offset, 1, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+GeometryArena::IndexPool::IndexPool(Device& device, VkDeviceSize capacity) : indices(capacity)
+{
+	buffer = std::make_unique<Buffer>(device, capacity, 1, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+GeometryArena::GeometryArena(Device& device, UploadBatch& uploadBatch, VkDeviceSize vertexPoolCapacity, VkDeviceSize indexCapacity) :
+	m_device(device), m_uploadBatch(uploadBatch), m_vertexPoolCapacity(vertexPoolCapacity), m_indexPoolCapacity(indexCapacity)
+{
+	// created up front, so there always is an index buffer to bind
+	m_indexPools.push_back(std::make_unique<IndexPool>(m_device, m_indexPoolCapacity));
+}
+
+GeometryArena::Allocation GeometryArena::allocate(const VertexLayout& layout, uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType)
+{
+	assert(layout.streamCount > 0 && layout.streamCount <= MAX_VERTEX_STREAMS && "Vertex layout needs between 1 and MAX_VERTEX_STREAMS streams");
+
+	Allocation allocation{};
+	allocation.vertexCount = vertexCount;
+	allocation.indexCount = indexCount;
+	allocation.indexType = indexType;
+
+	VkDeviceSize indexSize = getIndexSize(indexType);
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	uint64_t baseVertex = RangeAllocator::INVALID_OFFSET;
+	for(allocation.vertexPool = 0; allocation.vertexPool < m_vertexPools.size(); allocation.vertexPool++)
+	{
+		VertexPool& pool = *m_vertexPools[allocation.vertexPool];
+		if(pool.layout == layout && (baseVertex = pool.vertices.allocate(vertexCount)) != RangeAllocator::INVALID_OFFSET)
+		{
+			break;
+		}
+	}
+	if(baseVertex == RangeAllocator::INVALID_OFFSET)
+	{
+		// a model larger than a pool gets one of its own size
+		VkDeviceSize capacity = std::max(m_vertexPoolCapacity, vertexCount * layout.getVertexSize());
+		m_vertexPools.push_back(std::make_unique<VertexPool>(m_device, layout, capacity));
+		baseVertex = m_vertexPools.back()->vertices.allocate(vertexCount);
+		assert(baseVertex != RangeAllocator::INVALID_OFFSET && "Vertices do not fit an empty pool");
+	}
+
+	uint64_t indexOffset = 0;
+	if(indexCount > 0)
+	{
+		VkDeviceSize indexBytes = indexCount * indexSize;
+
+		indexOffset = RangeAllocator::INVALID_OFFSET;
+		for(allocation.indexPool = 0; allocation.indexPool < m_indexPools.size(); allocation.indexPool++)
+		{
+			if((indexOffset = m_indexPools[allocation.indexPool]->indices.allocate(indexBytes, indexSize)) != RangeAllocator::INVALID_OFFSET)
+			{
+				break;
+			}
+		}
+		if(indexOffset == RangeAllocator::INVALID_OFFSET)
+		{
+			m_indexPools.push_back(std::make_unique<IndexPool>(m_device, std::max(m_indexPoolCapacity, indexBytes)));
+			indexOffset = m_indexPools.back()->indices.allocate(indexBytes, indexSize);
+			assert(indexOffset != RangeAllocator::INVALID_OFFSET && "Indices do not fit an empty pool");
+		}
+	}
+
+	allocation.baseVertex = static_cast<int32_t>(baseVertex);
+	allocation.firstIndex = static_cast<uint32_t>(indexOffset / indexSize);
+	return allocation;
+}
+
+void GeometryArena::free(const Allocation& allocation)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_retired.push_back({ allocation });
+}
+
+void GeometryArena::update()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	for(auto it = m_retired.begin(); it != m_retired.end();)
+	{
+		if(++it->frames > Device::MAX_FRAMES_IN_FLIGHT)
+		{
+			release(it->allocation);
+			it = m_retired.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
+void GeometryArena::release(const Allocation& allocation)
+{
+	m_vertexPools[allocation.vertexPool]->vertices.free(allocation.baseVertex, allocation.vertexCount);
+	if(allocation.indexCount > 0)
+	{
+		VkDeviceSize indexSize = getIndexSize(allocation.indexType);
+		m_indexPools[allocation.indexPool]->indices.free(allocation.firstIndex * indexSize, allocation.indexCount * indexSize);
+	}
+}
+
+void GeometryArena::upload(const Allocation& allocation, const void* const* streams, const void* indices)
+{
+	VertexPool* pPool = nullptr;
+	Buffer* pIndexBuffer = nullptr;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		pPool = m_vertexPools[allocation.vertexPool].get();
+		pIndexBuffer = m_indexPools[allocation.indexPool]->buffer.get();
+	}
+	const VertexLayout& layout = pPool->layout;
+
+	for(uint32_t s = 0; s < layout.streamCount; s++)
+	{
+		VkDeviceSize dstOffset = pPool->streamOffsets[s] + allocation.baseVertex * layout.streamStrides[s];
+		m_uploadBatch.copyToBuffer(streams[s], allocation.vertexCount * layout.streamStrides[s], pPool->buffer->getBuffer(), dstOffset);
+	}
+
+	if(allocation.indexCount > 0)
+	{
+		VkDeviceSize indexSize = getIndexSize(allocation.indexType);
+		m_uploadBatch.copyToBuffer(indices, allocation.indexCount * indexSize, pIndexBuffer->getBuffer(), allocation.firstIndex * indexSize);
+	}
+
+	// the model may be drawn as soon as this returns
+	m_uploadBatch.flush();
+}
+
+GeometryArena::StagedUpload GeometryArena::stage(const Allocation& allocation, const void* const* streams, const void* indices)
+{
+	VertexPool* pPool = nullptr;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		pPool = m_vertexPools[allocation.vertexPool].get();
+	}
+	const VertexLayout& layout = pPool->layout;
+
+	VkDeviceSize vertexBytes = allocation.vertexCount * layout.getVertexSize();
+	VkDeviceSize indexBytes = allocation.indexCount * getIndexSize(allocation.indexType);
+
+	StagedUpload staged{};
+	staged.vertexPool = allocation.vertexPool;
+	staged.indexPool = allocation.indexPool;
+	staged.staging = m_uploadBatch.allocateStaging(vertexBytes + indexBytes);
+	uint8_t* pStaging = static_cast<uint8_t*>(staged.staging.pMapped);
+
+	VkDeviceSize stagingOffset = 0;
+	for(uint32_t s = 0; s < layout.streamCount; s++)
+	{
+		VkDeviceSize streamBytes = allocation.vertexCount * layout.streamStrides[s];
+		std::memcpy(pStaging + stagingOffset, streams[s], streamBytes);
+
+		VkBufferCopy& streamCopy = staged.vertexCopies[staged.vertexCopyCount++];
+		streamCopy.srcOffset = staged.staging.offset + stagingOffset;
+		streamCopy.dstOffset = pPool->streamOffsets[s] + allocation.baseVertex * layout.streamStrides[s];
+		streamCopy.size = streamBytes;
+
+		stagingOffset += streamBytes;
+	}
+
+	if(indexBytes > 0)
+	{
+		std::memcpy(pStaging + stagingOffset, indices, indexBytes);
+
+		staged.indexCopy.srcOffset = staged.staging.offset + stagingOffset;
+		staged.indexCopy.dstOffset = allocation.firstIndex * getIndexSize(allocation.indexType);
+		staged.indexCopy.size = indexBytes;
+	}
+
+	return staged;
+}
+
+void GeometryArena::recordUpload(VkCommandBuffer commandBuffer, const StagedUpload& upload)
+{
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		vertexBuffer = m_vertexPools[upload.vertexPool]->buffer->getBuffer();
+		indexBuffer = m_indexPools[upload.indexPool]->buffer->getBuffer();
+	}
+
+	VkBuffer stagingBuffer = upload.staging.buffer;
+	vkCmdCopyBuffer(commandBuffer, stagingBuffer, vertexBuffer, upload.vertexCopyCount, upload.vertexCopies);
+	if(upload.indexCopy.size > 0)
+	{
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, indexBuffer, 1, &upload.indexCopy);
+	}
+}
+
+void GeometryArena::releaseUpload(StagedUpload& upload)
+{
+	m_uploadBatch.freeStaging(upload.staging);
+}
+
+void GeometryArena::bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t vertexPool)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	const VertexPool& pool = *m_vertexPools[vertexPool];
+
+	VkBuffer buffers[MAX_VERTEX_STREAMS];
+	for(uint32_t s = 0; s < pool.layout.streamCount; s++)
+	{
+		buffers[s] = pool.buffer->getBuffer();
+	}
+	vkCmdBindVertexBuffers(commandBuffer, 0, pool.layout.streamCount, buffers, pool.streamOffsets);
+}
+
+void GeometryArena::bindIndexBuffer(VkCommandBuffer commandBuffer, uint32_t indexPool, VkIndexType indexType)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	vkCmdBindIndexBuffer(commandBuffer, m_indexPools[indexPool]->buffer->getBuffer(), 0, indexType);
+}
+
+VkDeviceSize GeometryArena::getVertexBytesUsed() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	VkDeviceSize bytesUsed = 0;
+	for(const std::unique_ptr<VertexPool>& pPool : m_vertexPools)
+	{
+		bytesUsed += pPool->vertices.getUsedSize() * pPool->layout.getVertexSize();
+	}
+	return bytesUsed;
+}
+
+VkDeviceSize GeometryArena::getIndexBytesUsed() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	VkDeviceSize bytesUsed = 0;
+	for(const std::unique_ptr<IndexPool>& pPool : m_indexPools)
+	{
+		bytesUsed += pPool->indices.getUsedSize();
+	}
+	return bytesUsed;
+}
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "device.h"
+#include "buffer.h"
+#include "uploadBatch.h"
+#include "rangeAllocator.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Device local vertex and index storage shared by all models, so drawing a frame binds it once per vertex layout
+// and selects each model through firstIndex and vertexOffset.
+// Every vertex layout gets a pool of one buffer holding each of its streams in a separate region. Vertices are allocated
+// in the same slots of all streams, so a single vertexOffset addresses every binding. Index ranges are aligned to their
+// index size, so 16 and 32 bit indices share an index pool.
+// When the pools are full another one is added, sized to fit a model larger than the default capacity, so models only
+// change the bound buffers when they do not fit the first pools.
+// Allocation is thread-safe, immediate uploads go through the shared upload batch.
+class GeometryArena
+{
+public:
+	static constexpr uint32_t MAX_VERTEX_STREAMS = 2;
+	// bytes per vertex pool, over all of its streams
+	static constexpr VkDeviceSize DEFAULT_VERTEX_POOL_CAPACITY = 64 * 1024 * 1024;
+	static constexpr VkDeviceSize DEFAULT_INDEX_CAPACITY = 32 * 1024 * 1024;
+
+	// Strides of the vertex streams, stream s is bound to binding s
+	struct VertexLayout
+	{
+		uint32_t streamCount = 0;
+		VkDeviceSize streamStrides[MAX_VERTEX_STREAMS]{};
+
+		VkDeviceSize getVertexSize() const;
+		bool operator==(const VertexLayout& other) const;
+	};
+
+	// Location of one model inside the arena, in vertices of its pool and indices of its own type
+	struct Allocation
+	{
+		uint32_t vertexPool = 0;
+		int32_t baseVertex = 0;
+		uint32_t vertexCount = 0;
+		uint32_t indexPool = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+	};
+
+	// Copies of one allocation written to staging memory of the upload batch, recorded later by the thread that submits them
+	struct StagedUpload
+	{
+		UploadBatch::StagingAllocation staging;
+		uint32_t vertexPool = 0;
+		uint32_t vertexCopyCount = 0;
+		VkBufferCopy vertexCopies[MAX_VERTEX_STREAMS]{};
+		uint32_t indexPool = 0;
+		VkBufferCopy indexCopy{};	// size 0 without indices
+	};
+
+	GeometryArena(Device& device, UploadBatch& uploadBatch, VkDeviceSize vertexPoolCapacity = DEFAULT_VERTEX_POOL_CAPACITY, VkDeviceSize indexCapacity = DEFAULT_INDEX_CAPACITY);
+
+	GeometryArena(const GeometryArena&) = delete;
+	GeometryArena& operator=(const GeometryArena&) = delete;
+
+	// Takes the first pools with room, a layout gets its first pool on its first allocation
+	Allocation allocate(const VertexLayout& layout, uint32_t vertexCount, uint32_t indexCount, VkIndexType indexType);
+	// The range is only reused after Device::MAX_FRAMES_IN_FLIGHT more updates, so frames still in flight keep drawing from it
+	void free(const Allocation& allocation);
+	// Call once per frame, returns the ranges freed long enough ago to their pools
+	void update();
+
+	// Copies the data of a fresh allocation in and flushes the upload batch. streams[s] holds vertexCount tightly
+	// packed elements of stream s, indices may be null when indexCount is 0.
+	void upload(const Allocation& allocation, const void* const* streams, const void* indices);
+
+	// Copies the data into the staging ring of the upload batch without submitting anything, so it is safe on any thread
+	StagedUpload stage(const Allocation& allocation, const void* const* streams, const void* indices);
+	void recordUpload(VkCommandBuffer commandBuffer, const StagedUpload& upload);
+	// Hands the staging memory back once the recorded copies executed, or right away when they were never recorded
+	void releaseUpload(StagedUpload& upload);
+
+	// Binds every stream of a pool, pipelines leave out the bindings they do not read
+	void bindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t vertexPool);
+	void bindIndexBuffer(VkCommandBuffer commandBuffer, uint32_t indexPool, VkIndexType indexType);
+
+	Device& getDevice() { return m_device; }
+	// Includes ranges freed within the last Device::MAX_FRAMES_IN_FLIGHT updates
+	VkDeviceSize getVertexBytesUsed() const;
+	VkDeviceSize getIndexBytesUsed() const;
+
+private:
+	struct VertexPool
+	{
+		VertexLayout layout;
+		uint32_t vertexCapacity;
+		std::unique_ptr<Buffer> buffer;
+		VkDeviceSize streamOffsets[MAX_VERTEX_STREAMS]{};
+		RangeAllocator vertices;	// in vertex slots
+
+		VertexPool(Device& device, const VertexLayout& layout, VkDeviceSize capacity);
+	};
+
+	struct IndexPool
+	{
+		std::unique_ptr<Buffer> buffer;
+		RangeAllocator indices;	// in bytes
+
+		IndexPool(Device& device, VkDeviceSize capacity);
+	};
+
+	struct RetiredAllocation
+	{
+		Allocation allocation;
+		uint32_t frames = 0;
+	};
+
+	// Returns the range to its pools, m_mutex has to be held
+	void release(const Allocation& allocation);
+
+	Device& m_device;
+	UploadBatch& m_uploadBatch;
+	VkDeviceSize m_vertexPoolCapacity;
+	VkDeviceSize m_indexPoolCapacity;
+
+	// pools are kept once created, so pool indices stay valid and later models reuse the room
+	mutable std::mutex m_mutex;
+	std::vector<std::unique_ptr<VertexPool>> m_vertexPools;
+	std::vector<std::unique_ptr<IndexPool>> m_indexPools;
+	std::vector<RetiredAllocation> m_retired;	// freed but possibly read by frames in flight
+};
+
+}
@@ -0,0 +1,804 @@
+#include "glbParser.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define GLB_USE_SSE
+#endif
+
+namespace VulkanEngine
+{
+
+static constexpr uint32_t GLB_MAGIC = 0x46546C67;	// "glTF"
+static constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+static constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+static constexpr uint32_t GLTF_MODE_TRIANGLES = 4;
+// nesting real files never come close to, bounds the recursion on malformed ones
+static constexpr int MAX_JSON_DEPTH = 64;
+
+// Minimal JSON document, objects keep their members in file order
+struct JsonValue
+{
+	enum class Type
+	{
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> elements;	// array elements or object member values
+	std::vector<std::string> keys;	// object member names, parallel to elements
+
+	const JsonValue* find(const char* key) const
+	{
+		for(size_t i = 0; i < keys.size(); i++)
+		{
+			if(keys[i] == key)
+			{
+				return &elements[i];
+			}
+		}
+		return nullptr;
+	}
+};
+
+static void skipWhitespace(const char*& cursor, const char* end)
+{
+	while(cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r'))
+	{
+		cursor++;
+	}
+}
+
+static void expect(const char*& cursor, const char* end, char c)
+{
+	skipWhitespace(cursor, end);
+	if(cursor == end || *cursor != c)
+	{
+		throw std::runtime_error("failed to parse glb json!");
+	}
+	cursor++;
+}
+
+static void appendUtf8(std::string& string, uint32_t codepoint)
+{
+	if(codepoint < 0x80)
+	{
+		string += static_cast<char>(codepoint);
+	}
+	else if(codepoint < 0x800)
+	{
+		string += static_cast<char>(0xC0 | (codepoint >> 6));
+		string += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+	else if(codepoint < 0x10000)
+	{
+		string += static_cast<char>(0xE0 | (codepoint >> 12));
+		string += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		string += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+	else
+	{
+		string += static_cast<char>(0xF0 | (codepoint >> 18));
+		string += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+		string += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+		string += static_cast<char>(0x80 | (codepoint & 0x3F));
+	}
+}
+
+static uint32_t parseHex4(const char*& cursor, const char* end)
+{
+	if(end - cursor < 4)
+	{
+		throw std::runtime_error("failed to parse glb json!");
+	}
+
+	uint32_t value = 0;
+	for(int i = 0; i < 4; i++, cursor++)
+	{
+		char c = *cursor;
+		uint32_t digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+		if(digit == 16)
+		{
+			throw std::runtime_error("failed to parse glb json!");
+		}
+		value = value << 4 | digit;
+	}
+	return value;
+}
+
+static std::string parseJsonString(const char*& cursor, const char* end)
+{
+	expect(cursor, end, '"');
+
+	std::string string;
+	while(cursor < end && *cursor != '"')
+	{
+		if(*cursor != '\\')
+		{
+			string += *cursor++;
+			continue;
+		}
+
+		if(++cursor == end)
+		{
+			break;
+		}
+		char escape = *cursor++;
+		switch(escape)
+		{
+		case 'b': string += '\b'; break;
+		case 'f': string += '\f'; break;
+		case 'n': string += '\n'; break;
+		case 'r': string += '\r'; break;
+		case 't': string += '\t'; break;
+		case 'u':
+		{
+			uint32_t codepoint = parseHex4(cursor, end);
+			// surrogate pairs encode codepoints beyond the basic plane
+			if(codepoint >= 0xD800 && codepoint < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u')
+			{
+				cursor += 2;
+				uint32_t low = parseHex4(cursor, end);
+				codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+			}
+			appendUtf8(string, codepoint);
+			break;
+		}
+		default: string += escape; break;
+		}
+	}
+
+	expect(cursor, end, '"');
+	return string;
+}
+
+static JsonValue parseJsonValue(const char*& cursor, const char* end, int depth)
+{
+	if(depth > MAX_JSON_DEPTH)
+	{
+		throw std::runtime_error("failed to parse glb json!");
+	}
+
+	skipWhitespace(cursor, end);
+	if(cursor == end)
+	{
+		throw std::runtime_error("failed to parse glb json!");
+	}
+
+	JsonValue value{};
+	if(*cursor == '{')
+	{
+		value.type = JsonValue::Type::Object;
+		cursor++;
+		skipWhitespace(cursor, end);
+		if(cursor < end && *cursor == '}')
+		{
+			cursor++;
+			return value;
+		}
+
+		do
+		{
+			value.keys.push_back(parseJsonString(cursor, end));
+			expect(cursor, end, ':');
+			value.elements.push_back(parseJsonValue(cursor, end, depth + 1));
+			skipWhitespace(cursor, end);
+		} while(cursor < end && *cursor == ',' && ++cursor);
+
+		expect(cursor, end, '}');
+	}
+	else if(*cursor == '[')
+	{
+		value.type = JsonValue::Type::Array;
+		cursor++;
+		skipWhitespace(cursor, end);
+		if(cursor < end && *cursor == ']')
+		{
+			cursor++;
+			return value;
+		}
+
+		do
+		{
+			value.elements.push_back(parseJsonValue(cursor, end, depth + 1));
+			skipWhitespace(cursor, end);
+		} while(cursor < end && *cursor == ',' && ++cursor);
+
+		expect(cursor, end, ']');
+	}
+	else if(*cursor == '"')
+	{
+		value.type = JsonValue::Type::String;
+		value.string = parseJsonString(cursor, end);
+	}
+	else if(end - cursor >= 4 && std::strncmp(cursor, "true", 4) == 0)
+	{
+		value.type = JsonValue::Type::Bool;
+		value.boolean = true;
+		cursor += 4;
+	}
+	else if(end - cursor >= 5 && std::strncmp(cursor, "false", 5) == 0)
+	{
+		value.type = JsonValue::Type::Bool;
+		cursor += 5;
+	}
+	else if(end - cursor >= 4 && std::strncmp(cursor, "null", 4) == 0)
+	{
+		cursor += 4;
+	}
+	else
+	{
+		// the JSON chunk is small, so copying a number out to terminate it costs nothing
+		const char* numberEnd = cursor;
+		while(numberEnd < end && *numberEnd != '\0' && std::strchr("+-0123456789.eE", *numberEnd))
+		{
+			numberEnd++;
+		}
+		std::string number{ cursor, numberEnd };
+		char* parsedEnd = nullptr;
+		value.type = JsonValue::Type::Number;
+		value.number = std::strtod(number.c_str(), &parsedEnd);
+		if(number.empty() || parsedEnd != number.c_str() + number.size())
+		{
+			throw std::runtime_error("failed to parse glb json!");
+		}
+		cursor = numberEnd;
+	}
+
+	return value;
+}
+
+static const JsonValue* findArray(const JsonValue& object, const char* key)
+{
+	const JsonValue* value = object.find(key);
+	return value && value->type == JsonValue::Type::Array ? value : nullptr;
+}
+
+static int32_t getInt(const JsonValue& object, const char* key, int32_t fallback)
+{
+	const JsonValue* value = object.find(key);
+	return value && value->type == JsonValue::Type::Number ? static_cast<int32_t>(value->number) : fallback;
+}
+
+// Byte offsets and counts can exceed 32 bits
+static uint64_t getSize(const JsonValue& object, const char* key, uint64_t fallback)
+{
+	const JsonValue* value = object.find(key);
+	return value && value->type == JsonValue::Type::Number && value->number >= 0.0 ? static_cast<uint64_t>(value->number) : fallback;
+}
+
+static std::string getString(const JsonValue& object, const char* key)
+{
+	const JsonValue* value = object.find(key);
+	return value && value->type == JsonValue::Type::String ? value->string : std::string{};
+}
+
+// Reads exactly count numbers, leaving values untouched when the array is missing
+static void getFloats(const JsonValue& object, const char* key, float* values, size_t count)
+{
+	const JsonValue* array = findArray(object, key);
+	if(!array || array->elements.size() != count)
+	{
+		return;
+	}
+
+	for(size_t i = 0; i < count; i++)
+	{
+		values[i] = static_cast<float>(array->elements[i].number);
+	}
+}
+
+static uint32_t readU32(const uint8_t* data)
+{
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+static uint32_t getComponentSize(uint32_t componentType)
+{
+	switch(componentType)
+	{
+	case GlbAccessor::BYTE:
+	case GlbAccessor::UNSIGNED_BYTE:
+		return 1;
+	case GlbAccessor::SHORT:
+	case GlbAccessor::UNSIGNED_SHORT:
+		return 2;
+	case GlbAccessor::UNSIGNED_INT:
+	case GlbAccessor::FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t getComponentCount(const std::string& type)
+{
+	if(type == "SCALAR") return 1;
+	if(type == "VEC2") return 2;
+	if(type == "VEC3") return 3;
+	if(type == "VEC4") return 4;
+	if(type == "MAT2") return 4;
+	if(type == "MAT3") return 9;
+	if(type == "MAT4") return 16;
+	return 0;
+}
+
+uint32_t GlbAccessor::getElementSize() const
+{
+	return getComponentSize(componentType) * componentCount;
+}
+
+bool GlbAccessor::isTight(uint32_t type, uint32_t components) const
+{
+	return data && componentType == type && componentCount == components && stride == getElementSize();
+}
+
+static std::vector<GlbAccessor> readAccessors(const JsonValue& root, const uint8_t* bin, size_t binSize)
+{
+	const JsonValue* buffers = findArray(root, "buffers");
+	const JsonValue* bufferViews = findArray(root, "bufferViews");
+	const JsonValue* accessors = findArray(root, "accessors");
+	if(!accessors)
+	{
+		return {};
+	}
+
+	std::vector<GlbAccessor> result(accessors->elements.size());
+	for(size_t a = 0; a < result.size(); a++)
+	{
+		const JsonValue& accessorJson = accessors->elements[a];
+		GlbAccessor& accessor = result[a];
+
+		if(accessorJson.find("sparse"))
+		{
+			throw std::runtime_error("failed to load glb: sparse accessors are not supported!");
+		}
+
+		accessor.count = static_cast<uint32_t>(getSize(accessorJson, "count", 0));
+		accessor.componentType = static_cast<uint32_t>(getInt(accessorJson, "componentType", 0));
+		accessor.componentCount = getComponentCount(getString(accessorJson, "type"));
+		const JsonValue* normalized = accessorJson.find("normalized");
+		accessor.normalized = normalized && normalized->boolean;
+
+		uint32_t elementSize = accessor.getElementSize();
+		if(elementSize == 0)
+		{
+			throw std::runtime_error("failed to load glb: unknown accessor type!");
+		}
+		accessor.stride = elementSize;
+
+		int32_t viewIndex = getInt(accessorJson, "bufferView", -1);
+		if(viewIndex < 0)
+		{
+			continue;
+		}
+		if(!bufferViews || viewIndex >= static_cast<int32_t>(bufferViews->elements.size()))
+		{
+			throw std::runtime_error("failed to load glb: buffer view index out of range!");
+		}
+		const JsonValue& view = bufferViews->elements[viewIndex];
+
+		// only the binary chunk can back a buffer without a uri
+		int32_t bufferIndex = getInt(view, "buffer", -1);
+		if(!buffers || bufferIndex != 0 || buffers->elements.empty() || buffers->elements[0].find("uri") || !bin)
+		{
+			throw std::runtime_error("failed to load glb: only the embedded binary buffer is supported!");
+		}
+
+		uint64_t viewOffset = getSize(view, "byteOffset", 0);
+		uint64_t viewLength = getSize(view, "byteLength", 0);
+		uint64_t accessorOffset = getSize(accessorJson, "byteOffset", 0);
+		accessor.stride = static_cast<uint32_t>(getSize(view, "byteStride", elementSize));
+
+		uint64_t accessorEnd = accessor.count == 0 ? 0 : accessorOffset + static_cast<uint64_t>(accessor.count - 1) * accessor.stride + elementSize;
+		if(viewOffset + viewLength > binSize || accessorEnd > viewLength || accessor.stride < elementSize)
+		{
+			throw std::runtime_error("failed to load glb: accessor out of bounds!");
+		}
+
+		accessor.data = bin + viewOffset + accessorOffset;
+	}
+
+	return result;
+}
+
+static std::vector<GlbMesh> readMeshes(const JsonValue& root, const std::vector<GlbAccessor>& accessors)
+{
+	const JsonValue* meshes = findArray(root, "meshes");
+	if(!meshes)
+	{
+		return {};
+	}
+
+	auto getAccessorIndex = [&accessors](const JsonValue& object, const char* key)
+	{
+		int32_t index = getInt(object, key, -1);
+		if(index >= static_cast<int32_t>(accessors.size()))
+		{
+			throw std::runtime_error("failed to load glb: accessor index out of range!");
+		}
+		return index;
+	};
+
+	std::vector<GlbMesh> result(meshes->elements.size());
+	for(size_t m = 0; m < result.size(); m++)
+	{
+		const JsonValue& meshJson = meshes->elements[m];
+		result[m].name = getString(meshJson, "name");
+
+		const JsonValue* primitives = findArray(meshJson, "primitives");
+		if(!primitives)
+		{
+			continue;
+		}
+
+		for(const JsonValue& primitiveJson : primitives->elements)
+		{
+			if(getInt(primitiveJson, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+			{
+				throw std::runtime_error("failed to load glb: only triangle list primitives are supported!");
+			}
+
+			const JsonValue* attributes = primitiveJson.find("attributes");
+			if(!attributes)
+			{
+				throw std::runtime_error("failed to load glb: primitive without attributes!");
+			}
+
+			GlbPrimitive primitive{};
+			primitive.position = getAccessorIndex(*attributes, "POSITION");
+			primitive.normal = getAccessorIndex(*attributes, "NORMAL");
+			primitive.texcoord = getAccessorIndex(*attributes, "TEXCOORD_0");
+			primitive.color = getAccessorIndex(*attributes, "COLOR_0");
+			primitive.indices = getAccessorIndex(primitiveJson, "indices");
+			if(primitive.position < 0)
+			{
+				throw std::runtime_error("failed to load glb: primitive without positions!");
+			}
+
+			uint32_t vertexCount = accessors[primitive.position].count;
+			for(int32_t attribute : { primitive.normal, primitive.texcoord, primitive.color })
+			{
+				if(attribute >= 0 && accessors[attribute].count != vertexCount)
+				{
+					throw std::runtime_error("failed to load glb: attribute counts differ!");
+				}
+			}
+
+			result[m].primitives.push_back(primitive);
+		}
+	}
+
+	return result;
+}
+
+// glTF nodes hold either a column major matrix or translation, rotation quaternion and scale
+static glm::mat4 getLocalTransform(const JsonValue& node)
+{
+	glm::mat4 transform{ 1.0f };
+
+	if(const JsonValue* matrix = findArray(node, "matrix"))
+	{
+		if(matrix->elements.size() == 16)
+		{
+			for(int c = 0; c < 4; c++)
+			{
+				for(int r = 0; r < 4; r++)
+				{
+					transform[c][r] = static_cast<float>(matrix->elements[4 * c + r].number);
+				}
+			}
+		}
+		return transform;
+	}
+
+	float translation[3] = { 0.0f, 0.0f, 0.0f };
+	float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float scale[3] = { 1.0f, 1.0f, 1.0f };
+	getFloats(node, "translation", translation, 3);
+	getFloats(node, "rotation", rotation, 4);
+	getFloats(node, "scale", scale, 3);
+
+	const float x = rotation[0];
+	const float y = rotation[1];
+	const float z = rotation[2];
+	const float w = rotation[3];
+	transform[0] = glm::vec4{ 1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f } * scale[0];
+	transform[1] = glm::vec4{ 2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f } * scale[1];
+	transform[2] = glm::vec4{ 2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f } * scale[2];
+	transform[3] = glm::vec4{ translation[0], translation[1], translation[2], 1.0f };
+	return transform;
+}
+
+static std::vector<GlbNode> readNodes(const JsonValue& root, size_t meshCount)
+{
+	const JsonValue* nodes = findArray(root, "nodes");
+	if(!nodes)
+	{
+		return {};
+	}
+	const size_t nodeCount = nodes->elements.size();
+
+	// roots of the default scene, or every node nothing refers to as a child when there are no scenes
+	std::vector<int32_t> roots;
+	const JsonValue* scenes = findArray(root, "scenes");
+	int32_t sceneIndex = getInt(root, "scene", 0);
+	if(scenes && sceneIndex >= 0 && sceneIndex < static_cast<int32_t>(scenes->elements.size()))
+	{
+		if(const JsonValue* sceneNodes = findArray(scenes->elements[sceneIndex], "nodes"))
+		{
+			for(const JsonValue& node : sceneNodes->elements)
+			{
+				roots.push_back(static_cast<int32_t>(node.number));
+			}
+		}
+	}
+	else
+	{
+		std::vector<bool> isChild(nodeCount, false);
+		for(const JsonValue& node : nodes->elements)
+		{
+			if(const JsonValue* children = findArray(node, "children"))
+			{
+				for(const JsonValue& child : children->elements)
+				{
+					size_t c = static_cast<size_t>(child.number);
+					if(c < nodeCount)
+					{
+						isChild[c] = true;
+					}
+				}
+			}
+		}
+		for(size_t n = 0; n < nodeCount; n++)
+		{
+			if(!isChild[n])
+			{
+				roots.push_back(static_cast<int32_t>(n));
+			}
+		}
+	}
+
+	std::vector<GlbNode> result;
+	std::vector<bool> visited(nodeCount, false);	// guards against cycles in malformed files
+
+	struct PendingNode
+	{
+		int32_t index;
+		glm::mat4 parentTransform;
+	};
+	std::vector<PendingNode> stack;
+	for(auto it = roots.rbegin(); it != roots.rend(); ++it)
+	{
+		stack.push_back({ *it, glm::mat4{ 1.0f } });
+	}
+
+	while(!stack.empty())
+	{
+		PendingNode pending = stack.back();
+		stack.pop_back();
+		if(pending.index < 0 || pending.index >= static_cast<int32_t>(nodeCount) || visited[pending.index])
+		{
+			throw std::runtime_error("failed to load glb: invalid node hierarchy!");
+		}
+		visited[pending.index] = true;
+
+		const JsonValue& nodeJson = nodes->elements[pending.index];
+		GlbNode node{};
+		node.name = getString(nodeJson, "name");
+		node.mesh = getInt(nodeJson, "mesh", -1);
+		node.worldTransform = pending.parentTransform * getLocalTransform(nodeJson);
+		if(node.mesh >= static_cast<int32_t>(meshCount))
+		{
+			throw std::runtime_error("failed to load glb: mesh index out of range!");
+		}
+
+		if(const JsonValue* children = findArray(nodeJson, "children"))
+		{
+			for(auto it = children->elements.rbegin(); it != children->elements.rend(); ++it)
+			{
+				stack.push_back({ static_cast<int32_t>(it->number), node.worldTransform });
+			}
+		}
+
+		result.push_back(std::move(node));
+	}
+
+	return result;
+}
+
+GlbFile::GlbFile(const std::string& filepath) : m_file(filepath)
+{
+	const uint8_t* data = m_file.getData();
+	size_t size = m_file.getSize();
+	if(size < 12 || readU32(data) != GLB_MAGIC || readU32(data + 4) != 2)
+	{
+		throw std::runtime_error("failed to load glb: not a binary glTF 2.0 file: " + filepath);
+	}
+	size = std::min<size_t>(size, readU32(data + 8));
+
+	const char* json = nullptr;
+	size_t jsonSize = 0;
+	const uint8_t* bin = nullptr;
+	size_t binSize = 0;
+
+	for(size_t offset = 12; offset + 8 <= size;)
+	{
+		size_t chunkSize = readU32(data + offset);
+		uint32_t chunkType = readU32(data + offset + 4);
+		offset += 8;
+		if(chunkSize > size - offset)
+		{
+			throw std::runtime_error("failed to load glb: truncated chunk!");
+		}
+
+		if(chunkType == GLB_CHUNK_JSON && !json)
+		{
+			json = reinterpret_cast<const char*>(data + offset);
+			jsonSize = chunkSize;
+		}
+		else if(chunkType == GLB_CHUNK_BIN && !bin)
+		{
+			bin = data + offset;
+			binSize = chunkSize;
+		}
+		offset += chunkSize;
+	}
+
+	if(!json)
+	{
+		throw std::runtime_error("failed to load glb: missing json chunk!");
+	}
+
+	const char* cursor = json;
+	JsonValue root = parseJsonValue(cursor, json + jsonSize, 0);
+	if(root.type != JsonValue::Type::Object)
+	{
+		throw std::runtime_error("failed to parse glb json!");
+	}
+
+	m_accessors = readAccessors(root, bin, binSize);
+	m_meshes = readMeshes(root, m_accessors);
+	m_nodes = readNodes(root, m_meshes.size());
+}
+
+// Integer components are gathered into lanes and converted and scaled four at a time
+template<typename T>
+static void convertIntegers(const GlbAccessor& accessor, uint32_t componentCount, float scale, float* dst, size_t dstStride)
+{
+	const bool clampToMinusOne = accessor.normalized && static_cast<T>(-1) < 0;
+	const uint8_t* element = accessor.data;
+	uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+	for(uint32_t i = 0; i < accessor.count; i++, element += accessor.stride, out += dstStride)
+	{
+		int32_t lanes[4] = {};
+		for(uint32_t c = 0; c < componentCount; c++)
+		{
+			T component;
+			std::memcpy(&component, element + c * sizeof(T), sizeof(T));
+			lanes[c] = static_cast<int32_t>(component);
+		}
+
+		float values[4];
+#ifdef GLB_USE_SSE
+		__m128 converted = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes))), _mm_set1_ps(scale));
+		if(clampToMinusOne)
+		{
+			converted = _mm_max_ps(converted, _mm_set1_ps(-1.0f));
+		}
+		_mm_storeu_ps(values, converted);
+#else
+		for(int c = 0; c < 4; c++)
+		{
+			values[c] = clampToMinusOne ? std::max(lanes[c] * scale, -1.0f) : lanes[c] * scale;
+		}
+#endif
+		std::memcpy(out, values, componentCount * sizeof(float));
+	}
+}
+
+void convertAccessor(const GlbAccessor& accessor, uint32_t componentCount, float* dst, size_t dstStride)
+{
+	componentCount = std::min({ componentCount, accessor.componentCount, 4u });
+	uint8_t* out = reinterpret_cast<uint8_t*>(dst);
+
+	if(!accessor.data)
+	{
+		for(uint32_t i = 0; i < accessor.count; i++, out += dstStride)
+		{
+			std::memset(out, 0, componentCount * sizeof(float));
+		}
+		return;
+	}
+
+	switch(accessor.componentType)
+	{
+	case GlbAccessor::FLOAT:
+	{
+		const uint8_t* element = accessor.data;
+		for(uint32_t i = 0; i < accessor.count; i++, element += accessor.stride, out += dstStride)
+		{
+			std::memcpy(out, element, componentCount * sizeof(float));
+		}
+		break;
+	}
+	case GlbAccessor::BYTE:
+		convertIntegers<int8_t>(accessor, componentCount, accessor.normalized ? 1.0f / 127.0f : 1.0f, dst, dstStride);
+		break;
+	case GlbAccessor::UNSIGNED_BYTE:
+		convertIntegers<uint8_t>(accessor, componentCount, accessor.normalized ? 1.0f / 255.0f : 1.0f, dst, dstStride);
+		break;
+	case GlbAccessor::SHORT:
+		convertIntegers<int16_t>(accessor, componentCount, accessor.normalized ? 1.0f / 32767.0f : 1.0f, dst, dstStride);
+		break;
+	case GlbAccessor::UNSIGNED_SHORT:
+		convertIntegers<uint16_t>(accessor, componentCount, accessor.normalized ? 1.0f / 65535.0f : 1.0f, dst, dstStride);
+		break;
+	default:
+		throw std::runtime_error("failed to load glb: unsupported attribute component type!");
+	}
+}
+
+template<typename Source, typename Index>
+static void copyIndices(const GlbAccessor& accessor, Index* dst)
+{
+	const uint8_t* element = accessor.data;
+	for(uint32_t i = 0; i < accessor.count; i++, element += accessor.stride)
+	{
+		Source index;
+		std::memcpy(&index, element, sizeof(index));
+		dst[i] = static_cast<Index>(index);
+	}
+}
+
+template<typename Index>
+static void convertIndicesTo(const GlbAccessor& accessor, Index* dst)
+{
+	if(!accessor.data)
+	{
+		std::fill(dst, dst + accessor.count, Index{ 0 });
+		return;
+	}
+
+	switch(accessor.componentType)
+	{
+	case GlbAccessor::UNSIGNED_BYTE:
+		copyIndices<uint8_t>(accessor, dst);
+		break;
+	case GlbAccessor::UNSIGNED_SHORT:
+		copyIndices<uint16_t>(accessor, dst);
+		break;
+	case GlbAccessor::UNSIGNED_INT:
+		copyIndices<uint32_t>(accessor, dst);
+		break;
+	default:
+		throw std::runtime_error("failed to load glb: unsupported index component type!");
+	}
+}
+
+void convertIndices(const GlbAccessor& accessor, uint32_t* dst)
+{
+	convertIndicesTo(accessor, dst);
+}
+
+void convertIndices(const GlbAccessor& accessor, uint16_t* dst)
+{
+	convertIndicesTo(accessor, dst);
+}
+
+}
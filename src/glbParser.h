@@ -0,0 +1,97 @@
+#pragma once
+
+#include "mappedFile.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU reading of binary glTF 2.0 files, independent of any GPU state
+
+// Typed view of a glTF accessor, pointing into the mapped binary chunk
+struct GlbAccessor
+{
+	static constexpr uint32_t BYTE = 5120;
+	static constexpr uint32_t UNSIGNED_BYTE = 5121;
+	static constexpr uint32_t SHORT = 5122;
+	static constexpr uint32_t UNSIGNED_SHORT = 5123;
+	static constexpr uint32_t UNSIGNED_INT = 5125;
+	static constexpr uint32_t FLOAT = 5126;
+
+	const uint8_t* data = nullptr;	// null for accessors without a buffer view, which read as zeros
+	uint32_t count = 0;
+	uint32_t stride = 0;	// bytes between elements, the element size when the buffer view is tightly packed
+	uint32_t componentType = 0;
+	uint32_t componentCount = 0;
+	bool normalized = false;
+
+	uint32_t getElementSize() const;
+	// True when the elements are count tightly packed T[components]
+	bool isTight(uint32_t type, uint32_t components) const;
+};
+
+// Accessor indices of one triangle list, -1 for attributes the primitive does not have
+struct GlbPrimitive
+{
+	int32_t position = -1;
+	int32_t normal = -1;
+	int32_t texcoord = -1;
+	int32_t color = -1;
+	int32_t indices = -1;
+};
+
+struct GlbMesh
+{
+	std::string name;
+	std::vector<GlbPrimitive> primitives;
+};
+
+struct GlbNode
+{
+	std::string name;
+	int32_t mesh = -1;
+	glm::mat4 worldTransform{ 1.0f };	// parent transforms already applied
+};
+
+// Memory-maps a .glb file and reads its JSON chunk. Accessors stay views into the mapping,
+// so vertex data is never copied before the caller stages it.
+// Only the embedded binary chunk is supported as a buffer, files referencing external buffers,
+// sparse accessors or non triangle list primitives are rejected.
+class GlbFile
+{
+public:
+	GlbFile(const std::string& filepath);
+
+	GlbFile(const GlbFile&) = delete;
+	GlbFile& operator=(const GlbFile&) = delete;
+
+	const GlbAccessor& getAccessor(int32_t index) const { return m_accessors[index]; }
+	const std::vector<GlbMesh>& getMeshes() const { return m_meshes; }
+	// Nodes of the default scene in depth first order, parents before their children
+	const std::vector<GlbNode>& getNodes() const { return m_nodes; }
+
+private:
+	MappedFile m_file;
+
+	std::vector<GlbAccessor> m_accessors;
+	std::vector<GlbMesh> m_meshes;
+	std::vector<GlbNode> m_nodes;
+};
+
+// Converts the accessor elements to floats written dstStride bytes apart. Writes at most componentCount
+// floats per element and leaves the rest of dst untouched, normalized integers map to [0, 1] or [-1, 1].
+void convertAccessor(const GlbAccessor& accessor, uint32_t componentCount, float* dst, size_t dstStride);
+
+// Widens or narrows indices of any glTF index type, narrowing expects them to fit
+void convertIndices(const GlbAccessor& accessor, uint32_t* dst);
+void convertIndices(const GlbAccessor& accessor, uint16_t* dst);
+
+}
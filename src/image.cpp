@@ -1,9 +1,14 @@
 #include "image.h"
+#include "blockCompression.h"
+#include "mipmap.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <stdexcept>
+#include <vector>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../"
@@ -12,53 +17,146 @@
 namespace VulkanEngine
 {
 
-Image::Image(Device& device, const std::string& filepath) : m_device(device)
+static bool supportsLinearBlit(Device& device, VkFormat format)
 {
-	std::string enginePath = ENGINE_DIR + filepath;
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(device.getPhysicalDevice(), format, &properties);
 
+	VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	return (properties.optimalTilingFeatures & required) == required;
+}
+
+static ImageData decodeImage(Device& device, const std::string& filepath)
+{
 	int texWidth, texHeight, texChannels;
-	stbi_uc* pixels = stbi_load(enginePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	stbi_uc* pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	size_t imageSize = static_cast<size_t>(texWidth) * texHeight * 4;
 
 	if(!pixels)
 	{
 		throw std::runtime_error("failed to load texture image!");
 	}
 
-	VkBuffer stagingBuffer;
-	VkDeviceMemory stagingBufferMemory;
+	ImageData data{};
+	data.format = VK_FORMAT_R8G8B8A8_SRGB;
+	data.width = static_cast<uint32_t>(texWidth);
+	data.height = static_cast<uint32_t>(texHeight);
+	data.mipLevels = getMipLevelCount(data.width, data.height);
+	data.texels.assign(pixels, pixels + imageSize);
+	stbi_image_free(pixels);
+
+	if(supportsLinearBlit(device, data.format))
+	{
+		data.generateMipmaps = true;
+		data.levelOffsets = { 0, imageSize };
+	}
+	else
+	{
+		// averaged in linear space, as the GPU filters sRGB formats
+		data.levelOffsets = generateMipChain(data.texels, data.width, data.height, true);
+	}
+	return data;
+}
+
+static ImageData decodeKtx2(Device& device, const std::string& filepath)
+{
+	auto pFile = std::make_shared<Ktx2File>(filepath);
 
-	m_device.createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory);
+	ImageData data{};
+	data.width = pFile->getWidth();
+	data.height = pFile->getHeight();
+	data.mipLevels = pFile->getLevelCount();
 
-	void* data;
-	vkMapMemory(m_device.getDevice(), stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	vkUnmapMemory(m_device.getDevice(), stagingBufferMemory);
+	// devices without BC support, like most mobile GPUs, get the blocks decoded to RGBA8 instead
+	VkFormat fallbackFormat = isSrgbFormat(pFile->getFormat()) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+	data.format = device.findSupportedFormat({ pFile->getFormat(), fallbackFormat }, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
 
-	stbi_image_free(pixels);
+	// blocks are copied straight from the mapped file, the levels are already in the format the image expects
+	if(data.format == pFile->getFormat())
+	{
+		data.pFile = std::move(pFile);
+		return data;
+	}
 
-	createImage(texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	BlockFormat blockFormat;
+	getBlockFormat(pFile->getFormat(), blockFormat);
 
-	transitionImageLayout(VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	m_device.copyBufferToImage(stagingBuffer, m_image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), 1);
-	transitionImageLayout(VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	data.levelOffsets.resize(data.mipLevels + 1);
+	for(uint32_t level = 0; level < data.mipLevels; level++)
+	{
+		data.levelOffsets[level + 1] = data.levelOffsets[level] + static_cast<size_t>(std::max(1u, data.width >> level)) * std::max(1u, data.height >> level) * 4;
+	}
+	data.texels.resize(data.levelOffsets[data.mipLevels]);
 
-	vkDestroyBuffer(m_device.getDevice(), stagingBuffer, nullptr);
-	vkFreeMemory(m_device.getDevice(), stagingBufferMemory, nullptr);
+	for(uint32_t level = 0; level < data.mipLevels; level++)
+	{
+		decompressImage(pFile->getLevelData(level), std::max(1u, data.width >> level), std::max(1u, data.height >> level), blockFormat, data.texels.data() + data.levelOffsets[level]);
+	}
+	return data;
+}
+
+ImageData Image::decode(Device& device, const std::string& filepath)
+{
+	std::filesystem::path enginePath = ENGINE_DIR + filepath;
+
+	// a texture cooked by TextureCompressor next to its source is used in its place
+	std::filesystem::path cookedPath = enginePath;
+	cookedPath.replace_extension(".ktx2");
+	std::error_code error;
+	if(std::filesystem::exists(cookedPath, error))
+	{
+		return decodeKtx2(device, cookedPath.string());
+	}
+	return decodeImage(device, enginePath.string());
+}
+
+Image::Image(Device& device, UploadBatch& uploadBatch, const ImageData& data, uint32_t firstLevel) :
+	m_device(device), m_firstLevel(firstLevel), m_mipLevels(data.mipLevels - firstLevel), m_format(data.format)
+{
+	if(firstLevel >= data.mipLevels || (firstLevel > 0 && data.generateMipmaps))
+	{
+		throw std::invalid_argument("image levels have to be present in the data");
+	}
+
+	uint32_t width = std::max(1u, data.width >> firstLevel);
+	uint32_t height = std::max(1u, data.height >> firstLevel);
+
+	// blits read the level above, so generated chains need the image as a transfer source too
+	VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	if(data.generateMipmaps)
+	{
+		usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+	createImage(width, height, m_mipLevels, m_format, VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	// the batch copies the texels into its staging memory, so the data can be released right away
+	uploadBatch.transitionImageLayout(m_image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels);
+
+	if(data.generateMipmaps)
+	{
+		uploadBatch.copyToImage(data.getLevelData(0), data.getLevelSize(0), m_image, width, height, 1);
+		uploadBatch.generateMipmaps(m_image, width, height, m_mipLevels);
+	}
+	else
+	{
+		for(uint32_t level = 0; level < m_mipLevels; level++)
+		{
+			uploadBatch.copyToImage(data.getLevelData(firstLevel + level), data.getLevelSize(firstLevel + level), m_image, std::max(1u, width >> level), std::max(1u, height >> level), 1, level);
+		}
+		uploadBatch.transitionImageLayout(m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels);
+	}
 
 	createImageView();
-	createSampler();
 }
 
 Image::~Image()
 {
-	vkDestroySampler(m_device.getDevice(), m_sampler, nullptr);
 	vkDestroyImageView(m_device.getDevice(), m_imageView, nullptr);
 	vkDestroyImage(m_device.getDevice(), m_image, nullptr);
-	vkFreeMemory(m_device.getDevice(), m_imageMemory, nullptr);
+	m_device.getMemoryAllocator().free(m_imageMemory);
 }
 
-void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
+void Image::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties)
 {
 	VkImageCreateInfo imageInfo{};
 	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -66,7 +164,7 @@ void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImag
 	imageInfo.extent.width = width;
 	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
+	imageInfo.mipLevels = mipLevels;
 	imageInfo.arrayLayers = 1;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
@@ -76,71 +174,7 @@ void Image::createImage(uint32_t width, uint32_t height, VkFormat format, VkImag
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
 	imageInfo.flags = 0;
 
-	if(vkCreateImage(m_device.getDevice(), &imageInfo, nullptr, &m_image) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create image!");
-	}
-
-	VkMemoryRequirements memRequirements;
-	vkGetImageMemoryRequirements(m_device.getDevice(), m_image, &memRequirements);
-
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = m_device.findMemoryType(memRequirements.memoryTypeBits, properties);
-
-	if(vkAllocateMemory(m_device.getDevice(), &allocInfo, nullptr, &m_imageMemory) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to allocate image memory!");
-	}
-
-	vkBindImageMemory(m_device.getDevice(), m_image, m_imageMemory, 0);
-}
-
-void Image::transitionImageLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
-{
-	VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
-
-	VkImageMemoryBarrier barrier{};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.oldLayout = oldLayout;
-	barrier.newLayout = newLayout;
-	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.image = m_image;
-	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
-
-	VkPipelineStageFlags srcStageMask;
-	VkPipelineStageFlags dstStageMask;
-
-	if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-	{
-		barrier.srcAccessMask = 0;
-		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-		srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-		dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
-	}
-	else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-	{
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	}
-	else
-	{
-		throw std::invalid_argument("unsupported layout transition!");
-	}
-
-	vkCmdPipelineBarrier(commandBuffer, srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-	m_device.endSingleTimeCommands(commandBuffer);
+	m_device.createImage(imageInfo, properties, m_image, m_imageMemory);
 }
 
 void Image::createImageView()
@@ -149,10 +183,10 @@ void Image::createImageView()
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = m_image;
 	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+	viewInfo.format = m_format;
 	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = m_mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
 	viewInfo.subresourceRange.layerCount = 1;
 
@@ -162,33 +196,4 @@ void Image::createImageView()
 	}
 }
 
-void Image::createSampler()
-{
-	VkPhysicalDeviceProperties properties{};
-	vkGetPhysicalDeviceProperties(m_device.getPhysicalDevice(), &properties);
-
-	VkSamplerCreateInfo samplerInfo{};
-	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-	samplerInfo.magFilter = VK_FILTER_LINEAR;
-	samplerInfo.minFilter = VK_FILTER_LINEAR;
-	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-	samplerInfo.anisotropyEnable = VK_TRUE;
-	samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
-	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-	samplerInfo.unnormalizedCoordinates = VK_FALSE;
-	samplerInfo.compareEnable = VK_FALSE;
-	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-	samplerInfo.mipLodBias = 0.0f;
-	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
-
-	if (vkCreateSampler(m_device.getDevice(), &samplerInfo, nullptr, &m_sampler) != VK_SUCCESS)
-	{
-		throw std::runtime_error("failed to create texture sampler!");
-	}
-}
-
 }
\ No newline at end of file
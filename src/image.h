@@ -1,34 +1,56 @@
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 #include "device.h"
+#include "imageData.h"
+#include "uploadBatch.h"
 
 namespace VulkanEngine
 {
 
+// Sampled texture with a full mip chain. Its upload is recorded into an upload batch,
+// so the image may only be sampled once that batch has been flushed.
 class Image
 {
 public:
-	Image(Device& device, const std::string& filepath);
+	// Decodes a file relative to the engine directory. A KTX2 file cooked next to it is preferred and kept
+	// block-compressed when the device samples its format, decoded to RGBA8 otherwise. For plain images the levels
+	// are left to GPU blits when the format supports linear blits and downsampled on the CPU otherwise.
+	// Only queries format support on the device, so it may run on any thread.
+	static ImageData decode(Device& device, const std::string& filepath);
+
+	// Only levels from firstLevel on, the image then has the extent of that level. Needs every level in data.
+	Image(Device& device, UploadBatch& uploadBatch, const ImageData& data, uint32_t firstLevel = 0);
+	Image(Device& device, UploadBatch& uploadBatch, const std::string& filepath) : Image(device, uploadBatch, decode(device, filepath)) {}
 	~Image();
 
+	Image(const Image&) = delete;
+	Image& operator=(const Image&) = delete;
+
 	VkImageView getImageView() const { return m_imageView; }
-	VkSampler getSampler() const { return m_sampler; }
+	// Level of the source data that is level 0 of the image
+	uint32_t getFirstLevel() const { return m_firstLevel; }
+	// Device memory backing the image
+	VkDeviceSize getMemorySize() const { return m_imageMemory.size; }
 
-	VkDescriptorImageInfo getImageInfo() const { return { m_sampler, m_imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }; }
+	// Samplers are not owned by images, textures share them through a SamplerCache
+	VkDescriptorImageInfo getImageInfo(VkSampler sampler) const { return { sampler, m_imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }; }
 
 private:
-	void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
-	void transitionImageLayout(VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties);
 	void createImageView();
-	void createSampler();
 
 	Device& m_device;
 
+	uint32_t m_firstLevel = 0;
+	uint32_t m_mipLevels = 1;
+	VkFormat m_format = VK_FORMAT_R8G8B8A8_SRGB;
+
 	VkImage m_image;
-	VkDeviceMemory m_imageMemory;
+	MemoryAllocation m_imageMemory;
 	VkImageView m_imageView;
-	VkSampler m_sampler;
 };
 
 }
\ No newline at end of file
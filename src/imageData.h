@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ktx2.h"
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Texels of an image decoded on the CPU, ready to be uploaded
+struct ImageData
+{
+	VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+	uint32_t width = 1;
+	uint32_t height = 1;
+	uint32_t mipLevels = 1;
+	// only level 0 is stored, the others are blitted from it on upload
+	bool generateMipmaps = false;
+
+	// level l spans [levelOffsets[l], levelOffsets[l + 1]) of texels
+	std::vector<uint8_t> texels;
+	std::vector<size_t> levelOffsets;
+	// levels uploaded straight from a mapped KTX2 file instead of texels
+	std::shared_ptr<Ktx2File> pFile;
+
+	const uint8_t* getLevelData(uint32_t level) const { return pFile ? pFile->getLevelData(level) : texels.data() + levelOffsets[level]; }
+	size_t getLevelSize(uint32_t level) const { return pFile ? pFile->getLevelSize(level) : levelOffsets[level + 1] - levelOffsets[level]; }
+};
+
+}
@@ -0,0 +1,267 @@
+#include "ktx2.h"
+
+#include "blockCompression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+static const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+struct Ktx2Header
+{
+	uint8_t identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	uint32_t supercompressionScheme;
+
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header and index must match the file layout");
+static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index entries must match the file layout");
+
+// Data Format Descriptor values from the Khronos Data Format specification
+static constexpr uint8_t KHR_DF_MODEL_RGBSDA = 1;
+static constexpr uint8_t KHR_DF_MODEL_BC1A = 128;
+static constexpr uint8_t KHR_DF_MODEL_BC3 = 130;
+static constexpr uint8_t KHR_DF_MODEL_BC7 = 134;
+static constexpr uint8_t KHR_DF_PRIMARIES_BT709 = 1;
+static constexpr uint8_t KHR_DF_TRANSFER_LINEAR = 1;
+static constexpr uint8_t KHR_DF_TRANSFER_SRGB = 2;
+static constexpr uint8_t KHR_DF_CHANNEL_ALPHA = 15;
+static constexpr uint8_t KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x10;
+
+struct DfdSample
+{
+	uint16_t bitOffset;
+	uint8_t bitLength;	// minus one
+	uint8_t channel;	// channel id in the low nibble, qualifiers in the high one
+	uint8_t samplePosition[4];
+	uint32_t sampleLower;
+	uint32_t sampleUpper;
+};
+
+static_assert(sizeof(DfdSample) == 16, "DFD samples must match the file layout");
+
+static size_t alignUp(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+// Basic descriptor block of the format, preceded by the total DFD size
+static std::vector<uint8_t> createDataFormatDescriptor(VkFormat format)
+{
+	bool srgb = isSrgbFormat(format);
+
+	BlockFormat blockFormat;
+	std::vector<DfdSample> samples;
+	uint8_t colorModel;
+	uint8_t blockDimension;
+	uint8_t bytesPerBlock;
+
+	if(getBlockFormat(format, blockFormat))
+	{
+		blockDimension = 3;
+		bytesPerBlock = static_cast<uint8_t>(getBlockSize(blockFormat));
+		switch(blockFormat)
+		{
+		case BlockFormat::BC1:
+			colorModel = KHR_DF_MODEL_BC1A;
+			samples.push_back({ 0, 63, 0, {}, 0, UINT32_MAX });
+			break;
+		case BlockFormat::BC3:
+			colorModel = KHR_DF_MODEL_BC3;
+			samples.push_back({ 0, 63, KHR_DF_CHANNEL_ALPHA | KHR_DF_SAMPLE_DATATYPE_LINEAR, {}, 0, UINT32_MAX });
+			samples.push_back({ 64, 63, 0, {}, 0, UINT32_MAX });
+			break;
+		default:
+			colorModel = KHR_DF_MODEL_BC7;
+			samples.push_back({ 0, 127, 0, {}, 0, UINT32_MAX });
+			break;
+		}
+	}
+	else
+	{
+		colorModel = KHR_DF_MODEL_RGBSDA;
+		blockDimension = 0;
+		bytesPerBlock = 4;
+		for(uint8_t channel = 0; channel < 3; channel++)
+		{
+			samples.push_back({ static_cast<uint16_t>(channel * 8), 7, channel, {}, 0, 255 });
+		}
+		samples.push_back({ 24, 7, KHR_DF_CHANNEL_ALPHA | KHR_DF_SAMPLE_DATATYPE_LINEAR, {}, 0, 255 });
+	}
+
+	uint32_t blockSize = 24 + static_cast<uint32_t>(samples.size() * sizeof(DfdSample));
+	uint32_t words[7] =
+	{
+		4 + blockSize,
+		0,	// Khronos vendor, basic descriptor type
+		2 | (blockSize << 16),	// version 1.3 of the format spec
+		static_cast<uint32_t>(colorModel | (KHR_DF_PRIMARIES_BT709 << 8) | ((srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16)),
+		static_cast<uint32_t>(blockDimension | (blockDimension << 8)),
+		bytesPerBlock,
+		0
+	};
+
+	std::vector<uint8_t> descriptor(4 + blockSize);
+	std::memcpy(descriptor.data(), words, sizeof(words));
+	std::memcpy(descriptor.data() + sizeof(words), samples.data(), samples.size() * sizeof(DfdSample));
+	return descriptor;
+}
+
+static size_t getLevelAlignment(VkFormat format)
+{
+	// lcm of the texel block size and 4
+	BlockFormat blockFormat;
+	return getBlockFormat(format, blockFormat) ? getBlockSize(blockFormat) : 4;
+}
+
+bool Ktx2File::isSupportedFormat(VkFormat format)
+{
+	BlockFormat blockFormat;
+	return getBlockFormat(format, blockFormat) || format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+size_t Ktx2File::getLevelSize(VkFormat format, uint32_t width, uint32_t height)
+{
+	BlockFormat blockFormat;
+	if(getBlockFormat(format, blockFormat))
+	{
+		return getCompressedSize(blockFormat, width, height);
+	}
+	return static_cast<size_t>(width) * height * 4;
+}
+
+Ktx2File::Ktx2File(const std::string& filepath) : m_file{ filepath }
+{
+	if(m_file.getSize() < sizeof(Ktx2Header))
+	{
+		throw std::runtime_error("failed to read KTX2 file: " + filepath);
+	}
+
+	Ktx2Header header;
+	std::memcpy(&header, m_file.getData(), sizeof(Ktx2Header));
+
+	if(std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+	{
+		throw std::runtime_error("failed to read KTX2 file, bad identifier: " + filepath);
+	}
+
+	VkFormat format = static_cast<VkFormat>(header.vkFormat);
+	if(!isSupportedFormat(format) || header.supercompressionScheme != 0)
+	{
+		throw std::runtime_error("failed to read KTX2 file, unsupported format: " + filepath);
+	}
+
+	if(header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+	{
+		throw std::runtime_error("failed to read KTX2 file, not a single 2D image: " + filepath);
+	}
+
+	// a level count of 0 asks the loader to generate the chain, the base level is still stored
+	uint32_t levelCount = std::max(1u, header.levelCount);
+	if(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex) > m_file.getSize())
+	{
+		throw std::runtime_error("failed to read KTX2 file, truncated level index: " + filepath);
+	}
+
+	m_format = format;
+	m_width = header.pixelWidth;
+	m_height = header.pixelHeight;
+	m_levels.resize(levelCount);
+
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		Ktx2LevelIndex index;
+		std::memcpy(&index, m_file.getData() + sizeof(Ktx2Header) + level * sizeof(Ktx2LevelIndex), sizeof(Ktx2LevelIndex));
+
+		size_t expectedSize = getLevelSize(m_format, std::max(1u, m_width >> level), std::max(1u, m_height >> level));
+		if(index.byteLength != expectedSize || index.byteOffset > m_file.getSize() || index.byteLength > m_file.getSize() - index.byteOffset)
+		{
+			throw std::runtime_error("failed to read KTX2 file, bad level size: " + filepath);
+		}
+
+		m_levels[level] = { static_cast<size_t>(index.byteOffset), static_cast<size_t>(index.byteLength) };
+	}
+}
+
+void Ktx2File::write(const std::string& filepath, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels)
+{
+	if(!isSupportedFormat(format) || levels.empty())
+	{
+		throw std::invalid_argument("KTX2 writer needs at least one level in a supported format");
+	}
+
+	std::vector<uint8_t> descriptor = createDataFormatDescriptor(format);
+	uint32_t levelCount = static_cast<uint32_t>(levels.size());
+
+	Ktx2Header header{};
+	std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+	header.vkFormat = static_cast<uint32_t>(format);
+	header.typeSize = 1;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.faceCount = 1;
+	header.levelCount = levelCount;
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2LevelIndex));
+	header.dfdByteLength = static_cast<uint32_t>(descriptor.size());
+
+	// level data follows the descriptor, smallest level first
+	std::vector<Ktx2LevelIndex> levelIndex(levelCount);
+	size_t alignment = getLevelAlignment(format);
+	size_t offset = header.dfdByteOffset + header.dfdByteLength;
+	for(uint32_t level = levelCount; level-- > 0;)
+	{
+		size_t expectedSize = getLevelSize(format, std::max(1u, width >> level), std::max(1u, height >> level));
+		if(levels[level].size() != expectedSize)
+		{
+			throw std::invalid_argument("KTX2 level data does not match its extent");
+		}
+
+		offset = alignUp(offset, alignment);
+		levelIndex[level] = { offset, levels[level].size(), levels[level].size() };
+		offset += levels[level].size();
+	}
+
+	std::vector<uint8_t> contents(offset);
+	std::memcpy(contents.data(), &header, sizeof(Ktx2Header));
+	std::memcpy(contents.data() + sizeof(Ktx2Header), levelIndex.data(), levelCount * sizeof(Ktx2LevelIndex));
+	std::memcpy(contents.data() + header.dfdByteOffset, descriptor.data(), descriptor.size());
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		std::memcpy(contents.data() + levelIndex[level].byteOffset, levels[level].data(), levels[level].size());
+	}
+
+	std::ofstream file{ filepath, std::ios::binary | std::ios::trunc };
+	if(!file.is_open())
+	{
+		throw std::runtime_error("failed to open file: " + filepath);
+	}
+	file.write(reinterpret_cast<const char*>(contents.data()), contents.size());
+}
+
+}
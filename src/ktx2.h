@@ -0,0 +1,55 @@
+#pragma once
+
+#include "mappedFile.h"
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// KTX2 texture container, limited to what the engine cooks: single 2D images with a mip chain, no supercompression,
+// in BC1, BC3, BC7 or R8G8B8A8, each in UNORM or sRGB.
+// The file is memory-mapped so level data can be copied straight to staging memory.
+class Ktx2File
+{
+public:
+	Ktx2File(const std::string& filepath);
+
+	Ktx2File(const Ktx2File&) = delete;
+	Ktx2File& operator=(const Ktx2File&) = delete;
+
+	// Writes the levels, level 0 first, each holding the tightly packed texels or blocks of its extent
+	static void write(const std::string& filepath, VkFormat format, uint32_t width, uint32_t height, const std::vector<std::vector<uint8_t>>& levels);
+
+	static bool isSupportedFormat(VkFormat format);
+	// Bytes of a tightly packed level of the given extent
+	static size_t getLevelSize(VkFormat format, uint32_t width, uint32_t height);
+
+	VkFormat getFormat() const { return m_format; }
+	uint32_t getWidth() const { return m_width; }
+	uint32_t getHeight() const { return m_height; }
+	uint32_t getLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+
+	// Points into the mapped file, valid for the lifetime of the file
+	const uint8_t* getLevelData(uint32_t level) const { return m_file.getData() + m_levels[level].offset; }
+	size_t getLevelSize(uint32_t level) const { return m_levels[level].size; }
+
+private:
+	struct Level
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	MappedFile m_file;
+
+	VkFormat m_format = VK_FORMAT_UNDEFINED;
+	uint32_t m_width = 0;
+	uint32_t m_height = 0;
+	std::vector<Level> m_levels;
+};
+
+}
@@ -0,0 +1,108 @@
+#include "mappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanEngine
+{
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filepath)
+{
+	HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("failed to open file: " + filepath);
+	}
+	m_file = file;
+
+	LARGE_INTEGER size{};
+	GetFileSizeEx(file, &size);
+	m_size = static_cast<size_t>(size.QuadPart);
+
+	if(m_size == 0)
+	{
+		return;
+	}
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(m_mapping == nullptr)
+	{
+		CloseHandle(file);
+		throw std::runtime_error("failed to map file: " + filepath);
+	}
+
+	m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if(m_pData == nullptr)
+	{
+		CloseHandle(m_mapping);
+		CloseHandle(file);
+		throw std::runtime_error("failed to map file: " + filepath);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if(m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if(m_mapping)
+	{
+		CloseHandle(m_mapping);
+	}
+	CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filepath)
+{
+	m_file = open(filepath.c_str(), O_RDONLY);
+	if(m_file < 0)
+	{
+		throw std::runtime_error("failed to open file: " + filepath);
+	}
+
+	struct stat info{};
+	fstat(m_file, &info);
+	m_size = static_cast<size_t>(info.st_size);
+
+	if(m_size == 0)
+	{
+		return;
+	}
+
+	void* pData = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if(pData == MAP_FAILED)
+	{
+		close(m_file);
+		throw std::runtime_error("failed to map file: " + filepath);
+	}
+
+	m_pData = static_cast<const uint8_t*>(pData);
+}
+
+MappedFile::~MappedFile()
+{
+	if(m_pData)
+	{
+		munmap(const_cast<uint8_t*>(m_pData), m_size);
+	}
+	close(m_file);
+}
+
+#endif
+
+}
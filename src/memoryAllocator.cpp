@@ -0,0 +1,237 @@
+#include "memoryAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+MemoryAllocator::MemoryAllocator(BlockSource& source, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity,
+	VkDeviceSize nonCoherentAtomSize, VkDeviceSize blockSize) :
+	m_source(source), m_memoryProperties(memoryProperties), m_bufferImageGranularity(std::max<VkDeviceSize>(bufferImageGranularity, 1)),
+	m_nonCoherentAtomSize(std::max<VkDeviceSize>(nonCoherentAtomSize, 1))
+{
+	m_memoryTypes.resize(memoryProperties.memoryTypeCount);
+	for(uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+	{
+		// small heaps, like the host visible part of VRAM, are not taken by a few blocks
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[i].heapIndex].size;
+		m_memoryTypes[i].blockSize = std::min(blockSize, std::max<VkDeviceSize>(heapSize / 8, 1));
+	}
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+	for(uint32_t type = 0; type < m_memoryTypes.size(); type++)
+	{
+		assert(m_memoryTypes[type].allocationCount == 0 && "Device memory is still allocated");
+
+		for(uint32_t block = 0; block < m_memoryTypes[type].blocks.size(); block++)
+		{
+			if(m_memoryTypes[type].blocks[block].memory != VK_NULL_HANDLE)
+			{
+				destroyBlock(type, block);
+			}
+		}
+	}
+}
+
+MemoryAllocation MemoryAllocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear)
+{
+	uint32_t typeIndex = findMemoryType(requirements.memoryTypeBits, properties);
+	VkMemoryPropertyFlags typeFlags = m_memoryProperties.memoryTypes[typeIndex].propertyFlags;
+
+	VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+	VkDeviceSize size = requirements.size;
+	if(!linear)
+	{
+		alignment = std::max(alignment, m_bufferImageGranularity);
+		size = alignUp(size, m_bufferImageGranularity);
+	}
+	// coherent memory too, flushed ranges have to be whole atoms either way
+	if(typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		alignment = std::max(alignment, m_nonCoherentAtomSize);
+		size = alignUp(size, m_nonCoherentAtomSize);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	MemoryType& type = m_memoryTypes[typeIndex];
+
+	MemoryAllocation allocation{};
+	allocation.size = size;
+	allocation.memoryTypeIndex = typeIndex;
+	allocation.wastedSize = size - requirements.size;
+
+	if(size > type.blockSize / 2)
+	{
+		allocation.block = createBlock(typeIndex, size, true);
+		allocation.dedicated = true;
+	}
+	else
+	{
+		allocation.offset = TlsfAllocator::INVALID_OFFSET;
+		for(uint32_t block = 0; block < type.blocks.size() && allocation.offset == TlsfAllocator::INVALID_OFFSET; block++)
+		{
+			if(type.blocks[block].pAllocator)
+			{
+				allocation.offset = type.blocks[block].pAllocator->allocate(size, alignment);
+				allocation.block = block;
+			}
+		}
+
+		if(allocation.offset == TlsfAllocator::INVALID_OFFSET)
+		{
+			allocation.block = createBlock(typeIndex, type.blockSize, false);
+			allocation.offset = type.blocks[allocation.block].pAllocator->allocate(size, alignment);
+			assert(allocation.offset != TlsfAllocator::INVALID_OFFSET && "Allocation does not fit an empty block");
+		}
+	}
+
+	const Block& block = type.blocks[allocation.block];
+	allocation.memory = block.memory;
+	allocation.pMapped = block.pMapped ? static_cast<char*>(block.pMapped) + allocation.offset : nullptr;
+
+	type.usedBytes += requirements.size;
+	type.wastedBytes += allocation.wastedSize;
+	type.allocationCount++;
+	return allocation;
+}
+
+void MemoryAllocator::free(const MemoryAllocation& allocation)
+{
+	if(allocation.memory == VK_NULL_HANDLE)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	MemoryType& type = m_memoryTypes[allocation.memoryTypeIndex];
+
+	type.usedBytes -= allocation.size - allocation.wastedSize;
+	type.wastedBytes -= allocation.wastedSize;
+	type.allocationCount--;
+
+	if(allocation.dedicated)
+	{
+		destroyBlock(allocation.memoryTypeIndex, allocation.block);
+		return;
+	}
+
+	TlsfAllocator& allocator = *type.blocks[allocation.block].pAllocator;
+	allocator.free(allocation.offset);
+
+	// one empty block is kept, so a resource that is recreated every now and then does not allocate a block each time
+	if(allocator.isEmpty())
+	{
+		for(uint32_t block = 0; block < type.blocks.size(); block++)
+		{
+			if(block != allocation.block && type.blocks[block].pAllocator && type.blocks[block].pAllocator->isEmpty())
+			{
+				destroyBlock(allocation.memoryTypeIndex, allocation.block);
+				break;
+			}
+		}
+	}
+}
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+	for(uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+	{
+		if((typeFilter & (1 << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+		{
+			return i;
+		}
+	}
+
+	throw std::runtime_error("failed to find suitable memory type!");
+}
+
+MemoryAllocator::Stats MemoryAllocator::getStats() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	Stats stats{};
+	for(const MemoryType& type : m_memoryTypes)
+	{
+		stats.allocationCount += type.allocationCount;
+		stats.usedBytes += type.usedBytes;
+		stats.wastedBytes += type.wastedBytes;
+
+		for(const Block& block : type.blocks)
+		{
+			if(block.memory == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+
+			stats.allocatedBytes += block.size;
+			if(block.dedicated)
+			{
+				stats.dedicatedCount++;
+				continue;
+			}
+
+			stats.blockCount++;
+			stats.freeBytes += block.pAllocator->getFreeSize();
+			stats.largestFreeRange = std::max(stats.largestFreeRange, block.pAllocator->getLargestFreeRange());
+			stats.freeRangeCount += block.pAllocator->getFreeRangeCount();
+		}
+	}
+	return stats;
+}
+
+uint32_t MemoryAllocator::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated)
+{
+	MemoryType& type = m_memoryTypes[memoryTypeIndex];
+
+	Block block{};
+	block.memory = m_source.allocateMemory(memoryTypeIndex, size);
+	if(block.memory == VK_NULL_HANDLE)
+	{
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+
+	if(m_memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		block.pMapped = m_source.mapMemory(block.memory);
+		if(!block.pMapped)
+		{
+			m_source.freeMemory(block.memory);
+			throw std::runtime_error("failed to map device memory!");
+		}
+	}
+
+	block.size = size;
+	block.dedicated = dedicated;
+	if(!dedicated)
+	{
+		block.pAllocator = std::make_unique<TlsfAllocator>(size);
+	}
+
+	auto slot = std::find_if(type.blocks.begin(), type.blocks.end(), [](const Block& other) { return other.memory == VK_NULL_HANDLE; });
+	if(slot != type.blocks.end())
+	{
+		*slot = std::move(block);
+		return static_cast<uint32_t>(slot - type.blocks.begin());
+	}
+
+	type.blocks.push_back(std::move(block));
+	return static_cast<uint32_t>(type.blocks.size() - 1);
+}
+
+void MemoryAllocator::destroyBlock(uint32_t memoryTypeIndex, uint32_t block)
+{
+	// freeing memory unmaps it implicitly
+	m_source.freeMemory(m_memoryTypes[memoryTypeIndex].blocks[block].memory);
+	m_memoryTypes[memoryTypeIndex].blocks[block] = {};
+}
+
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "tlsfAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Range of device memory backing one buffer or image
+struct MemoryAllocation
+{
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	// host visible memory stays mapped for its lifetime, nullptr otherwise
+	void* pMapped = nullptr;
+
+	uint32_t memoryTypeIndex = 0;
+	uint32_t block = 0;
+	bool dedicated = false;
+	// padding at the end of size the resource did not ask for
+	VkDeviceSize wastedSize = 0;
+};
+
+// Sub-allocates buffers and images from large device memory blocks, one list of blocks per memory type, so resources
+// do not each cost a vkAllocateMemory call and count against maxMemoryAllocationCount. Resources larger than half
+// a block get a dedicated allocation instead. Thread-safe.
+//
+// Linear and optimally tiled resources may not share a page of bufferImageGranularity bytes, so images are aligned
+// and padded to whole pages. Allocations of host visible memory are aligned and padded to nonCoherentAtomSize,
+// so any range of them rounded out to whole atoms stays inside the allocation.
+class MemoryAllocator
+{
+public:
+	static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+	// Hands out the device memory that blocks are carved from, the device in the engine and a mock in tests
+	class BlockSource
+	{
+	public:
+		virtual ~BlockSource() = default;
+
+		// VK_NULL_HANDLE when the heap is out of memory
+		virtual VkDeviceMemory allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size) = 0;
+		virtual void freeMemory(VkDeviceMemory memory) = 0;
+		// Maps the whole allocation, only called for host visible memory types
+		virtual void* mapMemory(VkDeviceMemory memory) = 0;
+	};
+
+	struct Stats
+	{
+		uint32_t blockCount = 0;
+		uint32_t dedicatedCount = 0;
+		uint32_t allocationCount = 0;
+		// device memory allocated for blocks and dedicated allocations
+		VkDeviceSize allocatedBytes = 0;
+		// bytes resources asked for
+		VkDeviceSize usedBytes = 0;
+		// granularity and atom padding behind resources, alignment gaps in front of them are free bytes
+		VkDeviceSize wastedBytes = 0;
+		VkDeviceSize freeBytes = 0;
+		VkDeviceSize largestFreeRange = 0;
+		uint32_t freeRangeCount = 0;
+
+		// 0 when all free block memory is one range, towards 1 the more it is split into small ranges
+		float getFragmentation() const { return freeBytes > 0 ? 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes) : 0.0f; }
+	};
+
+	MemoryAllocator(BlockSource& source, const VkPhysicalDeviceMemoryProperties& memoryProperties, VkDeviceSize bufferImageGranularity,
+		VkDeviceSize nonCoherentAtomSize, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+	~MemoryAllocator();
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	// Memory of a type allowed by requirements with all of properties. linear is true for buffers and linearly tiled images.
+	// Throws when no memory type matches or the heap is out of memory.
+	MemoryAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear);
+	void free(const MemoryAllocation& allocation);
+
+	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+	VkDeviceSize getNonCoherentAtomSize() const { return m_nonCoherentAtomSize; }
+	Stats getStats() const;
+
+private:
+	struct Block
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		void* pMapped = nullptr;
+		std::unique_ptr<TlsfAllocator> pAllocator;	// nullptr for dedicated allocations and unused slots
+		VkDeviceSize size = 0;
+		bool dedicated = false;
+	};
+
+	struct MemoryType
+	{
+		std::vector<Block> blocks;	// slots are reused, an allocation refers to its block by index
+		VkDeviceSize blockSize = 0;
+		VkDeviceSize usedBytes = 0;
+		VkDeviceSize wastedBytes = 0;
+		uint32_t allocationCount = 0;
+	};
+
+	uint32_t createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated);
+	void destroyBlock(uint32_t memoryTypeIndex, uint32_t block);
+
+	BlockSource& m_source;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkDeviceSize m_bufferImageGranularity;
+	VkDeviceSize m_nonCoherentAtomSize;
+
+	mutable std::mutex m_mutex;
+	std::vector<MemoryType> m_memoryTypes;
+};
+
+}
@@ -0,0 +1,185 @@
+#include "meshCache.h"
+
+#include "utils.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace VulkanEngine
+{
+
+static_assert(sizeof(MeshCache::Header) % alignof(Model::Vertex) == 0, "Vertex data following the header must stay aligned");
+
+static int64_t getSourceTime(const std::string& sourcePath)
+{
+	return static_cast<int64_t>(std::filesystem::last_write_time(sourcePath).time_since_epoch().count());
+}
+
+static uint64_t getSourceHash(const std::string& sourcePath)
+{
+	MappedFile source{ sourcePath };
+	return hashBytes(source.getData(), source.getSize());
+}
+
+enum CookFlags : uint32_t
+{
+	COOK_SPLIT_16BIT_INDICES = 1u << 0,
+	COOK_MESHLETS = 1u << 1,
+	COOK_LODS = 1u << 2,
+};
+
+MeshCache::MeshCache(const std::string& cachePath) : m_file{ cachePath }
+{
+	if(m_file.getSize() >= sizeof(Header))
+	{
+		m_header = reinterpret_cast<const Header*>(m_file.getData());
+	}
+}
+
+std::string MeshCache::getCachePath(const std::string& sourcePath, const Model::LoadConfig& config)
+{
+	std::string cachePath = sourcePath;
+	uint32_t cookFlags = getCookFlags(config);
+	if(cookFlags & COOK_SPLIT_16BIT_INDICES)
+	{
+		cachePath += ".split";
+	}
+	if(cookFlags & COOK_MESHLETS)
+	{
+		cachePath += ".meshlets";
+	}
+	if(cookFlags & COOK_LODS)
+	{
+		cachePath += ".lods";
+	}
+	return cachePath + ".meshcache";
+}
+
+uint32_t MeshCache::getCookFlags(const Model::LoadConfig& config)
+{
+	return (config.splitFor16BitIndices ? COOK_SPLIT_16BIT_INDICES : 0) | (config.buildMeshlets ? COOK_MESHLETS : 0) | (config.generateLods ? COOK_LODS : 0);
+}
+
+bool MeshCache::isValid(const std::string& sourcePath, const Model::LoadConfig& config) const
+{
+	if(m_header == nullptr || m_header->magic != MAGIC || m_header->version != VERSION)
+	{
+		return false;
+	}
+
+	if(m_header->indexSize != sizeof(uint16_t) && m_header->indexSize != sizeof(uint32_t))
+	{
+		return false;
+	}
+
+	size_t expectedSize = sizeof(Header) + sizeof(Model::Vertex) * m_header->vertexCount + getIndexDataSize(m_header->indexCount, m_header->indexSize)
+		+ sizeof(Model::Submesh) * m_header->submeshCount + sizeof(Meshlet) * m_header->meshletCount + sizeof(Model::Lod) * m_header->lodCount;
+	if(m_file.getSize() != expectedSize)
+	{
+		return false;
+	}
+
+	// extra meshlets or levels of detail would change how the model draws, so a superset does not match either
+	if(m_header->cookFlags != getCookFlags(config))
+	{
+		return false;
+	}
+
+	if(m_header->sourceSize != std::filesystem::file_size(sourcePath))
+	{
+		return false;
+	}
+
+	// a touched but unmodified source still matches by content
+	return m_header->sourceTime == getSourceTime(sourcePath) || m_header->sourceHash == getSourceHash(sourcePath);
+}
+
+std::unique_ptr<MeshCache> MeshCache::open(const std::string& sourcePath, const Model::LoadConfig& config)
+{
+	std::error_code error;
+	if(!std::filesystem::exists(getCachePath(sourcePath, config), error))
+	{
+		return nullptr;
+	}
+
+	auto pCache = std::make_unique<MeshCache>(getCachePath(sourcePath, config));
+	if(!pCache->isValid(sourcePath, config))
+	{
+		return nullptr;
+	}
+
+	return pCache;
+}
+
+Model::MeshData MeshCache::getMeshData() const
+{
+	const uint8_t* pData = m_file.getData() + sizeof(Header);
+
+	Model::MeshData meshData{};
+	meshData.vertices = reinterpret_cast<const Model::Vertex*>(pData);
+	meshData.vertexCount = m_header->vertexCount;
+	pData += sizeof(Model::Vertex) * m_header->vertexCount;
+
+	meshData.indices = pData;
+	meshData.indexCount = m_header->indexCount;
+	meshData.indexType = m_header->indexSize == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	pData += getIndexDataSize(m_header->indexCount, m_header->indexSize);
+
+	meshData.submeshes = reinterpret_cast<const Model::Submesh*>(pData);
+	meshData.submeshCount = m_header->submeshCount;
+	pData += sizeof(Model::Submesh) * m_header->submeshCount;
+
+	meshData.meshlets = reinterpret_cast<const Meshlet*>(pData);
+	meshData.meshletCount = m_header->meshletCount;
+	pData += sizeof(Meshlet) * m_header->meshletCount;
+
+	meshData.lods = reinterpret_cast<const Model::Lod*>(pData);
+	meshData.lodCount = m_header->lodCount;
+
+	meshData.boundingBox = m_header->boundingBox;
+	meshData.boundingSphere = m_header->boundingSphere;
+
+	return meshData;
+}
+
+void MeshCache::write(const std::string& sourcePath, const Model::LoadConfig& config, const Model::Mesh& mesh)
+{
+	Header header{};
+	header.magic = MAGIC;
+	header.version = VERSION;
+	header.sourceSize = std::filesystem::file_size(sourcePath);
+	header.sourceTime = getSourceTime(sourcePath);
+	header.sourceHash = getSourceHash(sourcePath);
+
+	std::vector<uint16_t> indexStorage;
+	Model::MeshData meshData = mesh.getMeshData(indexStorage);
+	header.vertexCount = meshData.vertexCount;
+	header.indexCount = meshData.indexCount;
+	header.indexSize = meshData.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+	header.submeshCount = meshData.submeshCount;
+	header.meshletCount = meshData.meshletCount;
+	header.lodCount = meshData.lodCount;
+	header.cookFlags = getCookFlags(config);
+	header.boundingBox = meshData.boundingBox;
+	header.boundingSphere = meshData.boundingSphere;
+
+	// the cache is only an accelerator, a read-only asset directory just means no cache
+	std::ofstream file{ getCachePath(sourcePath, config), std::ios::binary | std::ios::trunc };
+	if(!file.is_open())
+	{
+		return;
+	}
+
+	const uint32_t padding = 0;
+	size_t indexBytes = header.indexCount * header.indexSize;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(meshData.vertices), sizeof(Model::Vertex) * meshData.vertexCount);
+	file.write(reinterpret_cast<const char*>(meshData.indices), indexBytes);
+	file.write(reinterpret_cast<const char*>(&padding), getIndexDataSize(header.indexCount, header.indexSize) - indexBytes);
+	file.write(reinterpret_cast<const char*>(meshData.submeshes), sizeof(Model::Submesh) * meshData.submeshCount);
+	file.write(reinterpret_cast<const char*>(meshData.meshlets), sizeof(Meshlet) * meshData.meshletCount);
+	file.write(reinterpret_cast<const char*>(meshData.lods), sizeof(Model::Lod) * meshData.lodCount);
+}
+
+}
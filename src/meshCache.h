@@ -0,0 +1,68 @@
+#pragma once
+
+#include "model.h"
+#include "mappedFile.h"
+
+#include <memory>
+#include <string>
+
+namespace VulkanEngine
+{
+
+// Cooked binary form of a Model::Mesh: header, de-duplicated vertices, indices in their upload type
+// padded to 4 bytes, submeshes, meshlets, levels of detail.
+// The file is memory-mapped so its contents can be copied straight to staging memory.
+class MeshCache
+{
+public:
+	static constexpr uint32_t MAGIC = 0x4853454d;	// "MESH"
+	static constexpr uint32_t VERSION = 7;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint64_t sourceHash;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t indexSize;
+		uint32_t submeshCount;
+		uint32_t meshletCount;
+		uint32_t lodCount;
+		uint32_t cookFlags;	// the LoadConfig steps the mesh was cooked with, see getCookFlags
+		BoundingBox boundingBox;
+		BoundingSphere boundingSphere;
+	};
+
+	MeshCache(const std::string& cachePath);
+
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	// Returns nullptr when there is no cache for the source file and config, or it is out of date.
+	// A cache only matches the exact split, meshlets and levels of detail it was cooked with, never a superset.
+	static std::unique_ptr<MeshCache> open(const std::string& sourcePath, const Model::LoadConfig& config);
+	// mesh has to be cooked with the steps config asks for
+	static void write(const std::string& sourcePath, const Model::LoadConfig& config, const Model::Mesh& mesh);
+
+	// Each config cooks to a file of its own, so loading one source with two configs does not rewrite one file
+	// back and forth, e.g. "model.obj.meshlets.lods.meshcache"
+	static std::string getCachePath(const std::string& sourcePath, const Model::LoadConfig& config);
+
+	// Points into the mapped file, valid for the lifetime of the cache
+	Model::MeshData getMeshData() const;
+
+private:
+	static size_t getIndexDataSize(uint32_t indexCount, uint32_t indexSize) { return (indexCount * indexSize + 3) & ~size_t(3); }
+
+	static uint32_t getCookFlags(const Model::LoadConfig& config);
+
+	bool isValid(const std::string& sourcePath, const Model::LoadConfig& config) const;
+
+	MappedFile m_file;
+	const Header* m_header = nullptr;
+};
+
+}
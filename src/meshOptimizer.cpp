@@ -0,0 +1,384 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace VulkanEngine
+{
+
+// a cluster is cut once its own miss ratio gets this close to the miss ratio of the whole patch
+static constexpr float SOFT_BOUNDARY_THRESHOLD = 1.05f;
+
+// FIFO cache step for one triangle, returns the number of misses
+static uint32_t updateCache(const uint32_t* triangle, uint32_t cacheSize, std::vector<uint32_t>& cacheTimes, uint32_t& timestamp)
+{
+	uint32_t misses = 0;
+	for(int k = 0; k < 3; k++)
+	{
+		uint32_t v = triangle[k];
+		if(timestamp - cacheTimes[v] > cacheSize)
+		{
+			cacheTimes[v] = timestamp++;
+			misses++;
+		}
+	}
+	return misses;
+}
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStats stats{};
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount == 0)
+	{
+		return stats;
+	}
+
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t timestamp = cacheSize + 1;
+
+	size_t misses = 0;
+	size_t referencedCount = 0;
+	for(size_t t = 0; t < triangleCount; t++)
+	{
+		misses += updateCache(indices + 3 * t, cacheSize, cacheTimes, timestamp);
+		for(int k = 0; k < 3; k++)
+		{
+			if(!referenced[indices[3 * t + k]])
+			{
+				referenced[indices[3 * t + k]] = true;
+				referencedCount++;
+			}
+		}
+	}
+
+	stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+	stats.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+	return stats;
+}
+
+static std::vector<uint32_t> findClusters(const uint32_t* indices, size_t triangleCount, size_t vertexCount, uint32_t cacheSize)
+{
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+
+	// a triangle missing on all of its vertices starts a patch disjoint from what came before
+	std::vector<uint32_t> hardBoundaries;
+	std::vector<uint32_t> patchMisses;
+	for(size_t t = 0; t < triangleCount; t++)
+	{
+		uint32_t misses = updateCache(indices + 3 * t, cacheSize, cacheTimes, timestamp);
+		if(t == 0 || misses == 3)
+		{
+			hardBoundaries.push_back(static_cast<uint32_t>(t));
+			patchMisses.push_back(0);
+		}
+		patchMisses.back() += misses;
+	}
+	hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+	// split patches further wherever restarting costs little compared to the patch as a whole
+	std::vector<uint32_t> clusters;
+	for(size_t p = 0; p + 1 < hardBoundaries.size(); p++)
+	{
+		uint32_t begin = hardBoundaries[p];
+		uint32_t end = hardBoundaries[p + 1];
+		float threshold = SOFT_BOUNDARY_THRESHOLD * static_cast<float>(patchMisses[p]) / static_cast<float>(end - begin);
+
+		timestamp += cacheSize + 1;
+		uint32_t clusterBegin = begin;
+		uint32_t clusterMisses = 0;
+		for(uint32_t t = begin; t < end; t++)
+		{
+			clusterMisses += updateCache(indices + 3 * t, cacheSize, cacheTimes, timestamp);
+			if(static_cast<float>(clusterMisses) <= threshold * static_cast<float>(t + 1 - clusterBegin))
+			{
+				clusters.push_back(clusterBegin);
+				clusterBegin = t + 1;
+				clusterMisses = 0;
+				timestamp += cacheSize + 1;
+			}
+		}
+
+		// the tail is too expensive to stand alone, append it to the previous cluster of the patch
+		if(clusterBegin == begin)
+		{
+			clusters.push_back(begin);
+		}
+	}
+
+	return clusters;
+}
+
+std::vector<uint32_t> optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount == 0)
+	{
+		return {};
+	}
+
+	// vertex to triangle adjacency
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for(size_t i = 0; i < triangleCount * 3; i++)
+	{
+		offsets[indices[i] + 1]++;
+	}
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		offsets[v + 1] += offsets[v];
+	}
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> liveCounts(vertexCount);
+	{
+		std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+		for(size_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency[cursors[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+		for(size_t v = 0; v < vertexCount; v++)
+		{
+			liveCounts[v] = offsets[v + 1] - offsets[v];
+		}
+	}
+
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	deadEnds.reserve(triangleCount * 3);
+	output.reserve(triangleCount * 3);
+
+	uint32_t timestamp = cacheSize + 1;
+	size_t scanCursor = 0;
+
+	// continue from recently used vertices, or any vertex that still has triangles left
+	auto skipDeadEnd = [&]() -> int64_t
+	{
+		while(!deadEnds.empty())
+		{
+			uint32_t v = deadEnds.back();
+			deadEnds.pop_back();
+			if(liveCounts[v] > 0)
+			{
+				return v;
+			}
+		}
+		for(; scanCursor < vertexCount; scanCursor++)
+		{
+			if(liveCounts[scanCursor] > 0)
+			{
+				return static_cast<int64_t>(scanCursor);
+			}
+		}
+		return -1;
+	};
+
+	int64_t fanning = skipDeadEnd();
+	while(fanning >= 0)
+	{
+		candidates.clear();
+
+		for(uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; a++)
+		{
+			uint32_t t = adjacency[a];
+			if(emitted[t])
+			{
+				continue;
+			}
+
+			for(int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[3 * t + k];
+				output.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveCounts[v]--;
+				if(timestamp - cacheTimes[v] > cacheSize)
+				{
+					cacheTimes[v] = timestamp++;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		// prefer the candidate that stays in the cache longest while its remaining triangles are emitted
+		int64_t next = -1;
+		int64_t bestPriority = -1;
+		for(uint32_t v : candidates)
+		{
+			if(liveCounts[v] == 0)
+			{
+				continue;
+			}
+
+			int64_t priority = 0;
+			if(timestamp - cacheTimes[v] + 2 * liveCounts[v] <= cacheSize)
+			{
+				priority = timestamp - cacheTimes[v];
+			}
+
+			if(priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		fanning = next >= 0 ? next : skipDeadEnd();
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+
+	return findClusters(indices, triangleCount, vertexCount, cacheSize);
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<uint32_t>& clusters, const float* positions, size_t positionStride)
+{
+	size_t triangleCount = indexCount / 3;
+	if(clusters.size() < 2)
+	{
+		return;
+	}
+
+	auto position = [&](uint32_t v)
+	{
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionStride);
+	};
+
+	struct Cluster
+	{
+		uint32_t begin;
+		uint32_t end;
+		float centroid[3];
+		float normal[3];
+		float area;
+		float sortKey;
+	};
+
+	std::vector<Cluster> sorted(clusters.size());
+	float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+
+	for(size_t c = 0; c < clusters.size(); c++)
+	{
+		Cluster& cluster = sorted[c];
+		cluster = {};
+		cluster.begin = clusters[c];
+		cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : static_cast<uint32_t>(triangleCount);
+
+		for(uint32_t t = cluster.begin; t < cluster.end; t++)
+		{
+			const float* p0 = position(indices[3 * t + 0]);
+			const float* p1 = position(indices[3 * t + 1]);
+			const float* p2 = position(indices[3 * t + 2]);
+
+			float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+			float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for(int k = 0; k < 3; k++)
+			{
+				cluster.centroid[k] += (p0[k] + p1[k] + p2[k]) / 3.0f * area;
+				cluster.normal[k] += n[k];
+			}
+			cluster.area += area;
+		}
+
+		for(int k = 0; k < 3; k++)
+		{
+			meshCentroid[k] += cluster.centroid[k];
+		}
+		meshArea += cluster.area;
+
+		float inverseArea = cluster.area > 0.0f ? 1.0f / cluster.area : 0.0f;
+		for(int k = 0; k < 3; k++)
+		{
+			cluster.centroid[k] *= inverseArea;
+		}
+	}
+
+	float inverseMeshArea = meshArea > 0.0f ? 1.0f / meshArea : 0.0f;
+	for(int k = 0; k < 3; k++)
+	{
+		meshCentroid[k] *= inverseMeshArea;
+	}
+
+	// clusters facing away from the mesh center occlude the rest, so draw them first
+	for(Cluster& cluster : sorted)
+	{
+		float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+		float inverseLength = length > 0.0f ? 1.0f / length : 0.0f;
+
+		cluster.sortKey = 0.0f;
+		for(int k = 0; k < 3; k++)
+		{
+			cluster.sortKey += (cluster.centroid[k] - meshCentroid[k]) * cluster.normal[k] * inverseLength;
+		}
+	}
+
+	std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	for(const Cluster& cluster : sorted)
+	{
+		output.insert(output.end(), indices + 3 * cluster.begin, indices + 3 * cluster.end);
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+std::vector<uint32_t> optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t& usedVertexCount)
+{
+	std::vector<uint32_t> remap(vertexCount, ~0u);
+	uint32_t next = 0;
+
+	for(size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t& target = remap[indices[i]];
+		if(target == ~0u)
+		{
+			target = next++;
+		}
+		indices[i] = target;
+	}
+
+	usedVertexCount = next;
+	return remap;
+}
+
+std::vector<uint32_t> weldPositions(const float* positions, size_t positionStride, size_t vertexCount, uint32_t& positionCount)
+{
+	std::vector<uint32_t> order(vertexCount);
+	for(uint32_t v = 0; v < vertexCount; v++)
+	{
+		order[v] = v;
+	}
+
+	auto compare = [&](uint32_t a, uint32_t b)
+	{
+		return memcmp(reinterpret_cast<const uint8_t*>(positions) + positionStride * a, reinterpret_cast<const uint8_t*>(positions) + positionStride * b, 3 * sizeof(float)) < 0;
+	};
+	std::sort(order.begin(), order.end(), compare);
+
+	std::vector<uint32_t> positionIds(vertexCount);
+	positionCount = 0;
+	for(size_t i = 0; i < vertexCount; i++)
+	{
+		if(i == 0 || compare(order[i - 1], order[i]))
+		{
+			positionCount++;
+		}
+		positionIds[order[i]] = positionCount - 1;
+	}
+
+	return positionIds;
+}
+
+}
\ No newline at end of file
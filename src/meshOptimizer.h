@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU index/vertex reordering for triangle lists, independent of any GPU state
+
+struct VertexCacheStats
+{
+	float acmr = 0.0f;	// average cache miss ratio, transformed vertices per triangle
+	float atvr = 0.0f;	// average transform to vertex ratio, transformed vertices per referenced vertex
+};
+
+// Simulates a FIFO post-transform cache of the given size
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorders triangles for post-transform cache locality (Tipsify).
+// Returns the first triangle of every cluster the order can be cut into without breaking locality.
+std::vector<uint32_t> optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+
+// Reorders the clusters found by optimizeVertexCache so that outward facing ones are drawn first,
+// keeping the triangle order inside each cluster. Positions are xyz floats spaced by positionStride bytes.
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const std::vector<uint32_t>& clusters, const float* positions, size_t positionStride);
+
+// Returns the new location of every vertex when vertices are laid out in first-use order.
+// Rewrites indices accordingly, unreferenced vertices map to ~0u and are dropped.
+std::vector<uint32_t> optimizeVertexFetch(uint32_t* indices, size_t indexCount, size_t vertexCount, size_t& usedVertexCount);
+
+// Returns an id per vertex that is shared by all vertices with bitwise equal positions, ids are dense from 0
+std::vector<uint32_t> weldPositions(const float* positions, size_t positionStride, size_t vertexCount, uint32_t& positionCount);
+
+}
\ No newline at end of file
@@ -0,0 +1,423 @@
+#include "meshSimplifier.h"
+#include "meshOptimizer.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// open borders are held in place by perpendicular planes this much stronger than the surface planes
+static constexpr float BORDER_WEIGHT = 10.0f;
+
+// share of the cheapest candidate collapses considered per pass, lower keeps the order closer to a full priority queue
+static constexpr size_t PASS_COLLAPSE_DIVISOR = 4;
+
+enum VertexKind : uint8_t
+{
+	VERTEX_KIND_FREE,
+	VERTEX_KIND_BORDER,	// may only slide along its border
+	VERTEX_KIND_LOCKED	// on a non-manifold edge
+};
+
+// Weighted sum of squared distances to a set of planes
+struct Quadric
+{
+	float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f, a01 = 0.0f, a02 = 0.0f, a12 = 0.0f;
+	float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+	float c = 0.0f;
+	float weight = 0.0f;
+};
+
+struct Collapse
+{
+	uint32_t from;
+	uint32_t to;
+	float cost;
+};
+
+static void addPlane(Quadric& quadric, const glm::vec3& normal, float distance, float weight)
+{
+	quadric.a00 += weight * normal.x * normal.x;
+	quadric.a11 += weight * normal.y * normal.y;
+	quadric.a22 += weight * normal.z * normal.z;
+	quadric.a01 += weight * normal.x * normal.y;
+	quadric.a02 += weight * normal.x * normal.z;
+	quadric.a12 += weight * normal.y * normal.z;
+	quadric.b0 += weight * normal.x * distance;
+	quadric.b1 += weight * normal.y * distance;
+	quadric.b2 += weight * normal.z * distance;
+	quadric.c += weight * distance * distance;
+	quadric.weight += weight;
+}
+
+static Quadric addQuadrics(const Quadric& a, const Quadric& b)
+{
+	Quadric result;
+	result.a00 = a.a00 + b.a00;
+	result.a11 = a.a11 + b.a11;
+	result.a22 = a.a22 + b.a22;
+	result.a01 = a.a01 + b.a01;
+	result.a02 = a.a02 + b.a02;
+	result.a12 = a.a12 + b.a12;
+	result.b0 = a.b0 + b.b0;
+	result.b1 = a.b1 + b.b1;
+	result.b2 = a.b2 + b.b2;
+	result.c = a.c + b.c;
+	result.weight = a.weight + b.weight;
+	return result;
+}
+
+static float evaluateQuadric(const Quadric& quadric, const glm::vec3& p)
+{
+	float rx = quadric.a00 * p.x + quadric.a01 * p.y + quadric.a02 * p.z;
+	float ry = quadric.a01 * p.x + quadric.a11 * p.y + quadric.a12 * p.z;
+	float rz = quadric.a02 * p.x + quadric.a12 * p.y + quadric.a22 * p.z;
+	float result = rx * p.x + ry * p.y + rz * p.z + 2.0f * (quadric.b0 * p.x + quadric.b1 * p.y + quadric.b2 * p.z) + quadric.c;
+	// rounding can push the sum of squares slightly negative
+	return std::max(result, 0.0f);
+}
+
+static uint64_t getEdgeKey(uint32_t a, uint32_t b)
+{
+	return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+}
+
+static float getAttributeDistance(const float* attributes, size_t vertexStride, uint32_t attributeCount, uint32_t a, uint32_t b)
+{
+	const float* attributesA = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(attributes) + vertexStride * a);
+	const float* attributesB = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(attributes) + vertexStride * b);
+	float distance = 0.0f;
+	for(uint32_t i = 0; i < attributeCount; i++)
+	{
+		distance += (attributesA[i] - attributesB[i]) * (attributesA[i] - attributesB[i]);
+	}
+	return distance;
+}
+
+size_t simplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexStride, size_t vertexCount,
+	size_t targetIndexCount, float& error, const float* attributes, uint32_t attributeCount)
+{
+	error = 0.0f;
+
+	// positions are normalized to the unit cube so the quadric sums stay well conditioned in float
+	std::vector<glm::vec3> points(vertexCount);
+	glm::vec3 minPosition{ std::numeric_limits<float>::max() };
+	glm::vec3 maxPosition{ -std::numeric_limits<float>::max() };
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + vertexStride * v);
+		points[v] = glm::vec3(position[0], position[1], position[2]);
+		minPosition = glm::min(minPosition, points[v]);
+		maxPosition = glm::max(maxPosition, points[v]);
+	}
+	glm::vec3 size = maxPosition - minPosition;
+	float extent = std::max(size.x, std::max(size.y, size.z));
+	float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+	for(glm::vec3& point : points)
+	{
+		point = (point - minPosition) * scale;
+	}
+
+	// vertices split only by attributes share a position id and collapse as one
+	uint32_t positionCount = 0;
+	std::vector<uint32_t> positionIds = weldPositions(positions, vertexStride, vertexCount, positionCount);
+
+	std::vector<uint32_t> wedgeOffsets(positionCount + 1, 0);
+	for(size_t v = 0; v < vertexCount; v++)
+	{
+		wedgeOffsets[positionIds[v] + 1]++;
+	}
+	for(uint32_t p = 0; p < positionCount; p++)
+	{
+		wedgeOffsets[p + 1] += wedgeOffsets[p];
+	}
+	std::vector<uint32_t> wedges(vertexCount);
+	std::vector<uint32_t> wedgeFill(wedgeOffsets.begin(), wedgeOffsets.end() - 1);
+	std::vector<glm::vec3> positionPoints(positionCount);
+	for(uint32_t v = 0; v < vertexCount; v++)
+	{
+		wedges[wedgeFill[positionIds[v]]++] = v;
+		positionPoints[positionIds[v]] = points[v];
+	}
+
+	std::vector<uint32_t> triangles;
+	triangles.reserve(indexCount);
+	for(size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		uint32_t p0 = positionIds[indices[i + 0]];
+		uint32_t p1 = positionIds[indices[i + 1]];
+		uint32_t p2 = positionIds[indices[i + 2]];
+		if(p0 != p1 && p1 != p2 && p0 != p2)
+		{
+			triangles.insert(triangles.end(), indices + i, indices + i + 3);
+		}
+	}
+
+	std::vector<uint64_t> edgeKeys;
+	auto gatherEdges = [&]()
+	{
+		edgeKeys.clear();
+		for(size_t i = 0; i < triangles.size(); i += 3)
+		{
+			for(int k = 0; k < 3; k++)
+			{
+				edgeKeys.push_back(getEdgeKey(positionIds[triangles[i + k]], positionIds[triangles[i + (k + 1) % 3]]));
+			}
+		}
+		std::sort(edgeKeys.begin(), edgeKeys.end());
+	};
+	auto getEdgeCount = [&](uint64_t key)
+	{
+		auto range = std::equal_range(edgeKeys.begin(), edgeKeys.end(), key);
+		return static_cast<size_t>(range.second - range.first);
+	};
+
+	// surface planes weighted by area, plus planes through open border edges perpendicular to the surface
+	std::vector<Quadric> quadrics(positionCount);
+	std::vector<uint8_t> kinds(positionCount, VERTEX_KIND_FREE);
+	gatherEdges();
+	for(size_t i = 0; i < triangles.size(); i += 3)
+	{
+		const glm::vec3& p0 = positionPoints[positionIds[triangles[i + 0]]];
+		const glm::vec3& p1 = positionPoints[positionIds[triangles[i + 1]]];
+		const glm::vec3& p2 = positionPoints[positionIds[triangles[i + 2]]];
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		if(length == 0.0f)
+		{
+			continue;
+		}
+		normal /= length;
+
+		for(int k = 0; k < 3; k++)
+		{
+			addPlane(quadrics[positionIds[triangles[i + k]]], normal, -glm::dot(normal, p0), 0.5f * length);
+		}
+
+		for(int k = 0; k < 3; k++)
+		{
+			uint32_t a = positionIds[triangles[i + k]];
+			uint32_t b = positionIds[triangles[i + (k + 1) % 3]];
+			size_t edgeCount = getEdgeCount(getEdgeKey(a, b));
+			if(edgeCount == 1)
+			{
+				glm::vec3 edge = positionPoints[b] - positionPoints[a];
+				glm::vec3 borderNormal = glm::cross(edge, normal);
+				float borderLength = glm::length(borderNormal);
+				if(borderLength > 0.0f)
+				{
+					borderNormal /= borderLength;
+					float weight = BORDER_WEIGHT * glm::dot(edge, edge);
+					addPlane(quadrics[a], borderNormal, -glm::dot(borderNormal, positionPoints[a]), weight);
+					addPlane(quadrics[b], borderNormal, -glm::dot(borderNormal, positionPoints[a]), weight);
+				}
+				kinds[a] = std::max<uint8_t>(kinds[a], VERTEX_KIND_BORDER);
+				kinds[b] = std::max<uint8_t>(kinds[b], VERTEX_KIND_BORDER);
+			}
+			else if(edgeCount > 2)
+			{
+				kinds[a] = VERTEX_KIND_LOCKED;
+				kinds[b] = VERTEX_KIND_LOCKED;
+			}
+		}
+	}
+
+	std::vector<uint32_t> remap(vertexCount);
+	for(uint32_t v = 0; v < vertexCount; v++)
+	{
+		remap[v] = v;
+	}
+
+	std::vector<uint32_t> triangleOffsets(positionCount + 1);
+	std::vector<uint32_t> positionTriangles;
+	std::vector<uint8_t> touched(positionCount);
+	std::vector<Collapse> collapses;
+	float maxErrorSquared = 0.0f;
+
+	size_t targetTriangleCount = targetIndexCount / 3;
+	while(triangles.size() / 3 > targetTriangleCount)
+	{
+		// one candidate per edge in its cheaper allowed direction
+		collapses.clear();
+		for(size_t i = 0; i < edgeKeys.size();)
+		{
+			size_t count = 1;
+			while(i + count < edgeKeys.size() && edgeKeys[i + count] == edgeKeys[i])
+			{
+				count++;
+			}
+
+			uint32_t a = static_cast<uint32_t>(edgeKeys[i] >> 32);
+			uint32_t b = static_cast<uint32_t>(edgeKeys[i] & 0xffffffff);
+			i += count;
+
+			bool border = count == 1;
+			bool allowAB = kinds[a] == VERTEX_KIND_FREE || (kinds[a] == VERTEX_KIND_BORDER && border);
+			bool allowBA = kinds[b] == VERTEX_KIND_FREE || (kinds[b] == VERTEX_KIND_BORDER && border);
+			if(!allowAB && !allowBA)
+			{
+				continue;
+			}
+
+			Quadric merged = addQuadrics(quadrics[a], quadrics[b]);
+			float costAB = allowAB ? evaluateQuadric(merged, positionPoints[b]) : std::numeric_limits<float>::max();
+			float costBA = allowBA ? evaluateQuadric(merged, positionPoints[a]) : std::numeric_limits<float>::max();
+			collapses.push_back(costAB <= costBA ? Collapse{ a, b, costAB } : Collapse{ b, a, costBA });
+		}
+
+		if(collapses.empty())
+		{
+			break;
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+		for(uint32_t v : triangles)
+		{
+			triangleOffsets[positionIds[v] + 1]++;
+		}
+		for(uint32_t p = 0; p < positionCount; p++)
+		{
+			triangleOffsets[p + 1] += triangleOffsets[p];
+		}
+		positionTriangles.resize(triangles.size());
+		std::vector<uint32_t> triangleFill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for(size_t i = 0; i < triangles.size(); i++)
+		{
+			positionTriangles[triangleFill[positionIds[triangles[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::fill(touched.begin(), touched.end(), 0);
+		size_t triangleCount = triangles.size() / 3;
+		size_t collapseCount = 0;
+		size_t candidateCount = std::max<size_t>(1, collapses.size() / PASS_COLLAPSE_DIVISOR);
+
+		for(size_t c = 0; c < candidateCount && triangleCount > targetTriangleCount; c++)
+		{
+			const Collapse& collapse = collapses[c];
+			if(touched[collapse.from] || touched[collapse.to])
+			{
+				continue;
+			}
+
+			// reject collapses that flip a surviving triangle
+			bool flipped = false;
+			size_t removedCount = 0;
+			for(uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && !flipped; t++)
+			{
+				uint32_t triangle = positionTriangles[t];
+				uint32_t corners[3];
+				bool containsTarget = false;
+				int fromCorner = 0;
+				for(int k = 0; k < 3; k++)
+				{
+					corners[k] = positionIds[remap[triangles[3 * triangle + k]]];
+					containsTarget |= corners[k] == collapse.to;
+					fromCorner = corners[k] == collapse.from ? k : fromCorner;
+				}
+
+				if(containsTarget)
+				{
+					removedCount++;
+					continue;
+				}
+
+				const glm::vec3& p1 = positionPoints[corners[(fromCorner + 1) % 3]];
+				const glm::vec3& p2 = positionPoints[corners[(fromCorner + 2) % 3]];
+				glm::vec3 before = glm::cross(p1 - positionPoints[collapse.from], p2 - positionPoints[collapse.from]);
+				glm::vec3 after = glm::cross(p1 - positionPoints[collapse.to], p2 - positionPoints[collapse.to]);
+				flipped = glm::dot(before, after) <= 0.0f;
+			}
+
+			if(flipped)
+			{
+				continue;
+			}
+
+			// every wedge follows the triangles it shares with the target, or else takes the closest target wedge
+			for(uint32_t w = wedgeOffsets[collapse.from]; w < wedgeOffsets[collapse.from + 1]; w++)
+			{
+				uint32_t wedge = wedges[w];
+				uint32_t target = ~0u;
+				for(uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && target == ~0u; t++)
+				{
+					const uint32_t* triangle = &triangles[3 * positionTriangles[t]];
+					if(triangle[0] != wedge && triangle[1] != wedge && triangle[2] != wedge)
+					{
+						continue;
+					}
+					for(int k = 0; k < 3; k++)
+					{
+						if(positionIds[remap[triangle[k]]] == collapse.to)
+						{
+							target = remap[triangle[k]];
+						}
+					}
+				}
+
+				if(target == ~0u)
+				{
+					target = wedges[wedgeOffsets[collapse.to]];
+					float bestDistance = std::numeric_limits<float>::max();
+					for(uint32_t candidate = wedgeOffsets[collapse.to]; attributes != nullptr && candidate < wedgeOffsets[collapse.to + 1]; candidate++)
+					{
+						float distance = getAttributeDistance(attributes, vertexStride, attributeCount, wedge, wedges[candidate]);
+						if(distance < bestDistance)
+						{
+							target = wedges[candidate];
+							bestDistance = distance;
+						}
+					}
+				}
+
+				remap[wedge] = target;
+			}
+
+			quadrics[collapse.to] = addQuadrics(quadrics[collapse.to], quadrics[collapse.from]);
+			maxErrorSquared = std::max(maxErrorSquared, collapse.cost / std::max(quadrics[collapse.to].weight, std::numeric_limits<float>::min()));
+
+			touched[collapse.from] = 1;
+			touched[collapse.to] = 1;
+			triangleCount -= removedCount;
+			collapseCount++;
+		}
+
+		if(collapseCount == 0)
+		{
+			break;
+		}
+
+		size_t writeIndex = 0;
+		for(size_t i = 0; i < triangles.size(); i += 3)
+		{
+			uint32_t v0 = remap[triangles[i + 0]];
+			uint32_t v1 = remap[triangles[i + 1]];
+			uint32_t v2 = remap[triangles[i + 2]];
+			uint32_t p0 = positionIds[v0];
+			uint32_t p1 = positionIds[v1];
+			uint32_t p2 = positionIds[v2];
+			if(p0 != p1 && p1 != p2 && p0 != p2)
+			{
+				triangles[writeIndex++] = v0;
+				triangles[writeIndex++] = v1;
+				triangles[writeIndex++] = v2;
+			}
+		}
+		triangles.resize(writeIndex);
+		gatherEdges();
+	}
+
+	std::copy(triangles.begin(), triangles.end(), destination);
+	error = std::sqrt(maxErrorSquared) / scale;
+	return triangles.size();
+}
+
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace VulkanEngine
+{
+
+// Pure CPU quadric error simplification for triangle lists, independent of any GPU state
+
+// Collapses edges in order of quadric error (Garland-Heckbert) until at most targetIndexCount indices remain
+// or no collapse keeps the surface intact. Vertices are only ever merged into existing ones, so the result
+// indexes the same vertex buffer. Open borders are preserved, vertices split by normal or UV seams move
+// together and take over the attributes of the closest wedge at the target.
+// Positions and the optional floats compared for that are spaced by vertexStride bytes.
+// Writes the result to destination, which may alias indices, and returns its index count.
+// error receives the largest estimated distance between the result and the input surface, in model units.
+size_t simplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexStride, size_t vertexCount,
+	size_t targetIndexCount, float& error, const float* attributes = nullptr, uint32_t attributeCount = 0);
+
+}
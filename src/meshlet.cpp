@@ -0,0 +1,346 @@
+#include "meshlet.h"
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace VulkanEngine
+{
+
+// how much a candidate triangle is penalized for bending the meshlet normal cone, relative to one new vertex
+static constexpr float CONE_WEIGHT = 0.5f;
+
+static glm::vec3 getPosition(const float* positions, size_t positionStride, uint32_t vertex)
+{
+	const float* position = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+	return glm::vec3(position[0], position[1], position[2]);
+}
+
+static void computeMeshletBounds(Meshlet& meshlet, const uint32_t* indices, const std::vector<glm::vec3>& normals, const uint32_t* triangles, size_t triangleCount,
+	const float* positions, size_t positionStride)
+{
+	glm::vec3 minPosition{ std::numeric_limits<float>::max() };
+	glm::vec3 maxPosition{ -std::numeric_limits<float>::max() };
+	glm::vec3 normalSum{ 0.0f };
+	for(size_t i = 0; i < triangleCount; i++)
+	{
+		for(int k = 0; k < 3; k++)
+		{
+			glm::vec3 position = getPosition(positions, positionStride, indices[3 * triangles[i] + k]);
+			minPosition = glm::min(minPosition, position);
+			maxPosition = glm::max(maxPosition, position);
+		}
+		normalSum += normals[triangles[i]];
+	}
+
+	meshlet.center = (minPosition + maxPosition) * 0.5f;
+	meshlet.radius = 0.0f;
+	for(size_t i = 0; i < triangleCount; i++)
+	{
+		for(int k = 0; k < 3; k++)
+		{
+			meshlet.radius = std::max(meshlet.radius, glm::length(getPosition(positions, positionStride, indices[3 * triangles[i] + k]) - meshlet.center));
+		}
+	}
+
+	// disabled unless every triangle normal lies within 90 degrees of the average
+	meshlet.coneApex = meshlet.center;
+	meshlet.coneAxis = glm::vec3{ 0.0f, 0.0f, 1.0f };
+	meshlet.coneCutoff = 2.0f;
+
+	float normalLength = glm::length(normalSum);
+	if(normalLength < 1e-6f)
+	{
+		return;
+	}
+
+	glm::vec3 axis = normalSum / normalLength;
+	float minDot = 1.0f;
+	for(size_t i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& normal = normals[triangles[i]];
+		if(normal != glm::vec3{ 0.0f })
+		{
+			minDot = std::min(minDot, glm::dot(normal, axis));
+		}
+	}
+
+	if(minDot <= 0.0f)
+	{
+		return;
+	}
+
+	// the apex is pushed back along the axis until it lies behind every triangle plane
+	float maxDistance = 0.0f;
+	for(size_t i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& normal = normals[triangles[i]];
+		if(normal != glm::vec3{ 0.0f })
+		{
+			glm::vec3 p0 = getPosition(positions, positionStride, indices[3 * triangles[i]]);
+			maxDistance = std::max(maxDistance, glm::dot(meshlet.center - p0, normal) / glm::dot(axis, normal));
+		}
+	}
+
+	meshlet.coneApex = meshlet.center - axis * maxDistance;
+	meshlet.coneAxis = axis;
+	// the normal cone widened by 90 degrees on each side and inverted, cos(angle + 90) negated is sin(angle)
+	meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+std::vector<Meshlet> buildMeshlets(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+	bool clockwiseFrontFace, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	std::vector<Meshlet> meshlets;
+	size_t triangleCount = indexCount / 3;
+	if(triangleCount == 0)
+	{
+		return meshlets;
+	}
+
+	std::vector<glm::vec3> normals(triangleCount);
+	for(size_t t = 0; t < triangleCount; t++)
+	{
+		glm::vec3 p0 = getPosition(positions, positionStride, indices[3 * t + 0]);
+		glm::vec3 p1 = getPosition(positions, positionStride, indices[3 * t + 1]);
+		glm::vec3 p2 = getPosition(positions, positionStride, indices[3 * t + 2]);
+		glm::vec3 normal = clockwiseFrontFace ? glm::cross(p2 - p0, p1 - p0) : glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		normals[t] = length > 0.0f ? normal / length : glm::vec3{ 0.0f };
+	}
+
+	// triangles around every welded position, so meshlets can grow across normal and UV seams
+	uint32_t positionCount = 0;
+	std::vector<uint32_t> positionIds = weldPositions(positions, positionStride, vertexCount, positionCount);
+	std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+	for(size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacencyOffsets[positionIds[indices[i]] + 1]++;
+	}
+	for(uint32_t p = 0; p < positionCount; p++)
+	{
+		adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+	}
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for(size_t i = 0; i < triangleCount * 3; i++)
+	{
+		adjacency[adjacencyFill[positionIds[indices[i]]]++] = static_cast<uint32_t>(i / 3);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> vertexStamps(vertexCount, ~0u);	// meshlet a vertex was last added to
+	std::vector<uint32_t> positionStamps(positionCount, ~0u);	// meshlet that already queued the triangles around a position
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> meshletTriangles;
+	std::vector<uint32_t> reordered;
+	reordered.reserve(triangleCount * 3);
+
+	size_t emittedCount = 0;
+	size_t nextSeed = 0;
+	while(emittedCount < triangleCount)
+	{
+		uint32_t stamp = static_cast<uint32_t>(meshlets.size());
+		uint32_t meshletVertexCount = 0;
+		glm::vec3 normalSum{ 0.0f };
+		candidates.clear();
+		meshletTriangles.clear();
+
+		auto countNewVertices = [&](uint32_t triangle)
+		{
+			const uint32_t* corners = &indices[3 * triangle];
+			uint32_t count = 0;
+			for(int k = 0; k < 3; k++)
+			{
+				bool repeated = (k > 0 && corners[k] == corners[0]) || (k > 1 && corners[k] == corners[1]);
+				if(vertexStamps[corners[k]] != stamp && !repeated)
+				{
+					count++;
+				}
+			}
+			return count;
+		};
+
+		auto addTriangle = [&](uint32_t triangle)
+		{
+			emitted[triangle] = true;
+			emittedCount++;
+			meshletTriangles.push_back(triangle);
+			normalSum += normals[triangle];
+
+			for(int k = 0; k < 3; k++)
+			{
+				uint32_t v = indices[3 * triangle + k];
+				if(vertexStamps[v] != stamp)
+				{
+					vertexStamps[v] = stamp;
+					meshletVertexCount++;
+				}
+
+				uint32_t p = positionIds[v];
+				if(positionStamps[p] != stamp)
+				{
+					positionStamps[p] = stamp;
+					for(uint32_t a = adjacencyOffsets[p]; a < adjacencyOffsets[p + 1]; a++)
+					{
+						if(!emitted[adjacency[a]])
+						{
+							candidates.push_back(adjacency[a]);
+						}
+					}
+				}
+			}
+		};
+
+		// seeds follow the incoming order, which is already spatially coherent after cache optimization
+		while(emitted[nextSeed])
+		{
+			nextSeed++;
+		}
+		addTriangle(static_cast<uint32_t>(nextSeed));
+
+		while(meshletTriangles.size() < maxTriangles)
+		{
+			float normalLength = glm::length(normalSum);
+			glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3{ 0.0f };
+
+			uint32_t best = ~0u;
+			float bestScore = std::numeric_limits<float>::max();
+			size_t kept = 0;
+			for(size_t c = 0; c < candidates.size(); c++)
+			{
+				uint32_t triangle = candidates[c];
+				if(emitted[triangle])
+				{
+					continue;
+				}
+				candidates[kept++] = triangle;
+
+				uint32_t newVertices = countNewVertices(triangle);
+				if(meshletVertexCount + newVertices > maxVertices)
+				{
+					continue;
+				}
+
+				float score = static_cast<float>(newVertices) + CONE_WEIGHT * (1.0f - glm::dot(normals[triangle], axis));
+				if(score < bestScore)
+				{
+					best = triangle;
+					bestScore = score;
+				}
+			}
+			candidates.resize(kept);
+
+			if(best == ~0u)
+			{
+				break;
+			}
+			addTriangle(best);
+		}
+
+		// keep the incoming order inside the meshlet for vertex cache locality
+		std::sort(meshletTriangles.begin(), meshletTriangles.end());
+
+		Meshlet meshlet{};
+		meshlet.firstIndex = static_cast<uint32_t>(reordered.size());
+		meshlet.indexCount = static_cast<uint32_t>(meshletTriangles.size() * 3);
+		meshlet.vertexOffset = 0;
+		meshlet.vertexCount = meshletVertexCount;
+		computeMeshletBounds(meshlet, indices, normals, meshletTriangles.data(), meshletTriangles.size(), positions, positionStride);
+		meshlets.push_back(meshlet);
+
+		for(uint32_t triangle : meshletTriangles)
+		{
+			reordered.insert(reordered.end(), indices + 3 * triangle, indices + 3 * triangle + 3);
+		}
+	}
+
+	std::copy(reordered.begin(), reordered.end(), indices);
+	return meshlets;
+}
+
+static glm::vec4 getRow(const glm::mat4& matrix, int row)
+{
+	return glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+}
+
+MeshletCullParams::MeshletCullParams(const glm::mat4& projectionView, const glm::mat4& model, const glm::vec3& worldCameraPosition)
+{
+	// planes of the clip volume -w <= x <= w, -w <= y <= w, 0 <= z <= w pulled back into model space
+	glm::mat4 clip = projectionView * model;
+	glm::vec4 rowX = getRow(clip, 0);
+	glm::vec4 rowY = getRow(clip, 1);
+	glm::vec4 rowZ = getRow(clip, 2);
+	glm::vec4 rowW = getRow(clip, 3);
+
+	frustumPlanes[0] = rowW + rowX;
+	frustumPlanes[1] = rowW - rowX;
+	frustumPlanes[2] = rowW + rowY;
+	frustumPlanes[3] = rowW - rowY;
+	frustumPlanes[4] = rowZ;
+	frustumPlanes[5] = rowW - rowZ;
+
+	for(glm::vec4& plane : frustumPlanes)
+	{
+		plane = plane / glm::length(glm::vec3(plane));
+	}
+
+	cameraPosition = glm::vec3(glm::inverse(model) * glm::vec4(worldCameraPosition, 1.0f));
+}
+
+MeshletCullStats& MeshletCullStats::operator+=(const MeshletCullStats& other)
+{
+	meshletCount += other.meshletCount;
+	visibleMeshletCount += other.visibleMeshletCount;
+	triangleCount += other.triangleCount;
+	visibleTriangleCount += other.visibleTriangleCount;
+	return *this;
+}
+
+bool isMeshletVisible(const Meshlet& meshlet, const MeshletCullParams& params)
+{
+	for(const glm::vec4& plane : params.frustumPlanes)
+	{
+		if(glm::dot(glm::vec3(plane), meshlet.center) + plane.w < -meshlet.radius)
+		{
+			return false;
+		}
+	}
+
+	if(params.cullBackfaces && meshlet.coneCutoff <= 1.0f)
+	{
+		glm::vec3 toApex = meshlet.coneApex - params.cameraPosition;
+		float distance = glm::length(toApex);
+		if(distance > 0.0f && glm::dot(toApex, meshlet.coneAxis) >= meshlet.coneCutoff * distance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+MeshletCullStats cullMeshlets(const Meshlet* meshlets, size_t meshletCount, const MeshletCullParams& params, std::vector<uint32_t>& visibleMeshlets)
+{
+	MeshletCullStats stats{};
+	stats.meshletCount = static_cast<uint32_t>(meshletCount);
+
+	for(size_t i = 0; i < meshletCount; i++)
+	{
+		uint32_t triangleCount = meshlets[i].indexCount / 3;
+		stats.triangleCount += triangleCount;
+
+		if(isMeshletVisible(meshlets[i], params))
+		{
+			visibleMeshlets.push_back(static_cast<uint32_t>(i));
+			stats.visibleMeshletCount++;
+			stats.visibleTriangleCount += triangleCount;
+		}
+	}
+
+	return stats;
+}
+
+}
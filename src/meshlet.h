@@ -0,0 +1,72 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU meshlet building and culling for triangle lists, independent of any GPU state
+
+// Contiguous range of the index buffer with bounds for culling
+struct Meshlet
+{
+	glm::vec3 center;
+	float radius;
+
+	// all triangles face away from any camera inside the cone with this apex around -coneAxis,
+	// coneCutoff is the sine of the widest triangle normal deviation, values above 1 disable the test
+	glm::vec3 coneApex;
+	float coneCutoff;
+	glm::vec3 coneAxis;
+
+	uint32_t firstIndex;
+	uint32_t indexCount;
+	int32_t vertexOffset;
+	uint32_t vertexCount;
+};
+
+static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+// Groups triangles into meshlets by growing each one over adjacent triangles with similar normals,
+// then reorders the triangles so every meshlet is a contiguous range. The triangle order inside a meshlet
+// is kept, so vertex cache optimization done beforehand mostly survives.
+// Positions are xyz floats spaced by positionStride bytes, the winding of front faces decides which side cones cull.
+std::vector<Meshlet> buildMeshlets(uint32_t* indices, size_t indexCount, const float* positions, size_t positionStride, size_t vertexCount,
+	bool clockwiseFrontFace = false, uint32_t maxVertices = MAX_MESHLET_VERTICES, uint32_t maxTriangles = MAX_MESHLET_TRIANGLES);
+
+// Camera state expressed in the model space of the meshlets being culled
+struct MeshletCullParams
+{
+	glm::vec4 frustumPlanes[6];	// xyz points inside, normalized
+	glm::vec3 cameraPosition;
+	bool cullBackfaces = false;
+
+	// Planes of a perspective projection with depth in [0, 1], as used by Camera
+	MeshletCullParams(const glm::mat4& projectionView, const glm::mat4& model, const glm::vec3& worldCameraPosition);
+};
+
+struct MeshletCullStats
+{
+	uint32_t meshletCount = 0;
+	uint32_t visibleMeshletCount = 0;
+	uint64_t triangleCount = 0;
+	uint64_t visibleTriangleCount = 0;
+
+	float getCulledTriangleRatio() const { return triangleCount > 0 ? 1.0f - static_cast<float>(visibleTriangleCount) / triangleCount : 0.0f; }
+
+	MeshletCullStats& operator+=(const MeshletCullStats& other);
+};
+
+bool isMeshletVisible(const Meshlet& meshlet, const MeshletCullParams& params);
+
+// Appends the indices of the meshlets that survive frustum and backface culling
+MeshletCullStats cullMeshlets(const Meshlet* meshlets, size_t meshletCount, const MeshletCullParams& params, std::vector<uint32_t>& visibleMeshlets);
+
+}
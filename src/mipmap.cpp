@@ -0,0 +1,168 @@
+#include "mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPMAP_USE_SSE
+#endif
+
+namespace VulkanEngine
+{
+
+// linear values are quantized this finely before encoding, fine enough to keep the error under one step
+static constexpr uint32_t SRGB_ENCODE_TABLE_SIZE = 16384;
+
+struct SrgbTables
+{
+	float decode[256];
+	uint8_t encode[SRGB_ENCODE_TABLE_SIZE];
+
+	SrgbTables()
+	{
+		for(uint32_t i = 0; i < 256; i++)
+		{
+			float value = i / 255.0f;
+			decode[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		for(uint32_t i = 0; i < SRGB_ENCODE_TABLE_SIZE; i++)
+		{
+			float value = static_cast<float>(i) / (SRGB_ENCODE_TABLE_SIZE - 1);
+			float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			encode[i] = static_cast<uint8_t>(std::min(encoded, 1.0f) * 255.0f + 0.5f);
+		}
+	}
+};
+
+static const SrgbTables& getSrgbTables()
+{
+	static const SrgbTables tables;
+	return tables;
+}
+
+uint32_t getMipLevelCount(uint32_t width, uint32_t height)
+{
+	uint32_t levelCount = 1;
+	for(uint32_t size = std::max(width, height); size > 1; size /= 2)
+	{
+		levelCount++;
+	}
+	return levelCount;
+}
+
+static void downsampleRowUnorm(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t dstWidth, uint8_t* dst)
+{
+	uint32_t x = 0;
+#ifdef MIPMAP_USE_SSE
+	// two destination texels out of four source columns per step
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+	for(; x + 2 <= width / 2; x += 2)
+	{
+		__m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+		__m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+		// texels 0 and 1 of both rows, then texels 2 and 3
+		__m128i left = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+		__m128i right = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+		__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+		sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(sum, sum));
+	}
+#endif
+	for(; x < dstWidth; x++)
+	{
+		uint32_t x0 = 2 * x * 4;
+		uint32_t x1 = std::min(2 * x + 1, width - 1) * 4;
+		for(uint32_t c = 0; c < 4; c++)
+		{
+			dst[x * 4 + c] = static_cast<uint8_t>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+		}
+	}
+}
+
+static void downsampleRowSrgb(const uint8_t* row0, const uint8_t* row1, uint32_t width, uint32_t dstWidth, uint8_t* dst)
+{
+	const SrgbTables& tables = getSrgbTables();
+	const float encodeScale = static_cast<float>(SRGB_ENCODE_TABLE_SIZE - 1) * 0.25f;
+
+	for(uint32_t x = 0; x < dstWidth; x++)
+	{
+		const uint8_t* texels[4] =
+		{
+			row0 + 2 * x * 4, row0 + std::min(2 * x + 1, width - 1) * 4,
+			row1 + 2 * x * 4, row1 + std::min(2 * x + 1, width - 1) * 4
+		};
+
+		float sum[4];
+#ifdef MIPMAP_USE_SSE
+		__m128 total = _mm_setzero_ps();
+		for(const uint8_t* texel : texels)
+		{
+			total = _mm_add_ps(total, _mm_setr_ps(tables.decode[texel[0]], tables.decode[texel[1]], tables.decode[texel[2]], texel[3]));
+		}
+		_mm_storeu_ps(sum, total);
+#else
+		sum[0] = sum[1] = sum[2] = sum[3] = 0.0f;
+		for(const uint8_t* texel : texels)
+		{
+			sum[0] += tables.decode[texel[0]];
+			sum[1] += tables.decode[texel[1]];
+			sum[2] += tables.decode[texel[2]];
+			sum[3] += texel[3];
+		}
+#endif
+		for(uint32_t c = 0; c < 3; c++)
+		{
+			uint32_t index = std::min(static_cast<uint32_t>(sum[c] * encodeScale + 0.5f), SRGB_ENCODE_TABLE_SIZE - 1);
+			dst[x * 4 + c] = tables.encode[index];
+		}
+		dst[x * 4 + 3] = static_cast<uint8_t>((static_cast<uint32_t>(sum[3]) + 2) >> 2);
+	}
+}
+
+void downsampleRgba8(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst, bool srgb)
+{
+	uint32_t dstWidth = std::max(1u, width / 2);
+	uint32_t dstHeight = std::max(1u, height / 2);
+
+	for(uint32_t y = 0; y < dstHeight; y++)
+	{
+		const uint8_t* row0 = src + static_cast<size_t>(2 * y) * width * 4;
+		const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * y + 1, height - 1)) * width * 4;
+		uint8_t* dstRow = dst + static_cast<size_t>(y) * dstWidth * 4;
+
+		if(srgb)
+		{
+			downsampleRowSrgb(row0, row1, width, dstWidth, dstRow);
+		}
+		else
+		{
+			downsampleRowUnorm(row0, row1, width, dstWidth, dstRow);
+		}
+	}
+}
+
+std::vector<size_t> generateMipChain(std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, bool srgb)
+{
+	uint32_t levelCount = getMipLevelCount(width, height);
+
+	std::vector<size_t> offsets(levelCount + 1);
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t levelSize = static_cast<size_t>(std::max(1u, width >> level)) * std::max(1u, height >> level) * 4;
+		offsets[level + 1] = offsets[level] + levelSize;
+	}
+	pixels.resize(offsets[levelCount]);
+
+	for(uint32_t level = 1; level < levelCount; level++)
+	{
+		downsampleRgba8(pixels.data() + offsets[level - 1], std::max(1u, width >> (level - 1)), std::max(1u, height >> (level - 1)), pixels.data() + offsets[level], srgb);
+	}
+	return offsets;
+}
+
+}
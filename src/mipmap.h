@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU mip generation for RGBA8 images, used when the GPU cannot blit a format with linear filtering
+
+// Levels of a full chain down to 1x1
+uint32_t getMipLevelCount(uint32_t width, uint32_t height);
+
+// Averages 2x2 blocks of src into dst, which is max(1, width / 2) by max(1, height / 2) texels. An odd last row or
+// column is dropped and a side of 1 is read twice. With srgb the color channels are averaged as linear values,
+// alpha never is. Results stay within one step of the exact average.
+void downsampleRgba8(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst, bool srgb);
+
+// Appends every smaller level to pixels, which starts with level 0. Returns the byte offset of each level
+// followed by the total size, so level l spans [offsets[l], offsets[l + 1]).
+std::vector<size_t> generateMipChain(std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, bool srgb);
+
+}
@@ -1,207 +1,812 @@
 #include "model.h"
 
-#include "utils.h"
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
+#include "glbParser.h"
+#include "meshCache.h"
+#include "meshSimplifier.h"
+#include "objParser.h"
+#include "threadPool.h"
+#include "vertexQuantization.h"
+#include "vertexTable.h"
+
+#include <algorithm>
 #include <cstring>
-#include <unordered_map>
+#include <numeric>
+#include <stdexcept>
 
 #ifndef ENGINE_DIR
 #define ENGINE_DIR "../"
 #endif
 
-namespace std
+namespace VulkanEngine
 {
-template<>
-struct hash<VulkanEngine::Model::Vertex>
+
+static Model::Vertex getVertex(const ObjData& obj, const ObjIndex& index)
 {
-	size_t operator()(VulkanEngine::Model::Vertex const& vertex) const
+	Model::Vertex vertex{};
+
+	if(index.position >= 0)
 	{
-		size_t seed = 0;
-		VulkanEngine::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.texcoord);
-		return seed;
+		vertex.position =
+		{
+			obj.positions[3 * index.position + 0],
+			obj.positions[3 * index.position + 1],
+			obj.positions[3 * index.position + 2]
+		};
+
+		vertex.color =
+		{
+			obj.colors[3 * index.position + 0],
+			obj.colors[3 * index.position + 1],
+			obj.colors[3 * index.position + 2]
+		};
 	}
-};
-}
 
-namespace VulkanEngine
-{
+	if(index.normal >= 0)
+	{
+		vertex.normal =
+		{
+			obj.normals[3 * index.normal + 0],
+			obj.normals[3 * index.normal + 1],
+			obj.normals[3 * index.normal + 2]
+		};
+	}
+
+	if(index.texcoord >= 0)
+	{
+		vertex.texcoord =
+		{
+			obj.texcoords[2 * index.texcoord + 0],
+			obj.texcoords[2 * index.texcoord + 1],
+		};
+	}
+
+	return vertex;
+}
 
 void Model::Mesh::load(const std::string& filepath)
 {
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string warn, err;
+	ObjData obj;
+	parseObj(filepath, obj);
+	size_t indexCount = obj.indices.size();
 
-	if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str()))
+	struct Chunk
+	{
+		size_t begin;
+		size_t end;
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;	// into the chunk's own vertices until remapped
+	};
+
+	// chunks are whole triangles and big enough to amortize the merge
+	ThreadPool& threadPool = ThreadPool::get();
+	size_t chunkSize = std::max<size_t>(MIN_LOAD_CHUNK_SIZE, indexCount / (4 * (threadPool.getThreadCount() + 1)));
+	chunkSize -= chunkSize % 3;
+
+	std::vector<Chunk> chunks((indexCount + chunkSize - 1) / chunkSize);
+	for(size_t c = 0; c < chunks.size(); c++)
 	{
-		throw std::runtime_error(warn + err);
+		chunks[c].begin = c * chunkSize;
+		chunks[c].end = std::min(indexCount, (c + 1) * chunkSize);
 	}
 
+	size_t expectedVertexCount = obj.positions.size() / 3;
+	threadPool.parallelFor(static_cast<uint32_t>(chunks.size()), [&](uint32_t c)
+	{
+		Chunk& chunk = chunks[c];
+		chunk.indices.reserve(chunk.end - chunk.begin);
+
+		VertexTable uniqueVertices{ std::min(expectedVertexCount, chunk.end - chunk.begin) };
+
+		for(size_t i = chunk.begin; i < chunk.end; i++)
+		{
+			Vertex vertex = getVertex(obj, obj.indices[i]);
+			chunk.indices.push_back(uniqueVertices.findOrInsert(vertex, chunk.vertices));
+		}
+	});
+
+	// merging chunks in order gives every vertex the index a serial pass over the file would give it
 	vertices.clear();
-	indices.clear();
+	vertices.reserve(expectedVertexCount);
 
-	std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-	for(const auto& shape : shapes)
+	// most meshes have about one unique vertex per position, the table grows past that if needed
+	VertexTable uniqueVertices{ expectedVertexCount };
+	std::vector<std::vector<uint32_t>> remaps(chunks.size());
+	for(size_t c = 0; c < chunks.size(); c++)
 	{
-		for(const auto& index : shape.mesh.indices)
+		remaps[c].reserve(chunks[c].vertices.size());
+		for(const Vertex& vertex : chunks[c].vertices)
 		{
-			Vertex vertex{};
+			remaps[c].push_back(uniqueVertices.findOrInsert(vertex, vertices));
+		}
+	}
 
-			if(index.vertex_index >= 0)
-			{
-				vertex.position =
-				{
-					attrib.vertices[3 * index.vertex_index + 0],
-					attrib.vertices[3 * index.vertex_index + 1],
-					attrib.vertices[3 * index.vertex_index + 2]
-				};
+	indices.resize(indexCount);
+	threadPool.parallelFor(static_cast<uint32_t>(chunks.size()), [&](uint32_t c)
+	{
+		const Chunk& chunk = chunks[c];
+		for(size_t i = chunk.begin; i < chunk.end; i++)
+		{
+			indices[i] = remaps[c][chunk.indices[i - chunk.begin]];
+		}
+	});
 
-				vertex.color =
-				{
-					attrib.colors[3 * index.vertex_index + 0],
-					attrib.colors[3 * index.vertex_index + 1],
-					attrib.colors[3 * index.vertex_index + 2]
-				};
-			}
+	computeBounds();
+}
 
-			if(index.normal_index >= 0)
-			{
-				vertex.normal =
-				{
-					attrib.normals[3 * index.normal_index + 0],
-					attrib.normals[3 * index.normal_index + 1],
-					attrib.normals[3 * index.normal_index + 2]
-				};
-			}
+void Model::Mesh::computeBounds()
+{
+	const float* positions = vertices.empty() ? nullptr : &vertices[0].position.x;
+	boundingBox = computeBoundingBox(positions, sizeof(Vertex), vertices.size());
+	boundingSphere = computeBoundingSphere(positions, sizeof(Vertex), vertices.size(), boundingBox);
+}
 
-			if(index.texcoord_index >= 0)
-			{
-				vertex.texcoord =
-				{
-					attrib.texcoords[2 * index.texcoord_index + 0],
-					attrib.texcoords[2 * index.texcoord_index + 1],
-				};
-			}
+Model::Mesh::OptimizeStats Model::Mesh::optimize()
+{
+	OptimizeStats stats{};
+	stats.before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+	if(indices.empty())
+	{
+		return stats;
+	}
 
+	std::vector<uint32_t> clusters = optimizeVertexCache(indices.data(), indices.size(), vertices.size());
+	optimizeOverdraw(indices.data(), indices.size(), clusters, &vertices[0].position.x, sizeof(Vertex));
 
-			if(uniqueVertices.count(vertex) == 0)
-			{
-				uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-				vertices.push_back(vertex);
-			}
+	size_t usedVertexCount = 0;
+	std::vector<uint32_t> remap = optimizeVertexFetch(indices.data(), indices.size(), vertices.size(), usedVertexCount);
 
-			indices.push_back(uniqueVertices[vertex]);
+	std::vector<Vertex> fetchOrdered(usedVertexCount);
+	for(size_t v = 0; v < vertices.size(); v++)
+	{
+		if(remap[v] != ~0u)
+		{
+			fetchOrdered[remap[v]] = vertices[v];
 		}
 	}
+	vertices.swap(fetchOrdered);
+
+	stats.after = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+	return stats;
 }
 
-std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions()
+static std::vector<VkVertexInputBindingDescription> getStreamBindingDescriptions(uint32_t positionSize, uint32_t vertexSize)
 {
-	std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
-	bindingDescriptions[0].binding = 0;
-	bindingDescriptions[0].stride = sizeof(Vertex);
+	std::vector<VkVertexInputBindingDescription> bindingDescriptions(2);
+	bindingDescriptions[0].binding = Model::POSITION_BINDING;
+	bindingDescriptions[0].stride = positionSize;
 	bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+	bindingDescriptions[1].binding = Model::ATTRIBUTE_BINDING;
+	bindingDescriptions[1].stride = vertexSize - positionSize;
+	bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 	return bindingDescriptions;
 }
 
+std::vector<VkVertexInputBindingDescription> Model::Vertex::getBindingDescriptions()
+{
+	return getStreamBindingDescriptions(sizeof(Vertex::position), sizeof(Vertex));
+}
+
 std::vector<VkVertexInputAttributeDescription> Model::Vertex::getAttributeDescriptions()
 {
 	std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
 
-	attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position) });
-	attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color) });
-	attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal) });
-	attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, texcoord) });
+	// attribute stream offsets are relative to the end of the position
+	const uint32_t attributeStart = sizeof(Vertex::position);
+	attributeDescriptions.push_back({ 0, POSITION_BINDING, VK_FORMAT_R32G32B32_SFLOAT, 0 });
+	attributeDescriptions.push_back({ 1, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color) - attributeStart });
+	attributeDescriptions.push_back({ 2, ATTRIBUTE_BINDING, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal) - attributeStart });
+	attributeDescriptions.push_back({ 3, ATTRIBUTE_BINDING, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, texcoord) - attributeStart });
 
 	return attributeDescriptions;
 }
 
-Model::Model(Device& device, const Mesh& mesh) :m_device(device)
+std::vector<VkVertexInputBindingDescription> Model::CompactVertex::getBindingDescriptions()
 {
-	createVertexBuffers(mesh.vertices);
-	createIndexBuffers(mesh.indices);
+	return getStreamBindingDescriptions(sizeof(CompactVertex::position), sizeof(CompactVertex));
 }
 
-Model::~Model()
+std::vector<VkVertexInputAttributeDescription> Model::CompactVertex::getAttributeDescriptions()
 {
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
 
+	const uint32_t attributeStart = sizeof(CompactVertex::position);
+	attributeDescriptions.push_back({ 0, POSITION_BINDING, VK_FORMAT_R16G16B16A16_SNORM, 0 });
+	attributeDescriptions.push_back({ 1, ATTRIBUTE_BINDING, VK_FORMAT_R8G8B8A8_UNORM, offsetof(CompactVertex, color) - attributeStart });
+	attributeDescriptions.push_back({ 2, ATTRIBUTE_BINDING, VK_FORMAT_R16G16_SNORM, offsetof(CompactVertex, normal) - attributeStart });
+	attributeDescriptions.push_back({ 3, ATTRIBUTE_BINDING, VK_FORMAT_R16G16_SFLOAT, offsetof(CompactVertex, texcoord) - attributeStart });
+
+	return attributeDescriptions;
 }
 
-void Model::createVertexBuffers(const std::vector<Vertex>& vertices)
+GeometryArena::VertexLayout Model::getVertexLayout(VertexFormat format)
 {
-	m_vertexCount = static_cast<uint32_t>(vertices.size());
-	assert(m_vertexCount >= 3 && "Vertex count must be at least 3");
-	VkDeviceSize bufferSize = sizeof(Vertex) * m_vertexCount;
+	GeometryArena::VertexLayout layout{};
+	layout.streamCount = 2;
+	if(format == VertexFormat::Compact)
+	{
+		layout.streamStrides[POSITION_BINDING] = sizeof(CompactVertex::position);
+		layout.streamStrides[ATTRIBUTE_BINDING] = sizeof(CompactVertex) - sizeof(CompactVertex::position);
+	}
+	else
+	{
+		layout.streamStrides[POSITION_BINDING] = sizeof(Vertex::position);
+		layout.streamStrides[ATTRIBUTE_BINDING] = sizeof(Vertex) - sizeof(Vertex::position);
+	}
+	return layout;
+}
 
-	Buffer stagingBuffer{ m_device, sizeof(Vertex), m_vertexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+void Model::Mesh::generateLods()
+{
+	lods.clear();
+	if(indices.empty())
+	{
+		return;
+	}
 
-	stagingBuffer.map();
-	stagingBuffer.writeToBuffer((void*)vertices.data());
+	uint32_t fullIndexCount = static_cast<uint32_t>(indices.size());
+	lods.push_back({ 0, fullIndexCount, 0.0f });
 
-	m_vertexBuffer = std::make_unique<Buffer>(m_device, sizeof(Vertex), m_vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	// every level is simplified from the previous one, so its error bound accumulates
+	std::vector<uint32_t> source(indices.begin(), indices.end());
+	std::vector<uint32_t> simplified(source.size());
+	for(float ratio : LOD_TRIANGLE_RATIOS)
+	{
+		size_t targetIndexCount = static_cast<size_t>(fullIndexCount / 3 * ratio) * 3;
+		float error = 0.0f;
+		size_t indexCount = simplifyMesh(simplified.data(), source.data(), source.size(), &vertices[0].position.x, sizeof(Vertex), vertices.size(),
+			targetIndexCount, error, &vertices[0].color.x, 8);
 
-	m_device.copyBuffer(stagingBuffer.getBuffer(), m_vertexBuffer->getBuffer(), bufferSize);
+		// stop once simplification stalls, a level barely smaller than the previous one only costs memory
+		if(indexCount == 0 || indexCount > source.size() * 9 / 10)
+		{
+			break;
+		}
+
+		optimizeVertexCache(simplified.data(), indexCount, vertices.size());
+
+		lods.push_back({ static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(indexCount), lods.back().error + error });
+		indices.insert(indices.end(), simplified.begin(), simplified.begin() + indexCount);
+		source.assign(simplified.begin(), simplified.begin() + indexCount);
+	}
+
+	if(lods.size() == 1)
+	{
+		lods.clear();
+	}
+}
+
+void Model::Mesh::splitFor16BitIndices()
+{
+	if(vertices.size() <= MAX_16BIT_VERTEX_COUNT || !submeshes.empty())
+	{
+		return;
+	}
+
+	std::vector<Vertex> splitVertices;
+	splitVertices.reserve(vertices.size());
+	std::vector<uint32_t> localIndices(vertices.size());
+	std::vector<uint32_t> owners(vertices.size(), ~0u);	// submesh a vertex was last copied into
+
+	Submesh submesh{ 0, 0, 0 };
+	uint32_t submeshIndex = 0;
+	uint32_t localCount = 0;
+	size_t nextLod = 1;
+
+	for(size_t t = 0; t < indices.size() / 3; t++)
+	{
+		// levels of detail never share a submesh, so each is drawn through its own
+		bool lodStart = nextLod < lods.size() && lods[nextLod].firstIndex == 3 * t;
+		if(lodStart)
+		{
+			nextLod++;
+		}
+
+
+		uint32_t* triangle = &indices[3 * t];
+
+		uint32_t newCount = 0;
+		for(int k = 0; k < 3; k++)
+		{
+			bool repeated = (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+			if(owners[triangle[k]] != submeshIndex && !repeated)
+			{
+				newCount++;
+			}
+		}
+
+		if(localCount + newCount > MAX_16BIT_VERTEX_COUNT || (lodStart && submesh.indexCount > 0))
+		{
+			submeshes.push_back(submesh);
+			submesh = { static_cast<uint32_t>(3 * t), 0, static_cast<int32_t>(splitVertices.size()) };
+			submeshIndex++;
+			localCount = 0;
+		}
+
+		for(int k = 0; k < 3; k++)
+		{
+			uint32_t v = triangle[k];
+			if(owners[v] != submeshIndex)
+			{
+				owners[v] = submeshIndex;
+				localIndices[v] = localCount++;
+				splitVertices.push_back(vertices[v]);
+			}
+			triangle[k] = localIndices[v];
+		}
+		submesh.indexCount += 3;
+	}
+
+	submeshes.push_back(submesh);
+	vertices.swap(splitVertices);
+}
+
+void Model::remapTexcoords(Vertex* vertices, size_t vertexCount, const AtlasRegion& region)
+{
+	for(size_t i = 0; i < vertexCount; i++)
+	{
+		vertices[i].texcoord = region.remap(vertices[i].texcoord);
+	}
 }
 
-void Model::createIndexBuffers(const std::vector<uint32_t>& indices)
+void Model::Mesh::buildMeshlets()
 {
-	m_indexCount = static_cast<uint32_t>(indices.size());
-	m_hasIndexBuffer = m_indexCount > 0;
+	meshlets.clear();
+
+	auto buildRange = [this](uint32_t firstIndex, uint32_t indexCount, int32_t vertexOffset, size_t vertexCount)
+	{
+		// Pipeline rasterizes with VK_FRONT_FACE_CLOCKWISE
+		std::vector<Meshlet> rangeMeshlets = VulkanEngine::buildMeshlets(&indices[firstIndex], indexCount, &vertices[vertexOffset].position.x, sizeof(Vertex), vertexCount, true);
+		for(Meshlet& meshlet : rangeMeshlets)
+		{
+			meshlet.firstIndex += firstIndex;
+			meshlet.vertexOffset = vertexOffset;
+		}
+		meshlets.insert(meshlets.end(), rangeMeshlets.begin(), rangeMeshlets.end());
+	};
 
-	if(!m_hasIndexBuffer)
+	uint32_t fullIndexCount = lods.empty() ? static_cast<uint32_t>(indices.size()) : lods[0].indexCount;
+	if(submeshes.empty())
 	{
+		buildRange(0, fullIndexCount, 0, vertices.size());
 		return;
 	}
 
-	assert(m_indexCount >= 3 && "Index count must be at least 3");
-	VkDeviceSize bufferSize = sizeof(uint32_t) * m_indexCount;
+	for(size_t i = 0; i < submeshes.size() && submeshes[i].firstIndex < fullIndexCount; i++)
+	{
+		size_t vertexEnd = i + 1 < submeshes.size() ? submeshes[i + 1].vertexOffset : vertices.size();
+		buildRange(submeshes[i].firstIndex, submeshes[i].indexCount, submeshes[i].vertexOffset, vertexEnd - submeshes[i].vertexOffset);
+	}
+}
+
+Model::MeshData Model::Mesh::getMeshData(std::vector<uint16_t>& storage) const
+{
+	MeshData meshData{};
+	meshData.vertices = vertices.data();
+	meshData.vertexCount = static_cast<uint32_t>(vertices.size());
+	meshData.indexCount = static_cast<uint32_t>(indices.size());
+	meshData.indexType = getIndexType();
+	meshData.submeshes = submeshes.data();
+	meshData.submeshCount = static_cast<uint32_t>(submeshes.size());
+	meshData.meshlets = meshlets.data();
+	meshData.meshletCount = static_cast<uint32_t>(meshlets.size());
+	meshData.lods = lods.data();
+	meshData.lodCount = static_cast<uint32_t>(lods.size());
+	meshData.boundingBox = boundingBox;
+	meshData.boundingSphere = boundingSphere;
+
+	if(meshData.indexType == VK_INDEX_TYPE_UINT16)
+	{
+		storage.assign(indices.begin(), indices.end());
+		meshData.indices = storage.data();
+	}
+	else
+	{
+		meshData.indices = indices.data();
+	}
+
+	return meshData;
+}
+
+// Deinterleaves vertices made of a position followed by attributes
+static void splitVertexStreams(const void* vertices, uint32_t vertexCount, size_t positionSize, size_t attributeSize, std::vector<uint8_t>& positions, std::vector<uint8_t>& attributes)
+{
+	positions.resize(vertexCount * positionSize);
+	attributes.resize(vertexCount * attributeSize);
+
+	const uint8_t* vertex = static_cast<const uint8_t*>(vertices);
+	for(uint32_t v = 0; v < vertexCount; v++, vertex += positionSize + attributeSize)
+	{
+		std::memcpy(&positions[v * positionSize], vertex, positionSize);
+		std::memcpy(&attributes[v * attributeSize], vertex + positionSize, attributeSize);
+	}
+}
+
+Model::Model(GeometryArena& arena, const Mesh& mesh, VertexFormat format, GeometryArena::StagedUpload* pUpload) :m_arena(arena), m_vertexFormat(format)
+{
+	std::vector<uint16_t> indexStorage;
+	createBuffers(mesh.getMeshData(indexStorage), pUpload);
+}
+
+Model::Model(GeometryArena& arena, const MeshData& meshData, VertexFormat format, GeometryArena::StagedUpload* pUpload) :m_arena(arena), m_vertexFormat(format)
+{
+	createBuffers(meshData, pUpload);
+}
+
+void Model::createBuffers(const MeshData& meshData, GeometryArena::StagedUpload* pUpload)
+{
+	assert(meshData.vertexCount >= 3 && "Vertex count must be at least 3");
+	assert((meshData.indexCount == 0 || meshData.indexCount >= 3) && "Index count must be at least 3");
+
+	GeometryArena::VertexLayout layout = getVertexLayout(m_vertexFormat);
+	m_allocation = m_arena.allocate(layout, meshData.vertexCount, meshData.indexCount, meshData.indexType);
+
+	const void* streams[] = { meshData.positions, meshData.attributes };
+	std::vector<CompactVertex> compactVertices;
+	std::vector<uint8_t> positions;
+	std::vector<uint8_t> attributes;
+	if(meshData.positions)
+	{
+		assert(m_vertexFormat == VertexFormat::Float && meshData.attributes && "Split streams are only uploaded in the float format");
+	}
+	else
+	{
+		const void* vertices = meshData.vertices;
+		if(m_vertexFormat == VertexFormat::Compact)
+		{
+			m_quantizationError = quantizeVertices(meshData.vertices, meshData.vertexCount, compactVertices, m_dequantizeMatrix);
+			vertices = compactVertices.data();
+		}
+
+		splitVertexStreams(vertices, meshData.vertexCount, layout.streamStrides[POSITION_BINDING], layout.streamStrides[ATTRIBUTE_BINDING], positions, attributes);
+		streams[POSITION_BINDING] = positions.data();
+		streams[ATTRIBUTE_BINDING] = attributes.data();
+	}
+
+	if(pUpload)
+	{
+		*pUpload = m_arena.stage(m_allocation, streams, meshData.indices);
+	}
+	else
+	{
+		m_arena.upload(m_allocation, streams, meshData.indices);
+	}
+
+	m_submeshes.assign(meshData.submeshes, meshData.submeshes + meshData.submeshCount);
+	m_meshlets.assign(meshData.meshlets, meshData.meshlets + meshData.meshletCount);
+
+	if(meshData.lodCount > 0)
+	{
+		m_lods.assign(meshData.lods, meshData.lods + meshData.lodCount);
+	}
+	else
+	{
+		m_lods.push_back({ 0, meshData.indexCount, 0.0f });
+	}
 
-	Buffer stagingBuffer{ m_device, sizeof(uint32_t), m_indexCount, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+	m_boundingBox = meshData.boundingBox;
+	m_boundingSphere = meshData.boundingSphere;
+}
 
-	stagingBuffer.map();
-	stagingBuffer.writeToBuffer((void*)indices.data());
+Model::~Model()
+{
+	m_arena.free(m_allocation);
+}
 
-	m_indexBuffer = std::make_unique<Buffer>(m_device, sizeof(uint32_t), m_indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+std::unique_ptr<Model> Model::createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config)
+{
+	return createModelFromFile(arena, filepath, config, nullptr);
+}
 
-	m_device.copyBuffer(stagingBuffer.getBuffer(), m_indexBuffer->getBuffer(), bufferSize);
+std::unique_ptr<Model> Model::createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config, GeometryArena::StagedUpload& upload)
+{
+	return createModelFromFile(arena, filepath, config, &upload);
 }
 
-std::unique_ptr<Model> Model::createModelFromFile(Device& device, const std::string& filepath)
+std::unique_ptr<Model> Model::createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config, GeometryArena::StagedUpload* pUpload)
 {
-	Mesh mesh{};
 	std::string enginePath = ENGINE_DIR + filepath;
-	mesh.load(enginePath);
-	return std::make_unique<Model>(device, mesh);
+	std::unique_ptr<Model> pModel;
+
+	// cooked meshes are mapped and copied to staging memory without any parsing
+	if(std::unique_ptr<MeshCache> pCache = MeshCache::open(enginePath, config))
+	{
+		Model::MeshData meshData = pCache->getMeshData();
+
+		// the mapped vertices are read only, atlas texcoords go into a copy
+		std::vector<Vertex> remappedVertices;
+		if(config.atlasRegion)
+		{
+			remappedVertices.assign(meshData.vertices, meshData.vertices + meshData.vertexCount);
+			remapTexcoords(remappedVertices.data(), remappedVertices.size(), *config.atlasRegion);
+			meshData.vertices = remappedVertices.data();
+		}
+
+		pModel = std::make_unique<Model>(arena, meshData, config.vertexFormat, pUpload);
+	}
+	else
+	{
+		Mesh mesh{};
+		mesh.load(enginePath);
+
+		mesh.optimize();
+
+		if(config.generateLods)
+		{
+			mesh.generateLods();
+		}
+
+		if(config.splitFor16BitIndices)
+		{
+			mesh.splitFor16BitIndices();
+		}
+
+		if(config.buildMeshlets)
+		{
+			mesh.buildMeshlets();
+		}
+
+		MeshCache::write(enginePath, config, mesh);
+
+		if(config.atlasRegion)
+		{
+			mesh.remapTexcoords(*config.atlasRegion);
+		}
+		pModel = std::make_unique<Model>(arena, mesh, config.vertexFormat, pUpload);
+	}
+
+	return pModel;
 }
 
-void Model::bind(VkCommandBuffer commandBuffer)
+// True when the color, normal and texcoord accessors interleave exactly like the attribute stream of Vertex
+static bool isVertexAttributeStream(const GlbFile& file, const GlbPrimitive& primitive)
 {
-	VkBuffer buffers[] = { m_vertexBuffer->getBuffer() };
-	VkDeviceSize offsets[] = { 0 };
-	vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+	if(primitive.color < 0 || primitive.normal < 0 || primitive.texcoord < 0)
+	{
+		return false;
+	}
 
-	if(m_hasIndexBuffer)
+	const GlbAccessor& color = file.getAccessor(primitive.color);
+	const GlbAccessor& normal = file.getAccessor(primitive.normal);
+	const GlbAccessor& texcoord = file.getAccessor(primitive.texcoord);
+	const uint32_t attributeSize = sizeof(Model::Vertex) - sizeof(Model::Vertex::position);
+
+	auto matches = [attributeSize](const GlbAccessor& accessor, uint32_t componentCount)
 	{
-		vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+		return accessor.data && accessor.componentType == GlbAccessor::FLOAT && accessor.componentCount == componentCount && accessor.stride == attributeSize;
+	};
+
+	return matches(color, 3) && matches(normal, 3) && matches(texcoord, 2)
+		&& normal.data == color.data + (offsetof(Model::Vertex, normal) - offsetof(Model::Vertex, color))
+		&& texcoord.data == color.data + (offsetof(Model::Vertex, texcoord) - offsetof(Model::Vertex, color));
+}
+
+template<typename Index>
+static void checkIndices(const Index* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	if(indexCount > 0 && *std::max_element(indices, indices + indexCount) >= vertexCount)
+	{
+		throw std::runtime_error("failed to load glb: index out of range!");
 	}
 }
 
-void Model::draw(VkCommandBuffer commandBuffer)
+std::unique_ptr<Model> Model::createModelFromGlb(GeometryArena& arena, const GlbFile& file, uint32_t meshIndex)
 {
-	if(m_hasIndexBuffer)
+	const std::vector<GlbPrimitive>& primitives = file.getMeshes()[meshIndex].primitives;
+	if(primitives.empty())
+	{
+		throw std::runtime_error("failed to load glb: mesh without primitives!");
+	}
+
+	// primitives are laid out one after another, their indices stay relative to their own vertices
+	std::vector<Submesh> submeshes;
+	uint32_t vertexCount = 0;
+	uint32_t indexCount = 0;
+	uint32_t maxPrimitiveVertexCount = 0;
+	for(const GlbPrimitive& primitive : primitives)
+	{
+		uint32_t primitiveVertexCount = file.getAccessor(primitive.position).count;
+		uint32_t primitiveIndexCount = primitive.indices >= 0 ? file.getAccessor(primitive.indices).count : primitiveVertexCount;
+		submeshes.push_back({ indexCount, primitiveIndexCount, static_cast<int32_t>(vertexCount) });
+		vertexCount += primitiveVertexCount;
+		indexCount += primitiveIndexCount;
+		maxPrimitiveVertexCount = std::max(maxPrimitiveVertexCount, primitiveVertexCount);
+	}
+
+	MeshData meshData{};
+	meshData.vertexCount = vertexCount;
+	const bool single = primitives.size() == 1;
+
+	std::vector<glm::vec3> positions;
+	const GlbAccessor& firstPositions = file.getAccessor(primitives[0].position);
+	if(single && firstPositions.isTight(GlbAccessor::FLOAT, 3))
 	{
-		vkCmdDrawIndexed(commandBuffer, m_indexCount, 1, 0, 0, 0);
+		meshData.positions = reinterpret_cast<const glm::vec3*>(firstPositions.data);
 	}
 	else
 	{
-		vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, 0);
+		positions.resize(vertexCount);
+		for(size_t p = 0; p < primitives.size(); p++)
+		{
+			convertAccessor(file.getAccessor(primitives[p].position), 3, &positions[submeshes[p].vertexOffset].x, sizeof(glm::vec3));
+		}
+		meshData.positions = positions.data();
+	}
+
+	std::vector<uint8_t> attributes;
+	if(single && isVertexAttributeStream(file, primitives[0]))
+	{
+		meshData.attributes = file.getAccessor(primitives[0].color).data;
 	}
+	else
+	{
+		// missing attributes keep the defaults of Vertex, white for colors and zero for the rest
+		const size_t attributeSize = sizeof(Vertex) - sizeof(Vertex::position);
+		const size_t colorOffset = offsetof(Vertex, color) - sizeof(Vertex::position);
+		const size_t normalOffset = offsetof(Vertex, normal) - sizeof(Vertex::position);
+		const size_t texcoordOffset = offsetof(Vertex, texcoord) - sizeof(Vertex::position);
+
+		attributes.resize(vertexCount * attributeSize);
+		for(size_t p = 0; p < primitives.size(); p++)
+		{
+			const GlbPrimitive& primitive = primitives[p];
+			uint8_t* first = &attributes[submeshes[p].vertexOffset * attributeSize];
+			uint32_t primitiveVertexCount = file.getAccessor(primitive.position).count;
+
+			if(primitive.color >= 0)
+			{
+				convertAccessor(file.getAccessor(primitive.color), 3, reinterpret_cast<float*>(first + colorOffset), attributeSize);
+			}
+			else
+			{
+				const glm::vec3 white{ 1.0f, 1.0f, 1.0f };
+				for(uint32_t v = 0; v < primitiveVertexCount; v++)
+				{
+					std::memcpy(first + v * attributeSize + colorOffset, &white, sizeof(white));
+				}
+			}
+
+			if(primitive.normal >= 0)
+			{
+				convertAccessor(file.getAccessor(primitive.normal), 3, reinterpret_cast<float*>(first + normalOffset), attributeSize);
+			}
+			if(primitive.texcoord >= 0)
+			{
+				convertAccessor(file.getAccessor(primitive.texcoord), 2, reinterpret_cast<float*>(first + texcoordOffset), attributeSize);
+			}
+		}
+		meshData.attributes = attributes.data();
+	}
+
+	std::vector<uint16_t> indices16;
+	std::vector<uint32_t> indices32;
+	const GlbAccessor* firstIndices = primitives[0].indices >= 0 ? &file.getAccessor(primitives[0].indices) : nullptr;
+	if(single && !firstIndices)
+	{
+		meshData.indexCount = 0;
+	}
+	else if(single && firstIndices->isTight(GlbAccessor::UNSIGNED_SHORT, 1))
+	{
+		meshData.indices = firstIndices->data;
+		meshData.indexCount = indexCount;
+		meshData.indexType = VK_INDEX_TYPE_UINT16;
+	}
+	else if(single && firstIndices->isTight(GlbAccessor::UNSIGNED_INT, 1))
+	{
+		meshData.indices = firstIndices->data;
+		meshData.indexCount = indexCount;
+		meshData.indexType = VK_INDEX_TYPE_UINT32;
+	}
+	else
+	{
+		// submeshes address their vertices through vertexOffset, so 16 bits suffice while every primitive fits
+		meshData.indexCount = indexCount;
+		meshData.indexType = maxPrimitiveVertexCount <= Mesh::MAX_16BIT_VERTEX_COUNT ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+		auto convert = [&](auto& storage)
+		{
+			storage.resize(indexCount);
+			for(size_t p = 0; p < primitives.size(); p++)
+			{
+				auto* first = &storage[submeshes[p].firstIndex];
+				if(primitives[p].indices >= 0)
+				{
+					convertIndices(file.getAccessor(primitives[p].indices), first);
+				}
+				else
+				{
+					std::iota(first, first + submeshes[p].indexCount, 0);
+				}
+			}
+			meshData.indices = storage.data();
+		};
+
+		if(meshData.indexType == VK_INDEX_TYPE_UINT16)
+		{
+			convert(indices16);
+		}
+		else
+		{
+			convert(indices32);
+		}
+	}
+
+	// indices are the one input a malformed file can make the GPU read out of bounds with
+	for(size_t p = 0; p < primitives.size() && meshData.indexCount > 0; p++)
+	{
+		const Submesh& submesh = single ? Submesh{ 0, indexCount, 0 } : submeshes[p];
+		uint32_t primitiveVertexCount = file.getAccessor(primitives[p].position).count;
+		if(meshData.indexType == VK_INDEX_TYPE_UINT16)
+		{
+			checkIndices(static_cast<const uint16_t*>(meshData.indices) + submesh.firstIndex, submesh.indexCount, primitiveVertexCount);
+		}
+		else
+		{
+			checkIndices(static_cast<const uint32_t*>(meshData.indices) + submesh.firstIndex, submesh.indexCount, primitiveVertexCount);
+		}
+	}
+
+	if(!single)
+	{
+		meshData.submeshes = submeshes.data();
+		meshData.submeshCount = static_cast<uint32_t>(submeshes.size());
+	}
+
+	meshData.boundingBox = computeBoundingBox(&meshData.positions->x, sizeof(glm::vec3), vertexCount);
+	meshData.boundingSphere = computeBoundingSphere(&meshData.positions->x, sizeof(glm::vec3), vertexCount, meshData.boundingBox);
+
+	return std::make_unique<Model>(arena, meshData, VertexFormat::Float);
+}
+
+void Model::draw(VkCommandBuffer commandBuffer, uint32_t lod)
+{
+	if(m_allocation.indexCount == 0)
+	{
+		vkCmdDraw(commandBuffer, m_allocation.vertexCount, 1, m_allocation.baseVertex, 0);
+		return;
+	}
+
+	const Lod& range = m_lods[lod];
+	if(!m_submeshes.empty())
+	{
+		for(const Submesh& submesh : m_submeshes)
+		{
+			if(submesh.firstIndex >= range.firstIndex && submesh.firstIndex < range.firstIndex + range.indexCount)
+			{
+				vkCmdDrawIndexed(commandBuffer, submesh.indexCount, 1, m_allocation.firstIndex + submesh.firstIndex, m_allocation.baseVertex + submesh.vertexOffset, 0);
+			}
+		}
+	}
+	else
+	{
+		vkCmdDrawIndexed(commandBuffer, range.indexCount, 1, m_allocation.firstIndex + range.firstIndex, m_allocation.baseVertex, 0);
+	}
+}
+
+MeshletCullStats Model::draw(VkCommandBuffer commandBuffer, const MeshletCullParams& cullParams)
+{
+	m_visibleMeshlets.clear();
+	MeshletCullStats stats = cullMeshlets(m_meshlets.data(), m_meshlets.size(), cullParams, m_visibleMeshlets);
+
+	for(size_t i = 0; i < m_visibleMeshlets.size();)
+	{
+		const Meshlet& first = m_meshlets[m_visibleMeshlets[i]];
+		uint32_t indexCount = first.indexCount;
+
+		// meshlets are laid out in index order, so runs of visible ones form a single range
+		for(i++; i < m_visibleMeshlets.size(); i++)
+		{
+			const Meshlet& next = m_meshlets[m_visibleMeshlets[i]];
+			if(next.firstIndex != first.firstIndex + indexCount || next.vertexOffset != first.vertexOffset)
+			{
+				break;
+			}
+			indexCount += next.indexCount;
+		}
+
+		vkCmdDrawIndexed(commandBuffer, indexCount, 1, m_allocation.firstIndex + first.firstIndex, m_allocation.baseVertex + first.vertexOffset, 0);
+	}
+
+	return stats;
 }
 
 }
\ No newline at end of file
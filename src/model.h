@@ -1,20 +1,37 @@
 #pragma once
 
-#include "device.h"
-#include "buffer.h"
+#include "geometryArena.h"
+#include "bounds.h"
+#include "meshOptimizer.h"
+#include "meshlet.h"
+#include "textureAtlas.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace VulkanEngine
 {
+
+class GlbFile;
+
+struct QuantizationError
+{
+	float maxPositionError = 0.0f;	// model space distance
+	float maxNormalError = 0.0f;	// degrees
+};
+
 class Model
 {
 public:
+	// Vertices are uploaded as two streams, so passes that only need positions fetch nothing else.
+	// The position stream is the leading position member of a vertex, the attribute stream everything after it.
+	static constexpr uint32_t POSITION_BINDING = 0;
+	static constexpr uint32_t ATTRIBUTE_BINDING = 1;
 
 	struct Vertex
 	{
@@ -32,36 +49,191 @@ public:
 		}
 	};
 
+	// Quantized layout, 20 bytes instead of 44. Positions are snorm relative to the mesh bounds,
+	// normals octahedral snorm, texcoords half float and color 8 bit unorm.
+	struct CompactVertex
+	{
+		int16_t position[4]{};
+		uint8_t color[4]{};
+		int16_t normal[2]{};
+		uint16_t texcoord[2]{};
+
+		static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+		static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+	};
+
+	enum class VertexFormat
+	{
+		Float,
+		Compact
+	};
+
+	struct LoadConfig
+	{
+		VertexFormat vertexFormat = VertexFormat::Float;
+		// split meshes too large for 16 bit indices into submeshes that each fit
+		bool splitFor16BitIndices = false;
+		// draw as meshlets that are culled against the camera before submission
+		bool buildMeshlets = false;
+		// append simplified index ranges for rendering at a distance
+		bool generateLods = false;
+		// move texcoords into the region of a texture atlas page, applied after the mesh cache so it stays shared
+		std::optional<AtlasRegion> atlasRegion;
+	};
+
+	// Range of the index buffer whose indices are relative to vertexOffset
+	struct Submesh
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t vertexOffset;
+	};
+
+	// Index range of one level of detail, drawn through the submeshes inside it when the mesh is split
+	struct Lod
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		float error;	// estimated model space distance to the full detail surface
+	};
+
+	// Non-owning view of mesh data ready for upload, indices already in their final type
+	struct MeshData
+	{
+		const Vertex* vertices = nullptr;
+		uint32_t vertexCount = 0;
+		const void* indices = nullptr;
+		uint32_t indexCount = 0;
+		VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+		const Submesh* submeshes = nullptr;
+		uint32_t submeshCount = 0;
+		const Meshlet* meshlets = nullptr;
+		uint32_t meshletCount = 0;
+		const Lod* lods = nullptr;
+		uint32_t lodCount = 0;
+		BoundingBox boundingBox{};
+		BoundingSphere boundingSphere{};
+		// Float format streams that are already split, uploaded as they are instead of vertices when set
+		const glm::vec3* positions = nullptr;
+		const void* attributes = nullptr;
+	};
+
 	struct Mesh
 	{
+		// index count each import task converts, smaller meshes are converted on the calling thread
+		static constexpr size_t MIN_LOAD_CHUNK_SIZE = 3 * 64 * 1024;
+		static constexpr size_t MAX_16BIT_VERTEX_COUNT = 65536;
+		// share of the full detail triangles kept by each generated level
+		static constexpr float LOD_TRIANGLE_RATIOS[] = { 0.5f, 0.25f, 0.125f };
+
 		std::vector<Vertex> vertices;
 		std::vector<uint32_t> indices;
+		std::vector<Submesh> submeshes;	// empty when indices address vertices directly
+		std::vector<Meshlet> meshlets;	// cover the full detail level only
+		std::vector<Lod> lods;	// empty when the mesh has a single level
+		BoundingBox boundingBox{};
+		BoundingSphere boundingSphere{};
+
+		struct OptimizeStats
+		{
+			VertexCacheStats before;
+			VertexCacheStats after;
+		};
 
+		// Parses an OBJ file with parseObj, de-duplicates its corners into vertices and computes the bounds
 		void load(const std::string& filepath);
+
+		// Fits boundingBox and boundingSphere to the vertices, later steps only drop or duplicate vertices so they stay valid
+		void computeBounds();
+
+		// Reorders triangles for vertex cache locality and overdraw, then vertices for fetch locality.
+		// Returns the simulated vertex cache efficiency before and after, for tools and tests to report.
+		OptimizeStats optimize();
+
+		// Simplifies the mesh into the LOD_TRIANGLE_RATIOS levels, appending their indices after the full
+		// detail ones. All levels share the vertices. Call after optimize().
+		void generateLods();
+
+		// Splits the mesh into submeshes of at most MAX_16BIT_VERTEX_COUNT vertices each,
+		// duplicating vertices shared across a split. Does nothing for meshes that already fit.
+		void splitFor16BitIndices();
+
+		// Maps texcoords into an atlas region, see AtlasRegion::remap
+		void remapTexcoords(const AtlasRegion& region) { Model::remapTexcoords(vertices.data(), vertices.size(), region); }
+
+		// Groups the triangles of every full detail submesh into meshlets, reordering them so each meshlet is
+		// a contiguous index range. Call after generateLods() and splitFor16BitIndices().
+		void buildMeshlets();
+
+		VkIndexType getIndexType() const { return submeshes.empty() && vertices.size() > MAX_16BIT_VERTEX_COUNT ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16; }
+
+		// Returns a view of the mesh, indices are narrowed into storage if they fit in 16 bits
+		MeshData getMeshData(std::vector<uint16_t>& storage) const;
 	};
 
-	Model(Device& device, const Mesh& mesh);
+	// The geometry is placed in arena, which has to outlive the model. Given pUpload, the copies are only staged
+	// into it for the caller to record, and the model must not be drawn before they completed.
+	Model(GeometryArena& arena, const Mesh& mesh, VertexFormat format = VertexFormat::Float, GeometryArena::StagedUpload* pUpload = nullptr);
+	Model(GeometryArena& arena, const MeshData& meshData, VertexFormat format = VertexFormat::Float, GeometryArena::StagedUpload* pUpload = nullptr);
 	~Model();
 
 	Model(const Model&) = delete;
 	Model& operator=(const Model&) = delete;
 
-	static std::unique_ptr<Model> createModelFromFile(Device& device, const std::string& filepath);
+	static std::unique_ptr<Model> createModelFromFile(GeometryArena& arena, const std::string& filepath) { return createModelFromFile(arena, filepath, LoadConfig{}); }
+	static std::unique_ptr<Model> createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config);
+	// Leaves the copies staged in upload, so loading never touches a queue and is safe on worker threads
+	static std::unique_ptr<Model> createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config, GeometryArena::StagedUpload& upload);
+	// Creates the model of one glb mesh, each primitive of it drawn as a submesh. Accessors laid out like the
+	// vertex streams are staged straight from the mapped file, all others are converted first.
+	static std::unique_ptr<Model> createModelFromGlb(GeometryArena& arena, const GlbFile& file, uint32_t mesh);
+
+	static GeometryArena::VertexLayout getVertexLayout(VertexFormat format);
+
+	// Draws expect the arena buffers of getVertexPool(), getIndexPool() and getIndexType() bound
+	void draw(VkCommandBuffer commandBuffer, uint32_t lod = 0);
+	// Draws only the full detail meshlets passing the culling test, adjacent ones are merged into one draw
+	MeshletCullStats draw(VkCommandBuffer commandBuffer, const MeshletCullParams& cullParams);
+
+	uint32_t getVertexPool() const { return m_allocation.vertexPool; }
+	uint32_t getIndexPool() const { return m_allocation.indexPool; }
+	VkIndexType getIndexType() const { return m_allocation.indexType; }
+	bool hasMeshlets() const { return !m_meshlets.empty(); }
 
-	void bind(VkCommandBuffer commandBuffer);
-	void draw(VkCommandBuffer commandBuffer);
+	// Always holds at least the full detail level
+	const std::vector<Lod>& getLods() const { return m_lods; }
+	uint32_t getLodTriangleCount(uint32_t lod) const { return m_lods[lod].indexCount / 3; }
+
+	// Model space bounds, before the dequantize matrix
+	const BoundingBox& getBoundingBox() const { return m_boundingBox; }
+	const BoundingSphere& getBoundingSphere() const { return m_boundingSphere; }
+
+	VertexFormat getVertexFormat() const { return m_vertexFormat; }
+
+	// Maps stored positions to model space, to be applied before the object transform
+	const glm::mat4& getDequantizeMatrix() const { return m_dequantizeMatrix; }
+	const QuantizationError& getQuantizationError() const { return m_quantizationError; }
 
 private:
-	void createVertexBuffers(const std::vector<Vertex>& vertices);
-	void createIndexBuffers(const std::vector<uint32_t>& indices);
+	static std::unique_ptr<Model> createModelFromFile(GeometryArena& arena, const std::string& filepath, const LoadConfig& config, GeometryArena::StagedUpload* pUpload);
+	// shared by loaded meshes and copies of cached vertices
+	static void remapTexcoords(Vertex* vertices, size_t vertexCount, const AtlasRegion& region);
+
+	void createBuffers(const MeshData& meshData, GeometryArena::StagedUpload* pUpload);
+
+	GeometryArena& m_arena;
+	GeometryArena::Allocation m_allocation{};
 
-	Device& m_device;
+	VertexFormat m_vertexFormat;
+	glm::mat4 m_dequantizeMatrix{ 1.0f };
+	QuantizationError m_quantizationError{};
 
-	std::unique_ptr<Buffer> m_vertexBuffer;
-	uint32_t m_vertexCount;
+	std::vector<Submesh> m_submeshes;
+	std::vector<Lod> m_lods;
+	BoundingBox m_boundingBox{};
+	BoundingSphere m_boundingSphere{};
 
-	bool m_hasIndexBuffer = false;
-	std::unique_ptr<Buffer> m_indexBuffer;
-	uint32_t m_indexCount;
+	std::vector<Meshlet> m_meshlets;
+	std::vector<uint32_t> m_visibleMeshlets;
 };
 }
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "modelRegistry.h"
+
+#include "mappedFile.h"
+#include "utils.h"
+
+#include <filesystem>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace VulkanEngine
+{
+
+// Every option that changes the uploaded data has to be part of the key
+static uint64_t getConfigKey(const Model::LoadConfig& config)
+{
+	uint64_t key = static_cast<uint64_t>(config.vertexFormat)
+		| (static_cast<uint64_t>(config.splitFor16BitIndices) << 8)
+		| (static_cast<uint64_t>(config.buildMeshlets) << 9)
+		| (static_cast<uint64_t>(config.generateLods) << 10);
+
+	// the page does not change the texcoords, only offset and scale do
+	if(config.atlasRegion)
+	{
+		const float remap[4] = { config.atlasRegion->offset.x, config.atlasRegion->offset.y, config.atlasRegion->scale.x, config.atlasRegion->scale.y };
+		key = hashBytes(remap, sizeof(remap), key);
+	}
+	return key;
+}
+
+ModelRegistry::ModelRegistry(GeometryArena& geometryArena) : m_geometryArena(geometryArena)
+{
+
+}
+
+std::shared_ptr<Model> ModelRegistry::load(const std::string& filepath, const Model::LoadConfig& config)
+{
+	uint64_t contentKey = getContentKey(filepath, config);
+
+	std::unique_lock<std::mutex> lock{ m_mutex };
+	return findOrLoad(lock, contentKey, filepath, config);
+}
+
+uint64_t ModelRegistry::getContentKey(const std::string& filepath, const Model::LoadConfig& config)
+{
+	std::filesystem::path sourcePath = std::filesystem::weakly_canonical(ENGINE_DIR + filepath);
+	uint64_t configKey = getConfigKey(config);
+	std::string pathKey = std::to_string(configKey) + ":" + sourcePath.generic_string();
+
+	uint64_t sourceSize = std::filesystem::file_size(sourcePath);
+	int64_t sourceTime = static_cast<int64_t>(std::filesystem::last_write_time(sourcePath).time_since_epoch().count());
+
+	std::unique_lock<std::mutex> lock{ m_mutex };
+
+	auto pathIt = m_paths.find(pathKey);
+	if(pathIt != m_paths.end() && pathIt->second.sourceSize == sourceSize && pathIt->second.sourceTime == sourceTime)
+	{
+		return pathIt->second.contentKey;
+	}
+
+	// new or modified file, identical content under another path still shares the model
+	lock.unlock();
+	MappedFile source{ sourcePath.string() };
+	uint64_t contentKey = hashBytes(&configKey, sizeof(configKey), hashBytes(source.getData(), source.getSize()));
+	lock.lock();
+
+	m_paths[pathKey] = { sourceSize, sourceTime, contentKey };
+	return contentKey;
+}
+
+std::shared_ptr<Model> ModelRegistry::find(uint64_t contentKey)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto contentIt = m_contents.find(contentKey);
+	return contentIt != m_contents.end() ? contentIt->second.pModel.lock() : nullptr;
+}
+
+std::shared_ptr<Model> ModelRegistry::insert(uint64_t contentKey, std::shared_ptr<Model> pModel)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	ContentEntry& entry = m_contents[contentKey];
+	if(std::shared_ptr<Model> pExisting = entry.pModel.lock())
+	{
+		return pExisting;
+	}
+
+	entry.pModel = pModel;
+	m_loadCount++;
+	return pModel;
+}
+
+std::shared_ptr<Model> ModelRegistry::findOrLoad(std::unique_lock<std::mutex>& lock, uint64_t contentKey, const std::string& filepath, const Model::LoadConfig& config)
+{
+	ContentEntry& entry = m_contents[contentKey];
+	if(std::shared_ptr<Model> pModel = entry.pModel.lock())
+	{
+		return pModel;
+	}
+
+	if(entry.loading.valid())
+	{
+		std::shared_future<std::shared_ptr<Model>> loading = entry.loading;
+		lock.unlock();
+		return loading.get();
+	}
+
+	std::promise<std::shared_ptr<Model>> promise;
+	entry.loading = promise.get_future().share();
+	lock.unlock();
+
+	std::shared_ptr<Model> pModel;
+	try
+	{
+		pModel = Model::createModelFromFile(m_geometryArena, filepath, config);
+	}
+	catch(...)
+	{
+		promise.set_exception(std::current_exception());
+		lock.lock();
+		m_contents.erase(contentKey);
+		throw;
+	}
+
+	promise.set_value(pModel);
+
+	// map references survive rehashing and entries still loading are never evicted, so entry is still valid
+	lock.lock();
+	entry.pModel = pModel;
+	entry.loading = {};
+	m_loadCount++;
+
+	return pModel;
+}
+
+void ModelRegistry::evictExpired()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	for(auto it = m_contents.begin(); it != m_contents.end();)
+	{
+		it = it->second.pModel.expired() && !it->second.loading.valid() ? m_contents.erase(it) : std::next(it);
+	}
+
+	for(auto it = m_paths.begin(); it != m_paths.end();)
+	{
+		it = m_contents.count(it->second.contentKey) == 0 ? m_paths.erase(it) : std::next(it);
+	}
+}
+
+uint32_t ModelRegistry::getLoadCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_loadCount;
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "model.h"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace VulkanEngine
+{
+
+// Hands out one shared Model per unique source content and load config, however many paths or instances refer to it.
+// Models are only held weakly, so an asset is evicted once the last game object releases it.
+// Lookups are thread-safe and concurrent requests for an asset being loaded wait for that load instead of repeating it.
+// Loading itself flushes the upload batch of the geometry arena, so a miss must happen on a thread allowed to submit to the graphics queue.
+class ModelRegistry
+{
+public:
+	ModelRegistry(GeometryArena& geometryArena);
+
+	ModelRegistry(const ModelRegistry&) = delete;
+	ModelRegistry& operator=(const ModelRegistry&) = delete;
+
+	std::shared_ptr<Model> load(const std::string& filepath, const Model::LoadConfig& config = {});
+
+	// Identifies the content of a file under a load config. Hashes the file when it is new or modified, so keep it off the frame loop.
+	uint64_t getContentKey(const std::string& filepath, const Model::LoadConfig& config);
+	// Model already loaded for a content key, null when there is none
+	std::shared_ptr<Model> find(uint64_t contentKey);
+	// Registers a model loaded outside the registry, returns the model registered first when the content is already loaded
+	std::shared_ptr<Model> insert(uint64_t contentKey, std::shared_ptr<Model> pModel);
+
+	// Forgets entries whose models have been released
+	void evictExpired();
+
+	// Number of models actually parsed and uploaded so far
+	uint32_t getLoadCount() const;
+
+private:
+	// Identifies a file state without reading it, so unchanged files skip hashing
+	struct PathEntry
+	{
+		uint64_t sourceSize;
+		int64_t sourceTime;
+		uint64_t contentKey;
+	};
+
+	struct ContentEntry
+	{
+		std::weak_ptr<Model> pModel;
+		std::shared_future<std::shared_ptr<Model>> loading;	// valid while the first request is loading
+	};
+
+	std::shared_ptr<Model> findOrLoad(std::unique_lock<std::mutex>& lock, uint64_t contentKey, const std::string& filepath, const Model::LoadConfig& config);
+
+	GeometryArena& m_geometryArena;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, PathEntry> m_paths;
+	std::unordered_map<uint64_t, ContentEntry> m_contents;
+	uint32_t m_loadCount = 0;
+};
+
+}
@@ -0,0 +1,485 @@
+#include "objParser.h"
+
+#include "mappedFile.h"
+#include "threadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+// chunks smaller than this parse faster than they are scheduled and stitched
+static constexpr size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+// Everything one chunk of lines contributes, indices are already zero based and absolute
+// except for the relative ones listed in relativeSlots
+struct ObjChunk
+{
+	const char* begin;
+	const char* end;
+
+	std::vector<float> positions;
+	std::vector<float> colors;
+	std::vector<float> normals;
+	std::vector<float> texcoords;
+
+	std::vector<ObjIndex> corners;
+	std::vector<uint32_t> faceSizes;
+	// corner << 2 | component of indices counted from the chunk start, they get the vertex count of earlier chunks added
+	std::vector<uint32_t> relativeSlots;
+	size_t triangleCount = 0;
+
+	bool failed = false;
+
+	// prefix sums over earlier chunks
+	size_t positionBase = 0;
+	size_t normalBase = 0;
+	size_t texcoordBase = 0;
+	size_t triangleBase = 0;
+};
+
+static inline bool isDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static inline bool isLineEnd(const char* cursor, const char* end)
+{
+	return cursor == end || *cursor == '\n' || *cursor == '\r' || *cursor == '#';
+}
+
+static inline const char* skipSpaces(const char* cursor, const char* end)
+{
+	while(cursor < end && (*cursor == ' ' || *cursor == '\t'))
+	{
+		cursor++;
+	}
+	return cursor;
+}
+
+static inline const char* skipLine(const char* cursor, const char* end)
+{
+	while(cursor < end && *cursor != '\n')
+	{
+		cursor++;
+	}
+	return cursor < end ? cursor + 1 : end;
+}
+
+// Decimal mantissa and exponent gathered as integers, then scaled once in double precision.
+// Exact for the up to 19 significant digits real files carry, without locale or stream overhead.
+static bool parseFloat(const char*& cursor, const char* end, float& value)
+{
+	static const double POWERS_OF_10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char* p = skipSpaces(cursor, end);
+
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+
+	for(; p < end && isDigit(*p); p++)
+	{
+		hasDigits = true;
+		if(significantDigits < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			significantDigits += mantissa != 0;
+		}
+		else
+		{
+			exponent++;
+		}
+	}
+
+	if(p < end && *p == '.')
+	{
+		for(p++; p < end && isDigit(*p); p++)
+		{
+			hasDigits = true;
+			if(significantDigits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				significantDigits += mantissa != 0;
+				exponent--;
+			}
+		}
+	}
+
+	if(!hasDigits)
+	{
+		return false;
+	}
+
+	if(p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if(e < end && (*e == '-' || *e == '+'))
+		{
+			negativeExponent = *e == '-';
+			e++;
+		}
+
+		if(e < end && isDigit(*e))
+		{
+			int exponentValue = 0;
+			for(; e < end && isDigit(*e); e++)
+			{
+				exponentValue = std::min(exponentValue * 10 + (*e - '0'), 10000);
+			}
+			exponent += negativeExponent ? -exponentValue : exponentValue;
+			p = e;
+		}
+	}
+
+	double result = static_cast<double>(mantissa);
+	if(exponent < 0)
+	{
+		result = -exponent <= 22 ? result / POWERS_OF_10[-exponent] : result / std::pow(10.0, -exponent);
+	}
+	else if(exponent > 0)
+	{
+		result = exponent <= 22 ? result * POWERS_OF_10[exponent] : result * std::pow(10.0, exponent);
+	}
+
+	value = static_cast<float>(negative ? -result : result);
+	cursor = p;
+	return true;
+}
+
+static bool parseInt(const char*& cursor, const char* end, int64_t& value)
+{
+	const char* p = cursor;
+
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+
+	if(p == end || !isDigit(*p))
+	{
+		return false;
+	}
+
+	int64_t result = 0;
+	for(; p < end && isDigit(*p); p++)
+	{
+		result = std::min<int64_t>(result * 10 + (*p - '0'), INT32_MAX);
+	}
+
+	value = negative ? -result : result;
+	cursor = p;
+	return true;
+}
+
+// Appends count floats, or the defaults for the ones missing on the line
+static void parseFloats(const char*& cursor, const char* end, std::vector<float>& values, int count, float defaultValue)
+{
+	for(int i = 0; i < count; i++)
+	{
+		float value = defaultValue;
+		parseFloat(cursor, end, value);
+		values.push_back(value);
+	}
+}
+
+// OBJ indices are one based, negative ones count back from the last element defined so far
+static bool resolveIndex(int64_t index, size_t chunkCount, ObjChunk& chunk, uint32_t component, int32_t& resolved)
+{
+	if(index > 0)
+	{
+		resolved = static_cast<int32_t>(index - 1);
+		return true;
+	}
+
+	if(index < 0)
+	{
+		resolved = static_cast<int32_t>(static_cast<int64_t>(chunkCount) + index);
+		chunk.relativeSlots.push_back(static_cast<uint32_t>(chunk.corners.size() << 2) | component);
+		return true;
+	}
+
+	return false;
+}
+
+static void parseFace(const char*& cursor, const char* end, ObjChunk& chunk)
+{
+	uint32_t cornerCount = 0;
+
+	for(;;)
+	{
+		cursor = skipSpaces(cursor, end);
+		if(isLineEnd(cursor, end))
+		{
+			break;
+		}
+
+		ObjIndex corner{ -1, -1, -1 };
+		int64_t index = 0;
+
+		if(!parseInt(cursor, end, index) || !resolveIndex(index, chunk.positions.size() / 3, chunk, 0, corner.position))
+		{
+			chunk.failed = true;
+			return;
+		}
+
+		if(cursor < end && *cursor == '/')
+		{
+			cursor++;
+			if(cursor < end && *cursor != '/')
+			{
+				if(!parseInt(cursor, end, index) || !resolveIndex(index, chunk.texcoords.size() / 2, chunk, 2, corner.texcoord))
+				{
+					chunk.failed = true;
+					return;
+				}
+			}
+
+			if(cursor < end && *cursor == '/')
+			{
+				cursor++;
+				if(!parseInt(cursor, end, index) || !resolveIndex(index, chunk.normals.size() / 3, chunk, 1, corner.normal))
+				{
+					chunk.failed = true;
+					return;
+				}
+			}
+		}
+
+		chunk.corners.push_back(corner);
+		cornerCount++;
+	}
+
+	// degenerate faces are dropped, as tinyobj does
+	if(cornerCount < 3)
+	{
+		chunk.corners.resize(chunk.corners.size() - cornerCount);
+		chunk.relativeSlots.erase(std::remove_if(chunk.relativeSlots.begin(), chunk.relativeSlots.end(),
+			[&](uint32_t slot) { return (slot >> 2) >= chunk.corners.size(); }), chunk.relativeSlots.end());
+		return;
+	}
+
+	chunk.faceSizes.push_back(cornerCount);
+	chunk.triangleCount += cornerCount - 2;
+}
+
+static void parseChunk(ObjChunk& chunk)
+{
+	// about one face per vertex in closed meshes, and a few dozen bytes per line
+	size_t expectedLines = (chunk.end - chunk.begin) / 32;
+	chunk.positions.reserve(expectedLines * 3 / 2);
+	chunk.colors.reserve(expectedLines * 3 / 2);
+	chunk.corners.reserve(expectedLines * 3 / 2);
+	chunk.faceSizes.reserve(expectedLines / 2);
+
+	const char* end = chunk.end;
+	for(const char* cursor = chunk.begin; cursor < end && !chunk.failed; cursor = skipLine(cursor, end))
+	{
+		cursor = skipSpaces(cursor, end);
+		if(end - cursor < 2)
+		{
+			continue;
+		}
+
+		bool separated = cursor[1] == ' ' || cursor[1] == '\t';
+		bool separatedAfterTwo = end - cursor > 2 && (cursor[2] == ' ' || cursor[2] == '\t');
+
+		if(cursor[0] == 'v' && separated)
+		{
+			cursor += 2;
+			parseFloats(cursor, end, chunk.positions, 3, 0.0f);
+
+			// colors only count when all three are there, like tinyobj
+			float color[3] = { 1.0f, 1.0f, 1.0f };
+			const char* colorCursor = cursor;
+			if(parseFloat(colorCursor, end, color[0]) && parseFloat(colorCursor, end, color[1]) && parseFloat(colorCursor, end, color[2]))
+			{
+				chunk.colors.insert(chunk.colors.end(), color, color + 3);
+			}
+			else
+			{
+				chunk.colors.insert(chunk.colors.end(), { 1.0f, 1.0f, 1.0f });
+			}
+		}
+		else if(cursor[0] == 'v' && cursor[1] == 'n' && separatedAfterTwo)
+		{
+			cursor += 3;
+			parseFloats(cursor, end, chunk.normals, 3, 0.0f);
+		}
+		else if(cursor[0] == 'v' && cursor[1] == 't' && separatedAfterTwo)
+		{
+			cursor += 3;
+			parseFloats(cursor, end, chunk.texcoords, 2, 0.0f);
+		}
+		else if(cursor[0] == 'f' && separated)
+		{
+			cursor += 2;
+			parseFace(cursor, end, chunk);
+		}
+	}
+}
+
+static float squaredDistance(const std::vector<float>& positions, int32_t a, int32_t b)
+{
+	float dx = positions[3 * b + 0] - positions[3 * a + 0];
+	float dy = positions[3 * b + 1] - positions[3 * a + 1];
+	float dz = positions[3 * b + 2] - positions[3 * a + 2];
+	return dx * dx + dy * dy + dz * dz;
+}
+
+// Writes the chunk's faces as triangles starting at triangleBase
+static bool triangulateChunk(const ObjChunk& chunk, ObjData& data)
+{
+	const size_t positionCount = data.positions.size() / 3;
+	const size_t normalCount = data.normals.size() / 3;
+	const size_t texcoordCount = data.texcoords.size() / 2;
+
+	// relative indices reaching back past the first element failed the chunk when they were resolved
+	if(chunk.failed)
+	{
+		return false;
+	}
+
+	// -1 marks a missing normal or texcoord
+	for(const ObjIndex& corner : chunk.corners)
+	{
+		if(corner.position < 0 || static_cast<size_t>(corner.position) >= positionCount
+			|| corner.normal < -1 || corner.normal >= static_cast<int64_t>(normalCount)
+			|| corner.texcoord < -1 || corner.texcoord >= static_cast<int64_t>(texcoordCount))
+		{
+			return false;
+		}
+	}
+
+	ObjIndex* triangle = &data.indices[3 * chunk.triangleBase];
+	const ObjIndex* face = chunk.corners.data();
+	for(uint32_t faceSize : chunk.faceSizes)
+	{
+		if(faceSize == 4)
+		{
+			// split along the shorter diagonal
+			float diagonal02 = squaredDistance(data.positions, face[0].position, face[2].position);
+			float diagonal13 = squaredDistance(data.positions, face[1].position, face[3].position);
+
+			const int corners[6] = { 0, 1, 2, 0, 2, 3 };
+			const int flippedCorners[6] = { 0, 1, 3, 1, 2, 3 };
+			const int* order = diagonal02 < diagonal13 ? corners : flippedCorners;
+			for(int k = 0; k < 6; k++)
+			{
+				*triangle++ = face[order[k]];
+			}
+		}
+		else
+		{
+			for(uint32_t k = 1; k + 1 < faceSize; k++)
+			{
+				*triangle++ = face[0];
+				*triangle++ = face[k];
+				*triangle++ = face[k + 1];
+			}
+		}
+		face += faceSize;
+	}
+
+	return true;
+}
+
+void parseObj(const char* text, size_t size, ObjData& data)
+{
+	ThreadPool& threadPool = ThreadPool::get();
+
+	// split at line starts, so every chunk parses on its own
+	size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size / MIN_CHUNK_SIZE, 4 * (threadPool.getThreadCount() + 1)));
+	std::vector<ObjChunk> chunks(chunkCount);
+	const char* end = text + size;
+	const char* cursor = text;
+	for(size_t c = 0; c < chunkCount; c++)
+	{
+		chunks[c].begin = cursor;
+		cursor = c + 1 == chunkCount ? end : skipLine(std::max(cursor, text + size * (c + 1) / chunkCount - 1), end);
+		chunks[c].end = cursor;
+	}
+
+	threadPool.parallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t c) { parseChunk(chunks[c]); });
+
+	size_t positionCount = 0;
+	size_t normalCount = 0;
+	size_t texcoordCount = 0;
+	size_t triangleCount = 0;
+	for(ObjChunk& chunk : chunks)
+	{
+		if(chunk.failed)
+		{
+			throw std::runtime_error("failed to parse obj face!");
+		}
+
+		chunk.positionBase = positionCount;
+		chunk.normalBase = normalCount;
+		chunk.texcoordBase = texcoordCount;
+		chunk.triangleBase = triangleCount;
+		positionCount += chunk.positions.size() / 3;
+		normalCount += chunk.normals.size() / 3;
+		texcoordCount += chunk.texcoords.size() / 2;
+		triangleCount += chunk.triangleCount;
+	}
+
+	data.positions.resize(3 * positionCount);
+	data.colors.resize(3 * positionCount);
+	data.normals.resize(3 * normalCount);
+	data.texcoords.resize(2 * texcoordCount);
+	data.indices.resize(3 * triangleCount);
+
+	std::vector<char> succeeded(chunkCount, 0);
+	threadPool.parallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t c)
+	{
+		ObjChunk& chunk = chunks[c];
+		std::copy(chunk.positions.begin(), chunk.positions.end(), data.positions.begin() + 3 * chunk.positionBase);
+		std::copy(chunk.colors.begin(), chunk.colors.end(), data.colors.begin() + 3 * chunk.positionBase);
+		std::copy(chunk.normals.begin(), chunk.normals.end(), data.normals.begin() + 3 * chunk.normalBase);
+		std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), data.texcoords.begin() + 2 * chunk.texcoordBase);
+
+		const size_t bases[3] = { chunk.positionBase, chunk.normalBase, chunk.texcoordBase };
+		for(uint32_t slot : chunk.relativeSlots)
+		{
+			ObjIndex& corner = chunk.corners[slot >> 2];
+			int32_t* indices[3] = { &corner.position, &corner.normal, &corner.texcoord };
+			*indices[slot & 3] += static_cast<int32_t>(bases[slot & 3]);
+
+			// reaching back past the first element, checked here since -1 would read as a missing attribute
+			if(*indices[slot & 3] < 0)
+			{
+				chunk.failed = true;
+			}
+		}
+	});
+
+	// quads are split by their positions, so triangulation waits until all chunks are in place
+	threadPool.parallelFor(static_cast<uint32_t>(chunkCount), [&](uint32_t c) { succeeded[c] = triangulateChunk(chunks[c], data); });
+
+	if(std::find(succeeded.begin(), succeeded.end(), 0) != succeeded.end())
+	{
+		throw std::runtime_error("failed to parse obj: index out of range!");
+	}
+}
+
+void parseObj(const std::string& filepath, ObjData& data)
+{
+	MappedFile file{ filepath };
+	parseObj(reinterpret_cast<const char*>(file.getData()), file.getSize(), data);
+}
+
+}
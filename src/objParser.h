@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU Wavefront OBJ parsing into tinyobj style attribute arrays, independent of any GPU state
+
+// Zero based indices into ObjData arrays, -1 when the corner has no such attribute
+struct ObjIndex
+{
+	int32_t position;
+	int32_t normal;
+	int32_t texcoord;
+};
+
+struct ObjData
+{
+	std::vector<float> positions;	// xyz
+	std::vector<float> colors;	// rgb per position, white unless the file has vertex colors
+	std::vector<float> normals;	// xyz
+	std::vector<float> texcoords;	// uv
+	std::vector<ObjIndex> indices;	// triangle list in file order
+};
+
+// Memory-maps the file and parses line aligned chunks of it in parallel on the engine thread pool, appending
+// to per chunk arrays that are stitched together at the end. Only geometry is read, groups, materials and
+// smoothing groups are skipped, so all faces form one triangle list. Triangles and quads are split exactly
+// like tinyobj does, larger polygons as a fan.
+void parseObj(const std::string& filepath, ObjData& data);
+
+// Same as parseObj on text already in memory
+void parseObj(const char* text, size_t size, ObjData& data);
+
+}
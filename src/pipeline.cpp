@@ -47,12 +47,30 @@ void Pipeline::createGraphicsPipeline(const std::string& vertFilepath, const std
 	createInfo.stageCount = 2;
 	createInfo.pStages = shaderStages;
 
+	std::vector<VkVertexInputBindingDescription> bindingDescriptions;
+	for(const VkVertexInputBindingDescription& bindingDescription : config.bindingDescriptions)
+	{
+		if(config.vertexBindingMask & (1u << bindingDescription.binding))
+		{
+			bindingDescriptions.push_back(bindingDescription);
+		}
+	}
+
+	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+	for(const VkVertexInputAttributeDescription& attributeDescription : config.attributeDescriptions)
+	{
+		if(config.vertexBindingMask & (1u << attributeDescription.binding))
+		{
+			attributeDescriptions.push_back(attributeDescription);
+		}
+	}
+
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(config.attributeDescriptions.size());
-	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(config.bindingDescriptions.size());
-	vertexInputInfo.pVertexAttributeDescriptions = config.attributeDescriptions.data();
-	vertexInputInfo.pVertexBindingDescriptions = config.bindingDescriptions.data();
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+	vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+	vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+	vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 	createInfo.pVertexInputState = &vertexInputInfo;
 
 	VkPipelineInputAssemblyStateCreateInfo inputAssemblyState{};
@@ -75,7 +93,7 @@ void Pipeline::createGraphicsPipeline(const std::string& vertFilepath, const std
 	rasterizationState.rasterizerDiscardEnable = VK_FALSE;
 	rasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
 	rasterizationState.lineWidth = 1.0f;
-	rasterizationState.cullMode = VK_CULL_MODE_NONE;
+	rasterizationState.cullMode = config.cullMode;
 	rasterizationState.frontFace = VK_FRONT_FACE_CLOCKWISE;
 	rasterizationState.depthBiasEnable = VK_FALSE;
 	rasterizationState.depthBiasConstantFactor = 0.0f;  // Optional
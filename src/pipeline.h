@@ -19,6 +19,10 @@ struct PipelineConfig
 
 	std::vector<VkVertexInputBindingDescription> bindingDescriptions;
 	std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+	// bindings the vertex shader reads, the others and their attributes are left out so their streams are never fetched
+	uint32_t vertexBindingMask = ~0u;
+
+	VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
 
 	VkPipelineLayout pipelineLayout = nullptr;
 	VkRenderPass renderPass = nullptr;
@@ -0,0 +1,96 @@
+#include "rangeAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+namespace VulkanEngine
+{
+
+RangeAllocator::RangeAllocator(uint64_t capacity) : m_capacity(capacity)
+{
+	if(capacity > 0)
+	{
+		m_freeRanges[0] = capacity;
+	}
+}
+
+uint64_t RangeAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+	assert(size > 0 && alignment > 0 && "Range size and alignment must be positive");
+
+	for(auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+	{
+		uint64_t rangeOffset = it->first;
+		uint64_t rangeEnd = it->first + it->second;
+		uint64_t offset = (rangeOffset + alignment - 1) / alignment * alignment;
+
+		if(offset + size > rangeEnd)
+		{
+			continue;
+		}
+
+		// the alignment padding in front and the remainder behind stay free
+		m_freeRanges.erase(it);
+		if(offset > rangeOffset)
+		{
+			m_freeRanges[rangeOffset] = offset - rangeOffset;
+		}
+		if(offset + size < rangeEnd)
+		{
+			m_freeRanges[offset + size] = rangeEnd - offset - size;
+		}
+
+		m_usedSize += size;
+		return offset;
+	}
+
+	return INVALID_OFFSET;
+}
+
+void RangeAllocator::free(uint64_t offset, uint64_t size)
+{
+	assert(offset + size <= m_capacity && size <= m_usedSize && "Freed range was not allocated");
+
+	m_usedSize -= size;
+	insertFreeRange(offset, size);
+}
+
+uint64_t RangeAllocator::getLargestFreeRange() const
+{
+	uint64_t largest = 0;
+	for(const auto& range : m_freeRanges)
+	{
+		largest = std::max(largest, range.second);
+	}
+	return largest;
+}
+
+void RangeAllocator::insertFreeRange(uint64_t offset, uint64_t size)
+{
+	auto next = m_freeRanges.lower_bound(offset);
+	assert((next == m_freeRanges.end() || offset + size <= next->first) && "Freed range overlaps a free range");
+
+	if(next != m_freeRanges.begin())
+	{
+		auto previous = std::prev(next);
+		assert(previous->first + previous->second <= offset && "Freed range overlaps a free range");
+
+		if(previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			size += previous->second;
+			m_freeRanges.erase(previous);
+		}
+	}
+
+	if(next != m_freeRanges.end() && offset + size == next->first)
+	{
+		size += next->second;
+		m_freeRanges.erase(next);
+	}
+
+	m_freeRanges[offset] = size;
+}
+
+}
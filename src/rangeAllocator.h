@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace VulkanEngine
+{
+
+// Pure CPU first fit allocator handing out ranges of a fixed size address space, independent of any GPU state.
+// Freed ranges are merged with their free neighbours, so the space does not fragment into pieces smaller than what was freed.
+class RangeAllocator
+{
+public:
+	static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+	RangeAllocator(uint64_t capacity);
+
+	// Returns the offset of a free range of size bytes starting at a multiple of alignment, or INVALID_OFFSET when none is left.
+	// Alignment does not have to be a power of two, so ranges can be aligned to a vertex stride.
+	uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+	// Takes back a range returned by allocate, size has to match the requested one
+	void free(uint64_t offset, uint64_t size);
+
+	uint64_t getCapacity() const { return m_capacity; }
+	uint64_t getUsedSize() const { return m_usedSize; }
+	uint64_t getLargestFreeRange() const;
+
+private:
+	void insertFreeRange(uint64_t offset, uint64_t size);
+
+	uint64_t m_capacity;
+	uint64_t m_usedSize = 0;
+	std::map<uint64_t, uint64_t> m_freeRanges;	// offset to size, never adjacent to each other
+};
+
+}
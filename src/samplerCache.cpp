@@ -0,0 +1,79 @@
+#include "samplerCache.h"
+
+#include "utils.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+size_t SamplerCache::DescHash::operator()(const SamplerDesc& desc) const
+{
+	size_t seed = 0;
+	hashCombine(seed, desc.magFilter, desc.minFilter, desc.mipmapMode, desc.addressMode, desc.maxAnisotropy);
+	return seed;
+}
+
+SamplerCache::SamplerCache(Device& device) : m_device(device)
+{
+	VkPhysicalDeviceProperties properties{};
+	vkGetPhysicalDeviceProperties(m_device.getPhysicalDevice(), &properties);
+	m_maxSamplerAnisotropy = properties.limits.maxSamplerAnisotropy;
+}
+
+SamplerCache::~SamplerCache()
+{
+	for(auto& kv : m_samplers)
+	{
+		vkDestroySampler(m_device.getDevice(), kv.second, nullptr);
+	}
+}
+
+VkSampler SamplerCache::get(const SamplerDesc& desc)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_samplers.find(desc);
+	if(it != m_samplers.end())
+	{
+		return it->second;
+	}
+
+	float maxAnisotropy = std::min(desc.maxAnisotropy, m_maxSamplerAnisotropy);
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = desc.magFilter;
+	samplerInfo.minFilter = desc.minFilter;
+	samplerInfo.addressModeU = desc.addressMode;
+	samplerInfo.addressModeV = desc.addressMode;
+	samplerInfo.addressModeW = desc.addressMode;
+	samplerInfo.anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+	samplerInfo.maxAnisotropy = std::max(maxAnisotropy, 1.0f);
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+	samplerInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerInfo.compareEnable = VK_FALSE;
+	samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+	samplerInfo.mipmapMode = desc.mipmapMode;
+	samplerInfo.mipLodBias = 0.0f;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+
+	VkSampler sampler;
+	if(vkCreateSampler(m_device.getDevice(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+
+	m_samplers.emplace(desc, sampler);
+	return sampler;
+}
+
+uint32_t SamplerCache::getSamplerCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return static_cast<uint32_t>(m_samplers.size());
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "device.h"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace VulkanEngine
+{
+
+// Sampler state shared by any number of textures. Levels are never clamped, so one sampler fits every mip chain.
+struct SamplerDesc
+{
+	VkFilter magFilter = VK_FILTER_LINEAR;
+	VkFilter minFilter = VK_FILTER_LINEAR;
+	VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+	VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	// anisotropic filtering is off at 1 or below and capped at the device limit
+	float maxAnisotropy = 16.0f;
+
+	bool operator==(const SamplerDesc& other) const
+	{
+		return magFilter == other.magFilter && minFilter == other.minFilter && mipmapMode == other.mipmapMode
+			&& addressMode == other.addressMode && maxAnisotropy == other.maxAnisotropy;
+	}
+};
+
+// Creates each distinct sampler once, however many textures use it. Samplers live as long as the cache,
+// there are only ever a handful of them. Lookups are thread-safe.
+class SamplerCache
+{
+public:
+	SamplerCache(Device& device);
+	~SamplerCache();
+
+	SamplerCache(const SamplerCache&) = delete;
+	SamplerCache& operator=(const SamplerCache&) = delete;
+
+	VkSampler get(const SamplerDesc& desc = {});
+
+	uint32_t getSamplerCount() const;
+
+private:
+	struct DescHash
+	{
+		size_t operator()(const SamplerDesc& desc) const;
+	};
+
+	Device& m_device;
+	float m_maxSamplerAnisotropy = 1.0f;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<SamplerDesc, VkSampler, DescHash> m_samplers;
+};
+
+}
@@ -6,16 +6,25 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
 #include <array>
 
 namespace VulkanEngine
 {
 
+// largest simplification error allowed on screen, in pixels
+static constexpr float LOD_PIXEL_ERROR = 1.0f;
+// relative band around LOD_PIXEL_ERROR in which the current level is kept
+static constexpr float LOD_HYSTERESIS = 0.25f;
+
+// stays within the 128 bytes every device supports, the normal matrix is a mat3 with std430 padded columns
 struct SimplePushConstantData
 {
 	glm::mat4 modelMartix{ 1.0f };
-	glm::mat4 normalMatrix{ 1.0f };
+	glm::mat3x4 normalMatrix{ 1.0f };
+	uint32_t textureIndex = TextureManager::PLACEHOLDER_INDEX;
 };
 
 struct GameObjectUniformData
@@ -28,11 +37,9 @@ struct GameObjectUniformData
 	int numLights;
 };
 
-GameObjectPass::GameObjectPass(Device& device, DescriptorPool& descriptorPool) : RenderPass(device, descriptorPool)
+GameObjectPass::GameObjectPass(Device& device, UniformRing& uniformRing, GeometryArena& geometryArena, TextureManager& textureManager) :
+	RenderPass(device, uniformRing), geometryArena(geometryArena), textureManager(textureManager), defaultTexture(textureManager.load("textures/texture.jpg"))
 {
-	createUniformBuffers();
-	createDescriptorSetLayout();
-	createDescriptorSets();
 	createPipelineLayout();
 	createPipeline();
 }
@@ -42,37 +49,6 @@ GameObjectPass::~GameObjectPass()
 	vkDestroyPipelineLayout(device.getDevice(), pipelineLayout, nullptr);
 }
 
-void GameObjectPass::createUniformBuffers()
-{
-	uniformBuffers.resize(Device::MAX_FRAMES_IN_FLIGHT);
-	for(int i = 0; i < uniformBuffers.size(); i++)
-	{
-		uniformBuffers[i] = std::make_unique<Buffer>(device, sizeof(GameObjectUniformData), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-		uniformBuffers[i]->map();
-	}
-}
-
-void GameObjectPass::createDescriptorSetLayout()
-{
-	descriptorSetLayout.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS);
-	descriptorSetLayout.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-	descriptorSetLayout.build();
-}
-
-void GameObjectPass::createDescriptorSets()
-{
-	descriptorSets.resize(Device::MAX_FRAMES_IN_FLIGHT);
-	for(int i = 0; i < descriptorSets.size(); i++)
-	{
-		std::vector<DescriptorDesc> descriptorDescs(2);
-		descriptorDescs[0].binding = 0;
-		descriptorDescs[0].pBufferInfo = &uniformBuffers[i]->getBufferInfo();
-		descriptorDescs[1].binding = 1;
-		descriptorDescs[1].pImageInfo = &image.getImageInfo();
-		descriptorPool.allocateDescriptorSet(descriptorSetLayout, descriptorDescs, descriptorSets[i]);
-	}
-}
-
 void GameObjectPass::createPipelineLayout()
 {
 	VkPushConstantRange pushConstantRange{};
@@ -80,7 +56,7 @@ void GameObjectPass::createPipelineLayout()
 	pushConstantRange.offset = 0;
 	pushConstantRange.size = sizeof(SimplePushConstantData);
 
-	std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ descriptorSetLayout.getDescriptorSetLayout() };
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ uniformRing.getDescriptorSetLayout().getDescriptorSetLayout(), textureManager.getDescriptorSetLayout().getDescriptorSetLayout() };
 
 	VkPipelineLayoutCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -104,8 +80,66 @@ void GameObjectPass::createPipeline()
 	pipelineConfig.attributeDescriptions = Model::Vertex::getAttributeDescriptions();
 	pipelineConfig.renderPass = device.getRenderPass();
 	pipelineConfig.pipelineLayout = pipelineLayout;
+	pipelineConfig.cullMode = cullMode;
 
 	pipeline = std::make_unique<Pipeline>(device, "shaders/basic.vert.spv", "shaders/basic.frag.spv", pipelineConfig);
+
+	PipelineConfig compactPipelineConfig{};
+	compactPipelineConfig.bindingDescriptions = Model::CompactVertex::getBindingDescriptions();
+	compactPipelineConfig.attributeDescriptions = Model::CompactVertex::getAttributeDescriptions();
+	compactPipelineConfig.renderPass = device.getRenderPass();
+	compactPipelineConfig.pipelineLayout = pipelineLayout;
+	compactPipelineConfig.cullMode = cullMode;
+
+	compactPipeline = std::make_unique<Pipeline>(device, "shaders/basicCompact.vert.spv", "shaders/basic.frag.spv", compactPipelineConfig);
+}
+
+uint32_t GameObjectPass::selectLod(GameObject& obj, const glm::vec3& cameraPosition, const glm::mat4& projection) const
+{
+	const std::vector<Model::Lod>& lods = obj.pModel->getLods();
+	const BoundingSphere& sphere = obj.pModel->getBoundingSphere();
+	if (lods.size() == 1 || sphere.radius <= 0.0f)
+	{
+		return 0;
+	}
+
+	BoundingSphere worldSphere = obj.transform.worldBoundingSphere(sphere);
+	float radius = worldSphere.radius;
+	float distance = glm::length(worldSphere.center - cameraPosition);
+	if (distance <= radius)
+	{
+		return 0;
+	}
+
+	// projected radius in pixels, projection[1][1] is 1 / tan(fovy / 2) for a perspective camera
+	float projectedRadius = radius / distance * projection[1][1] * 0.5f * static_cast<float>(device.getSwapchainExtent().height);
+	auto getPixelError = [&](uint32_t lod) { return lods[lod].error / sphere.radius * projectedRadius; };
+
+	uint32_t lod = std::min(obj.lod, static_cast<uint32_t>(lods.size() - 1));
+	while (lod + 1 < lods.size() && getPixelError(lod + 1) <= LOD_PIXEL_ERROR * (1.0f - LOD_HYSTERESIS))
+	{
+		lod++;
+	}
+	while (lod > 0 && getPixelError(lod) > LOD_PIXEL_ERROR * (1.0f + LOD_HYSTERESIS))
+	{
+		lod--;
+	}
+	return lod;
+}
+
+uint32_t GameObjectPass::selectTextureLevel(GameObject& obj, const Texture& texture, const glm::vec3& cameraPosition, const glm::mat4& projection) const
+{
+	BoundingSphere worldSphere = obj.transform.worldBoundingSphere(obj.pModel->getBoundingSphere());
+	float distance = glm::length(worldSphere.center - cameraPosition);
+	if (worldSphere.radius <= 0.0f || distance <= worldSphere.radius)
+	{
+		return 0;
+	}
+
+	// projected diameter in pixels, as for the level of detail
+	float projectedSize = worldSphere.radius / distance * projection[1][1] * static_cast<float>(device.getSwapchainExtent().height);
+	float texelsPerPixel = static_cast<float>(std::max(texture.getWidth(), texture.getHeight())) / std::max(projectedSize, 1.0f);
+	return texelsPerPixel <= 1.0f ? 0 : static_cast<uint32_t>(std::log2(texelsPerPixel));
 }
 
 void GameObjectPass::update(FrameInfo& frameInfo)
@@ -142,14 +176,23 @@ void GameObjectPass::render(const FrameInfo& frameInfo)
 	}
 	uniformData.numLights = numLights;
 
-	uniformBuffers[frameInfo.frameIndex]->writeToBuffer(&uniformData);
-	uniformBuffers[frameInfo.frameIndex]->flush();
+	uint32_t uniformOffset = uniformRing.push(uniformData);
 
 	pipeline->bind(frameInfo.commandBuffer);
+	Model::VertexFormat boundFormat = Model::VertexFormat::Float;
+
+	// buffer bindings survive pipeline switches, they only change with the arena pools or the index type
+	uint32_t boundVertexPool = ~0u;
+	uint32_t boundIndexPool = 0;
+	VkIndexType boundIndexType = VK_INDEX_TYPE_UINT16;
+	geometryArena.bindIndexBuffer(frameInfo.commandBuffer, boundIndexPool, boundIndexType);
 
 	glm::mat4 projectionView = frameInfo.camera.getProjection() * frameInfo.camera.getView();
+	meshletCullStats = {};
 
-	vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[frameInfo.frameIndex], 0, nullptr);
+	// the only descriptor bind of the frame, textures are switched by the index pushed per object
+	std::array<VkDescriptorSet, 2> frameDescriptorSets{ uniformRing.getDescriptorSet(), textureManager.getDescriptorSet() };
+	vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(frameDescriptorSets.size()), frameDescriptorSets.data(), 1, &uniformOffset);
 
 	for (auto& kv : frameInfo.gameObjects)
 	{
@@ -158,14 +201,51 @@ void GameObjectPass::render(const FrameInfo& frameInfo)
 		if (obj.pModel == nullptr)
 			continue;
 
+		// both pipelines share the layout, so the descriptor set stays bound across the switch
+		if (obj.pModel->getVertexFormat() != boundFormat)
+		{
+			boundFormat = obj.pModel->getVertexFormat();
+			(boundFormat == Model::VertexFormat::Compact ? compactPipeline : pipeline)->bind(frameInfo.commandBuffer);
+		}
+
+		glm::mat4 modelMatrix = obj.transform.mat4();
+
 		SimplePushConstantData push{};
-		push.modelMartix = obj.transform.mat4();
-		push.normalMatrix = obj.transform.normalMatrix();
+		push.modelMartix = modelMatrix * obj.pModel->getDequantizeMatrix();
+		push.normalMatrix = glm::mat3x4(obj.transform.normalMatrix());
+		Texture& texture = *(obj.pTexture != nullptr ? obj.pTexture : defaultTexture);
+		push.textureIndex = texture.getIndex();
+		// streaming feedback, the texture manager brings in the finest level asked for this frame
+		texture.requestLevel(selectTextureLevel(obj, texture, frameInfo.camera.getPosition(), frameInfo.camera.getProjection()));
 
 		vkCmdPushConstants(frameInfo.commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SimplePushConstantData), &push);
 
-		obj.pModel->bind(frameInfo.commandBuffer);
-		obj.pModel->draw(frameInfo.commandBuffer);
+		obj.lod = selectLod(obj, frameInfo.camera.getPosition(), frameInfo.camera.getProjection());
+
+		if (obj.pModel->getVertexPool() != boundVertexPool)
+		{
+			boundVertexPool = obj.pModel->getVertexPool();
+			geometryArena.bindVertexBuffers(frameInfo.commandBuffer, boundVertexPool);
+		}
+
+		if (obj.pModel->getIndexPool() != boundIndexPool || obj.pModel->getIndexType() != boundIndexType)
+		{
+			boundIndexPool = obj.pModel->getIndexPool();
+			boundIndexType = obj.pModel->getIndexType();
+			geometryArena.bindIndexBuffer(frameInfo.commandBuffer, boundIndexPool, boundIndexType);
+		}
+
+		if (obj.lod == 0 && obj.pModel->hasMeshlets())
+		{
+			// meshlet bounds are in the unquantized model space, so the dequantize matrix is left out
+			MeshletCullParams cullParams{ projectionView, modelMatrix, frameInfo.camera.getPosition() };
+			cullParams.cullBackfaces = (cullMode & VK_CULL_MODE_BACK_BIT) != 0;
+			meshletCullStats += obj.pModel->draw(frameInfo.commandBuffer, cullParams);
+		}
+		else
+		{
+			obj.pModel->draw(frameInfo.commandBuffer, obj.lod);
+		}
 	}
 }
 
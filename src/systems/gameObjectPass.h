@@ -1,7 +1,9 @@
 #pragma once
 
 #include "renderPass.h"
-#include "image.h"
+#include "textureManager.h"
+#include "geometryArena.h"
+#include "meshlet.h"
 
 namespace VulkanEngine
 {
@@ -9,7 +11,7 @@ namespace VulkanEngine
 class GameObjectPass : public RenderPass
 {
 public:
-	GameObjectPass(Device& device, DescriptorPool& descriptorPool);
+	GameObjectPass(Device& device, UniformRing& uniformRing, GeometryArena& geometryArena, TextureManager& textureManager);
 	~GameObjectPass();
 
 	GameObjectPass(const GameObjectPass&) = delete;
@@ -18,14 +20,32 @@ public:
 	void update(FrameInfo& frameInfo);
 	void render(const FrameInfo& frameInfo);
 
+	// culling results of the last rendered frame, summed over all models drawn as meshlets
+	const MeshletCullStats& getMeshletCullStats() const { return meshletCullStats; }
+
 private:
-	virtual void createUniformBuffers() override;
-	virtual void createDescriptorSetLayout() override;
-	virtual void createDescriptorSets() override;
 	virtual void createPipelineLayout() override;
 	virtual void createPipeline() override;
 
-	Image image{ device, "textures/texture.jpg" };
+	// Coarsest level whose error stays under LOD_PIXEL_ERROR on screen, only left once it is clearly wrong
+	uint32_t selectLod(GameObject& obj, const glm::vec3& cameraPosition, const glm::mat4& projection) const;
+	// Finest texture level with at most one texel per pixel, assuming the texture spans the bounding sphere once
+	uint32_t selectTextureLevel(GameObject& obj, const Texture& texture, const glm::vec3& cameraPosition, const glm::mat4& projection) const;
+
+	// holds the geometry of every model, bound once per vertex layout
+	GeometryArena& geometryArena;
+
+	// pipeline for models stored as Model::CompactVertex
+	std::unique_ptr<Pipeline> compactPipeline;
+
+	// shared by both pipelines, meshlets are only culled by their normal cone when back faces are
+	VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+	MeshletCullStats meshletCullStats;
+
+	// owns the bindless texture array bound as set 1, objects pick their element by push constant
+	TextureManager& textureManager;
+	// drawn on objects without a texture of their own
+	std::shared_ptr<Texture> defaultTexture;
 };
 
 }
\ No newline at end of file
@@ -25,11 +25,8 @@ struct PointLightUniformData
 	glm::mat4 view{ 1.0f };
 };
 
-PointLightPass::PointLightPass(Device& device, DescriptorPool& descriptorPool) : RenderPass(device, descriptorPool)
+PointLightPass::PointLightPass(Device& device, UniformRing& uniformRing) : RenderPass(device, uniformRing)
 {
-	createUniformBuffers();
-	createDescriptorSetLayout();
-	createDescriptorSets();
 	createPipelineLayout();
 	createPipeline();
 }
@@ -39,34 +36,6 @@ PointLightPass::~PointLightPass()
 	vkDestroyPipelineLayout(device.getDevice(), pipelineLayout, nullptr);
 }
 
-void PointLightPass::createUniformBuffers()
-{
-	uniformBuffers.resize(Device::MAX_FRAMES_IN_FLIGHT);
-	for(int i = 0; i < uniformBuffers.size(); i++)
-	{
-		uniformBuffers[i] = std::make_unique<Buffer>(device, sizeof(PointLightUniformData), 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
-		uniformBuffers[i]->map();
-	}
-}
-
-void PointLightPass::createDescriptorSetLayout()
-{
-	descriptorSetLayout.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS);
-	descriptorSetLayout.build();
-}
-
-void PointLightPass::createDescriptorSets()
-{
-	descriptorSets.resize(Device::MAX_FRAMES_IN_FLIGHT);
-	for(int i = 0; i < descriptorSets.size(); i++)
-	{
-		std::vector<DescriptorDesc> descriptorDescs(1);
-		descriptorDescs[0].binding = 0;
-		descriptorDescs[0].pBufferInfo = &uniformBuffers[i]->getBufferInfo();
-		descriptorPool.allocateDescriptorSet(descriptorSetLayout, descriptorDescs, descriptorSets[i]);
-	}
-}
-
 void PointLightPass::createPipelineLayout()
 {
 	VkPushConstantRange pushConstantRange{};
@@ -74,7 +43,7 @@ void PointLightPass::createPipelineLayout()
 	pushConstantRange.offset = 0;
 	pushConstantRange.size = sizeof(PointLightPushConstant);
 
-	std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ descriptorSetLayout.getDescriptorSetLayout() };
+	std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ uniformRing.getDescriptorSetLayout().getDescriptorSetLayout() };
 
 	VkPipelineLayoutCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -106,8 +75,7 @@ void PointLightPass::render(const FrameInfo& frameInfo)
 	ubo.projection = frameInfo.camera.getProjection();
 	ubo.view = frameInfo.camera.getView();
 
-	uniformBuffers[frameInfo.frameIndex]->writeToBuffer(&ubo);
-	uniformBuffers[frameInfo.frameIndex]->flush();
+	uint32_t uniformOffset = uniformRing.push(ubo);
 
 	std::map<float, GameObject::id_t> map;
 	for (auto& vk : frameInfo.gameObjects)
@@ -125,7 +93,8 @@ void PointLightPass::render(const FrameInfo& frameInfo)
 
 	glm::mat4 projectionView = frameInfo.camera.getProjection() * frameInfo.camera.getView();
 
-	vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[frameInfo.frameIndex], 0, nullptr);
+	VkDescriptorSet uniformSet = uniformRing.getDescriptorSet();
+	vkCmdBindDescriptorSets(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &uniformSet, 1, &uniformOffset);
 
 	for (auto it = map.rbegin(); it != map.rend(); ++it)
 	{
@@ -8,7 +8,7 @@ namespace VulkanEngine
 class PointLightPass : public RenderPass
 {
 public:
-	PointLightPass(Device& device, DescriptorPool& descriptorPool);
+	PointLightPass(Device& device, UniformRing& uniformRing);
 	~PointLightPass();
 
 	PointLightPass(const PointLightPass&) = delete;
@@ -17,9 +17,6 @@ public:
 	void render(const FrameInfo& frameInfo);
 
 private:
-	virtual void createUniformBuffers() override;
-	virtual void createDescriptorSetLayout() override;
-	virtual void createDescriptorSets() override;
 	virtual void createPipelineLayout() override;
 	virtual void createPipeline() override;
 };
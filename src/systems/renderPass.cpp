@@ -3,7 +3,7 @@
 namespace VulkanEngine
 {
 
-RenderPass::RenderPass(Device& device, DescriptorPool& descriptorPool) :device{ device }, descriptorPool{ descriptorPool }
+RenderPass::RenderPass(Device& device, UniformRing& uniformRing) :device{ device }, uniformRing{ uniformRing }
 {
 	
 }
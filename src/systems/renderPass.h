@@ -5,7 +5,7 @@
 #include "device.h"
 #include "gameobject.h"
 #include "frameInfo.h"
-#include "descriptor.h"
+#include "uniformRing.h"
 
 #include <memory>
 #include <vector>
@@ -15,7 +15,7 @@ namespace VulkanEngine
 class RenderPass
 {
 public:
-	RenderPass(Device& device, DescriptorPool& descriptorPool);
+	RenderPass(Device& device, UniformRing& uniformRing);
 	~RenderPass();
 
 	RenderPass(const RenderPass&) = delete;
@@ -24,21 +24,13 @@ public:
 	virtual void render(const FrameInfo& frameInfo) = 0;
 
 private:
-	virtual void createUniformBuffers() = 0;
-	virtual void createDescriptorSetLayout() = 0;
-	virtual void createDescriptorSets() = 0;
 	virtual void createPipelineLayout() = 0;
 	virtual void createPipeline() = 0;
 
 protected:
 	Device& device;
-	DescriptorPool& descriptorPool;
-
-	std::vector<std::unique_ptr<Buffer>> uniformBuffers;
-
-	DescriptorSetLayout descriptorSetLayout{ device };
-
-	std::vector<VkDescriptorSet> descriptorSets;
+	// uniforms of every pass, bound as set 0 at the offsets they were pushed at
+	UniformRing& uniformRing;
 
 	std::unique_ptr<Pipeline> pipeline;
 	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
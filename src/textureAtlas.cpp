@@ -0,0 +1,178 @@
+#include "textureAtlas.h"
+#include "mipmap.h"
+
+#include <stb/stb_image.h>
+
+// imgui compiles its own static copy, this one stays private to the atlas as well
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imgui/imstb_rectpack.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace VulkanEngine
+{
+
+TextureAtlas::TextureAtlas(uint32_t pageSize) : m_pageSize(pageSize)
+{
+	if(pageSize == 0 || pageSize % GUTTER != 0)
+	{
+		throw std::invalid_argument("atlas page size must be a multiple of the gutter");
+	}
+}
+
+uint32_t TextureAtlas::add(const std::string& filepath)
+{
+	std::string enginePath = ENGINE_DIR + filepath;
+
+	int texWidth, texHeight, texChannels;
+	stbi_uc* pixels = stbi_load(enginePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	if(!pixels)
+	{
+		throw std::runtime_error("failed to load texture image!");
+	}
+
+	try
+	{
+		uint32_t region = add(pixels, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+		stbi_image_free(pixels);
+		return region;
+	}
+	catch(...)
+	{
+		stbi_image_free(pixels);
+		throw;
+	}
+}
+
+uint32_t TextureAtlas::add(const uint8_t* texels, uint32_t width, uint32_t height)
+{
+	if(width == 0 || height == 0 || width + 2 * GUTTER > m_pageSize || height + 2 * GUTTER > m_pageSize)
+	{
+		throw std::runtime_error("texture does not fit on an atlas page!");
+	}
+
+	Source source{};
+	source.texels.assign(texels, texels + static_cast<size_t>(width) * height * 4);
+	source.width = width;
+	source.height = height;
+	m_sources.push_back(std::move(source));
+
+	m_regions.emplace_back();
+	return static_cast<uint32_t>(m_regions.size() - 1);
+}
+
+void TextureAtlas::build(bool srgb)
+{
+	// packed in units of GUTTER texels, which keeps every region aligned to the coarsest level
+	const int pageCells = static_cast<int>(m_pageSize / GUTTER);
+	auto toCells = [](uint32_t texels) { return static_cast<int>((texels + 2 * GUTTER + GUTTER - 1) / GUTTER); };
+
+	std::vector<stbrp_rect> remaining;
+	for(uint32_t i = 0; i < m_sources.size(); i++)
+	{
+		stbrp_rect rect{};
+		rect.id = static_cast<int>(i);
+		rect.w = toCells(m_sources[i].width);
+		rect.h = toCells(m_sources[i].height);
+		remaining.push_back(rect);
+	}
+
+	std::vector<stbrp_node> nodes(pageCells);
+	while(!remaining.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, pageCells, pageCells, nodes.data(), static_cast<int>(nodes.size()));
+		stbrp_pack_rects(&context, remaining.data(), static_cast<int>(remaining.size()));
+
+		std::vector<stbrp_rect> packed;
+		std::vector<stbrp_rect> unpacked;
+		for(const stbrp_rect& rect : remaining)
+		{
+			(rect.was_packed ? packed : unpacked).push_back(rect);
+		}
+		remaining.swap(unpacked);
+
+		uint32_t pageIndex = static_cast<uint32_t>(m_pages.size());
+		uint32_t pageWidth = 0;
+		uint32_t pageHeight = 0;
+		for(const stbrp_rect& rect : packed)
+		{
+			pageWidth = std::max(pageWidth, static_cast<uint32_t>(rect.x + rect.w) * GUTTER);
+			pageHeight = std::max(pageHeight, static_cast<uint32_t>(rect.y + rect.h) * GUTTER);
+		}
+
+		ImageData page{};
+		page.format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+		page.width = pageWidth;
+		page.height = pageHeight;
+		page.mipLevels = std::min(MIP_LEVELS, getMipLevelCount(pageWidth, pageHeight));
+		page.levelOffsets.resize(page.mipLevels + 1);
+		for(uint32_t level = 0; level < page.mipLevels; level++)
+		{
+			page.levelOffsets[level + 1] = page.levelOffsets[level] + static_cast<size_t>(std::max(1u, pageWidth >> level)) * std::max(1u, pageHeight >> level) * 4;
+		}
+		page.texels.assign(page.levelOffsets[page.mipLevels], 0);
+
+		for(const stbrp_rect& rect : packed)
+		{
+			Source& source = m_sources[rect.id];
+			uint32_t originX = static_cast<uint32_t>(rect.x) * GUTTER;
+			uint32_t originY = static_cast<uint32_t>(rect.y) * GUTTER;
+			uint32_t cellWidth = static_cast<uint32_t>(rect.w) * GUTTER;
+			uint32_t cellHeight = static_cast<uint32_t>(rect.h) * GUTTER;
+
+			// the whole cell is filled, texels past the texture repeat its nearest edge like clamp to edge sampling would
+			for(uint32_t y = 0; y < cellHeight; y++)
+			{
+				uint32_t sourceY = static_cast<uint32_t>(std::clamp(static_cast<int64_t>(y) - GUTTER, int64_t{ 0 }, static_cast<int64_t>(source.height - 1)));
+				uint8_t* pageRow = page.texels.data() + (static_cast<size_t>(originY + y) * pageWidth + originX) * 4;
+				const uint8_t* sourceRow = source.texels.data() + static_cast<size_t>(sourceY) * source.width * 4;
+
+				for(uint32_t x = 0; x < GUTTER; x++)
+				{
+					std::memcpy(pageRow + x * 4, sourceRow, 4);
+				}
+				std::memcpy(pageRow + GUTTER * 4, sourceRow, static_cast<size_t>(source.width) * 4);
+				for(uint32_t x = GUTTER + source.width; x < cellWidth; x++)
+				{
+					std::memcpy(pageRow + x * 4, sourceRow + static_cast<size_t>(source.width - 1) * 4, 4);
+				}
+			}
+
+			AtlasRegion& region = m_regions[rect.id];
+			region.page = pageIndex;
+			region.offset = glm::vec2(originX + GUTTER, originY + GUTTER) / glm::vec2(pageWidth, pageHeight);
+			region.scale = glm::vec2(source.width, source.height) / glm::vec2(pageWidth, pageHeight);
+			m_usedTexels += static_cast<uint64_t>(source.width) * source.height;
+
+			source = {};
+		}
+
+		for(uint32_t level = 1; level < page.mipLevels; level++)
+		{
+			downsampleRgba8(page.texels.data() + page.levelOffsets[level - 1], std::max(1u, pageWidth >> (level - 1)), std::max(1u, pageHeight >> (level - 1)),
+				page.texels.data() + page.levelOffsets[level], srgb);
+		}
+
+		m_pageTexels += static_cast<uint64_t>(pageWidth) * pageHeight;
+		m_pages.push_back(std::move(page));
+	}
+
+	m_sources.clear();
+}
+
+std::vector<ImageData> TextureAtlas::takePages()
+{
+	std::vector<ImageData> pages;
+	pages.swap(m_pages);
+	return pages;
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "imageData.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Where a texture ended up in an atlas, texcoords in [0, 1] of the texture map to offset + texcoord * scale of the page.
+// Texcoords outside of it are clamped, a texture that repeats across its mesh has to stay a texture of its own.
+struct AtlasRegion
+{
+	uint32_t page = 0;
+	glm::vec2 offset{ 0.0f };
+	glm::vec2 scale{ 1.0f };
+
+	glm::vec2 remap(const glm::vec2& texcoord) const { return offset + glm::clamp(texcoord, 0.0f, 1.0f) * scale; }
+};
+
+// Packs many small RGBA8 textures into a few shared pages at load time, so they cost one image, allocation and
+// descriptor per page instead of one each. Regions are surrounded by a gutter that repeats their edge texels and
+// start on a multiple of GUTTER texels, so none of the MIP_LEVELS levels of a page filters across two textures.
+class TextureAtlas
+{
+public:
+	static constexpr uint32_t DEFAULT_PAGE_SIZE = 2048;
+	// levels of every page, the gutter shrinks to a single texel in the last one
+	static constexpr uint32_t MIP_LEVELS = 4;
+	static constexpr uint32_t GUTTER = 1u << (MIP_LEVELS - 1);
+
+	// pageSize has to be a multiple of GUTTER
+	TextureAtlas(uint32_t pageSize = DEFAULT_PAGE_SIZE);
+
+	TextureAtlas(const TextureAtlas&) = delete;
+	TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	// Decodes an image file relative to the engine directory, returns the index of its region
+	uint32_t add(const std::string& filepath);
+	// Copies width * height RGBA8 texels, throws when they do not fit on a page with their gutter
+	uint32_t add(const uint8_t* texels, uint32_t width, uint32_t height);
+
+	// Packs every texture added so far into pages with their mip levels. Pages are cropped to what they use,
+	// so a small last page stays small. srgb averages the color channels as linear values.
+	void build(bool srgb = true);
+
+	uint32_t getRegionCount() const { return static_cast<uint32_t>(m_regions.size()); }
+	const AtlasRegion& getRegion(uint32_t region) const { return m_regions[region]; }
+	uint32_t getPageCount() const { return static_cast<uint32_t>(m_pages.size()); }
+	const ImageData& getPage(uint32_t page) const { return m_pages[page]; }
+	// Share of the page texels covered by textures rather than gutters or free space
+	float getOccupancy() const { return m_pageTexels > 0 ? static_cast<float>(m_usedTexels) / static_cast<float>(m_pageTexels) : 0.0f; }
+
+	// Moves the pages out for upload, see TextureManager::createAtlasTextures. The regions stay valid.
+	std::vector<ImageData> takePages();
+
+private:
+	struct Source
+	{
+		std::vector<uint8_t> texels;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	uint32_t m_pageSize;
+	std::vector<Source> m_sources;	// released by build()
+	std::vector<AtlasRegion> m_regions;
+	std::vector<ImageData> m_pages;
+	uint64_t m_usedTexels = 0;
+	uint64_t m_pageTexels = 0;	// kept apart from m_pages, which takePages() empties
+};
+
+}
@@ -0,0 +1,488 @@
+#include "textureManager.h"
+
+#include "threadPool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <queue>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace VulkanEngine
+{
+
+TextureManager::TextureManager(Device& device, UploadBatch& uploadBatch) :
+	m_device(device), m_uploadBatch(uploadBatch), m_samplerCache(device), m_descriptorSetLayout(device), m_descriptorPool(device)
+{
+	// opaque white, so lit surfaces keep their shading while their texture loads
+	ImageData placeholder{};
+	placeholder.texels = { 255, 255, 255, 255 };
+	placeholder.levelOffsets = { 0, 4 };
+	m_pPlaceholder = std::make_unique<Image>(m_device, m_uploadBatch, placeholder);
+
+	createDescriptorSet();
+}
+
+TextureManager::~TextureManager()
+{
+	// decodes only wait on files and the CPU, so they finish without further updates
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_decodesDone.wait(lock, [this] { return m_runningDecodes == 0; });
+	}
+
+	// images must not be destroyed while their copies are in flight
+	m_uploadBatch.flush();
+}
+
+std::shared_ptr<Texture> TextureManager::load(const std::string& filepath)
+{
+	// different spellings of one file share the texture
+	std::string key = std::filesystem::weakly_canonical(ENGINE_DIR + filepath).generic_string();
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_textures.find(key);
+	if(it != m_textures.end())
+	{
+		it->second.unusedFrames = 0;
+		return it->second.pTexture;
+	}
+
+	auto pTexture = std::make_shared<Texture>();
+	pTexture->m_pPlaceholder = m_pPlaceholder.get();
+	m_textures.emplace(key, Entry{ pTexture });
+	m_runningDecodes++;
+	m_pendingCount++;
+
+	ThreadPool::get().submit([this, filepath, pTexture]() mutable
+	{
+		try
+		{
+			ImageData data = Image::decode(m_device, filepath);
+
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_decoded.push_back({ std::move(pTexture), std::move(data) });
+		}
+		catch(const std::exception& e)
+		{
+			std::cerr << "failed to load texture " << filepath << ": " << e.what() << std::endl;
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_pendingCount--;
+		}
+
+		// the worker keeps the task alive past its return, so its reference must not keep the texture from being evicted
+		pTexture.reset();
+
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_runningDecodes--;
+		m_decodesDone.notify_all();
+	});
+
+	return pTexture;
+}
+
+std::shared_ptr<Texture> TextureManager::create(const std::string& name, ImageData data)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	auto it = m_textures.find(name);
+	if(it != m_textures.end())
+	{
+		it->second.unusedFrames = 0;
+		return it->second.pTexture;
+	}
+
+	auto pTexture = std::make_shared<Texture>();
+	pTexture->m_pPlaceholder = m_pPlaceholder.get();
+	m_textures.emplace(name, Entry{ pTexture });
+	m_pendingCount++;
+	m_decoded.push_back({ pTexture, std::move(data) });
+
+	return pTexture;
+}
+
+std::vector<std::shared_ptr<Texture>> TextureManager::createAtlasTextures(const std::string& name, TextureAtlas& atlas)
+{
+	std::vector<ImageData> pages = atlas.takePages();
+
+	std::vector<std::shared_ptr<Texture>> textures;
+	for(uint32_t page = 0; page < pages.size(); page++)
+	{
+		textures.push_back(create(name + "#" + std::to_string(page), std::move(pages[page])));
+	}
+	return textures;
+}
+
+void TextureManager::update()
+{
+	completeUploads();
+	submitUploads();
+	releaseRetiredImages();
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	for(auto it = m_textures.begin(); it != m_textures.end();)
+	{
+		Entry& entry = it->second;
+		if(entry.pTexture.use_count() > 1)
+		{
+			entry.unusedFrames = 0;
+		}
+		else if(++entry.unusedFrames > Device::MAX_FRAMES_IN_FLIGHT)
+		{
+			// no frame in flight reads the element anymore, so it can be rewritten for another texture
+			if(entry.pTexture->m_index != PLACEHOLDER_INDEX)
+			{
+				m_freeIndices.push_back(entry.pTexture->m_index);
+			}
+			it = m_textures.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
+void TextureManager::finishLoading()
+{
+	{
+		std::unique_lock<std::mutex> lock{ m_mutex };
+		m_decodesDone.wait(lock, [this] { return m_runningDecodes == 0; });
+	}
+
+	// the submission in flight has to finish before the rest can go out
+	m_uploadBatch.flush();
+	completeUploads();
+	submitUploads();
+	m_uploadBatch.flush();
+	completeUploads();
+}
+
+void TextureManager::completeUploads()
+{
+	if(m_uploading.empty() || !m_uploadBatch.isComplete(m_uploadSubmission))
+	{
+		return;
+	}
+
+	uint32_t loadedCount = 0;
+	for(UploadingTexture& uploading : m_uploading)
+	{
+		Texture& texture = *uploading.pTexture;
+		if(texture.m_pImage == nullptr)
+		{
+			loadedCount++;
+		}
+
+		uint32_t index = allocateIndex();
+		if(index == PLACEHOLDER_INDEX && texture.m_pImage != nullptr)
+		{
+			// the array is full, better keep the levels already resident than show the placeholder
+			texture.m_targetLevel = texture.m_pImage->getFirstLevel();
+			continue;
+		}
+
+		// frames in flight may still sample the old image through its element, so both live on for a while
+		if(texture.m_pImage != nullptr)
+		{
+			std::lock_guard<std::mutex> lock{ m_mutex };
+			m_retired.push_back({ std::move(texture.m_pImage), texture.m_index });
+		}
+
+		texture.m_pImage = std::move(uploading.pImage);
+		texture.m_index = index;
+		if(index != PLACEHOLDER_INDEX)
+		{
+			writeDescriptor(index, *texture.m_pImage);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_pendingCount -= loadedCount;
+	m_uploading.clear();
+}
+
+void TextureManager::submitUploads()
+{
+	if(!m_uploading.empty())
+	{
+		return;
+	}
+
+	std::vector<DecodedTexture> decoded;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		decoded.swap(m_decoded);
+		m_loadCount += static_cast<uint32_t>(decoded.size());
+	}
+
+	// new streamed textures only get their tail, streamLevels() asks for the rest once they are drawn
+	for(DecodedTexture& decodedTexture : decoded)
+	{
+		Texture& texture = *decodedTexture.pTexture;
+		auto pData = std::make_shared<const ImageData>(std::move(decodedTexture.data));
+
+		texture.m_width = pData->width;
+		texture.m_height = pData->height;
+		texture.m_levelCount = pData->mipLevels;
+
+		// only level 0 is on the CPU, so the chain is blitted in full and the texels are dropped with the upload
+		if(pData->generateMipmaps)
+		{
+			texture.m_minLevel = 0;
+			texture.m_targetLevel = 0;
+			m_uploading.push_back({ decodedTexture.pTexture, std::make_shared<Image>(m_device, m_uploadBatch, *pData) });
+			continue;
+		}
+
+		texture.m_levelSizes.assign(pData->mipLevels + 1, 0);
+		for(uint32_t level = pData->mipLevels; level-- > 0;)
+		{
+			texture.m_levelSizes[level] = texture.m_levelSizes[level + 1] + pData->getLevelSize(level);
+		}
+
+		texture.m_minLevel = 0;
+		while(texture.m_minLevel + 1 < pData->mipLevels && std::max(pData->width, pData->height) >> texture.m_minLevel > STREAMING_TAIL_SIZE)
+		{
+			texture.m_minLevel++;
+		}
+		texture.m_targetLevel = texture.m_minLevel;
+		texture.m_pData = pData;
+
+		m_uploading.push_back({ decodedTexture.pTexture, std::make_shared<Image>(m_device, m_uploadBatch, *pData, texture.m_targetLevel) });
+	}
+
+	streamLevels();
+
+	if(!m_uploading.empty())
+	{
+		m_uploadSubmission = m_uploadBatch.submitAsync();
+	}
+}
+
+void TextureManager::streamLevels()
+{
+	std::vector<std::shared_ptr<Texture>> textures;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		for(const auto& kv : m_textures)
+		{
+			if(kv.second.pTexture->m_pData != nullptr)
+			{
+				textures.push_back(kv.second.pTexture);
+			}
+		}
+	}
+
+	// unrequested textures keep what they have until the budget needs it
+	VkDeviceSize totalBytes = 0;
+	std::vector<uint32_t> levels(textures.size());
+	for(size_t i = 0; i < textures.size(); i++)
+	{
+		Texture& texture = *textures[i];
+		if(texture.m_requestedLevel != UINT32_MAX)
+		{
+			levels[i] = std::min(texture.m_requestedLevel, texture.m_minLevel);
+			texture.m_unrequestedFrames = 0;
+		}
+		else
+		{
+			levels[i] = texture.m_targetLevel;
+			texture.m_unrequestedFrames++;
+		}
+		texture.m_requestedLevel = UINT32_MAX;
+		totalBytes += texture.getStreamedSize(levels[i]);
+	}
+
+	VkDeviceSize budget;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_requestedBytes = totalBytes;
+		budget = m_budget;
+	}
+
+	// drops the finest level of the texture unused the longest, the largest level first among equally old ones
+	using Candidate = std::pair<std::pair<uint32_t, VkDeviceSize>, size_t>;
+	std::priority_queue<Candidate> candidates;
+	auto pushCandidate = [&](size_t i)
+	{
+		const Texture& texture = *textures[i];
+		if(levels[i] < texture.m_minLevel)
+		{
+			VkDeviceSize levelSize = texture.getStreamedSize(levels[i]) - texture.getStreamedSize(levels[i] + 1);
+			candidates.push({ { texture.m_unrequestedFrames, levelSize }, i });
+		}
+	};
+
+	for(size_t i = 0; i < textures.size(); i++)
+	{
+		pushCandidate(i);
+	}
+	while(totalBytes > budget && !candidates.empty())
+	{
+		size_t i = candidates.top().second;
+		candidates.pop();
+
+		totalBytes -= textures[i]->getStreamedSize(levels[i]) - textures[i]->getStreamedSize(levels[i] + 1);
+		levels[i]++;
+		pushCandidate(i);
+	}
+
+	VkDeviceSize streamedBytes = 0;
+	for(size_t i = 0; i < textures.size() && streamedBytes < MAX_STREAMED_BYTES_PER_UPDATE; i++)
+	{
+		Texture& texture = *textures[i];
+		if(levels[i] == texture.m_targetLevel || texture.m_pImage == nullptr)
+		{
+			continue;
+		}
+
+		texture.m_targetLevel = levels[i];
+		streamedBytes += texture.getStreamedSize(levels[i]);
+		m_uploading.push_back({ textures[i], std::make_shared<Image>(m_device, m_uploadBatch, *texture.m_pData, levels[i]) });
+	}
+}
+
+void TextureManager::releaseRetiredImages()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	for(auto it = m_retired.begin(); it != m_retired.end();)
+	{
+		if(++it->frames > Device::MAX_FRAMES_IN_FLIGHT)
+		{
+			if(it->index != PLACEHOLDER_INDEX)
+			{
+				m_freeIndices.push_back(it->index);
+			}
+			it = m_retired.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
+void TextureManager::createDescriptorSet()
+{
+	VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+	indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &indexingProperties;
+	vkGetPhysicalDeviceProperties2(m_device.getPhysicalDevice(), &properties);
+
+	// combined image samplers count against both the sampler and the sampled image limits
+	m_descriptorCount = std::min({ MAX_BINDLESS_TEXTURES,
+		indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages, indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+		indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers });
+
+	// partially bound, as elements are only written once their texture is resident
+	m_descriptorSetLayout.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, m_descriptorCount,
+		VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+	m_descriptorSetLayout.build();
+
+	m_descriptorPool.addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_descriptorCount);
+	m_descriptorPool.setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+	m_descriptorPool.setMaxSets(1);
+	m_descriptorPool.build();
+
+	VkDescriptorImageInfo imageInfo = m_pPlaceholder->getImageInfo(getSampler());
+
+	std::vector<DescriptorDesc> descriptorDescs(1);
+	descriptorDescs[0].binding = 0;
+	descriptorDescs[0].pImageInfo = &imageInfo;
+	m_descriptorPool.allocateDescriptorSet(m_descriptorSetLayout, descriptorDescs, m_descriptorSet, m_descriptorCount);
+}
+
+uint32_t TextureManager::allocateIndex()
+{
+	if(!m_freeIndices.empty())
+	{
+		uint32_t index = m_freeIndices.back();
+		m_freeIndices.pop_back();
+		return index;
+	}
+	if(m_nextIndex < m_descriptorCount)
+	{
+		return m_nextIndex++;
+	}
+
+	std::cerr << "bindless texture array of " << m_descriptorCount << " elements is full" << std::endl;
+	return PLACEHOLDER_INDEX;
+}
+
+void TextureManager::writeDescriptor(uint32_t index, const Image& image)
+{
+	// update after bind lets this go into the set the recorded frames have bound, none of them reads this element
+	VkDescriptorImageInfo imageInfo = image.getImageInfo(getSampler());
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_descriptorSet;
+	write.dstBinding = 0;
+	write.dstArrayElement = index;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageInfo;
+	vkUpdateDescriptorSets(m_device.getDevice(), 1, &write, 0, nullptr);
+}
+
+uint32_t TextureManager::getTextureCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return static_cast<uint32_t>(m_textures.size());
+}
+
+uint32_t TextureManager::getLoadCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_loadCount;
+}
+
+uint32_t TextureManager::getPendingCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_pendingCount;
+}
+
+VkDeviceSize TextureManager::getResidentBytes() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	VkDeviceSize residentBytes = 0;
+	for(const auto& kv : m_textures)
+	{
+		if(kv.second.pTexture->isResident())
+		{
+			residentBytes += kv.second.pTexture->getImage().getMemorySize();
+		}
+	}
+	for(const RetiredImage& retired : m_retired)
+	{
+		residentBytes += retired.pImage->getMemorySize();
+	}
+	return residentBytes;
+}
+
+VkDeviceSize TextureManager::getRequestedBytes() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_requestedBytes;
+}
+
+void TextureManager::setBudget(VkDeviceSize budget)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	m_budget = budget;
+}
+
+VkDeviceSize TextureManager::getBudget() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_budget;
+}
+
+}
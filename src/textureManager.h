@@ -0,0 +1,197 @@
+#pragma once
+
+#include "descriptor.h"
+#include "image.h"
+#include "samplerCache.h"
+#include "textureAtlas.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Texture that may still be loading. Reads as a 1x1 placeholder until its image is resident, so it can be bound right away.
+// Its levels are streamed, only the coarse ones are resident at first and finer ones follow as they are requested.
+// Images whose levels the GPU blits are resident in full right away and never streamed, the CPU only ever holds their level 0.
+// Only changes on the thread calling TextureManager::update().
+class Texture
+{
+public:
+	const Image& getImage() const { return m_pImage != nullptr ? *m_pImage : *m_pPlaceholder; }
+	bool isResident() const { return m_pImage != nullptr; }
+	// Element of the manager's bindless texture array to sample, the placeholder's until the texture is resident
+	uint32_t getIndex() const { return m_index; }
+
+	// Extent and levels of the full texture, 1x1 until it is decoded
+	uint32_t getWidth() const { return m_width; }
+	uint32_t getHeight() const { return m_height; }
+	uint32_t getLevelCount() const { return m_levelCount; }
+	// Finest level that is resident, getLevelCount() while none is
+	uint32_t getResidentLevel() const { return m_pImage != nullptr ? m_pImage->getFirstLevel() : m_levelCount; }
+
+	// Asks for the levels from level on to be resident, the finest level asked for between two updates counts.
+	// Call every frame the texture is drawn, levels nobody asks for are the first to go when over the budget.
+	void requestLevel(uint32_t level) { m_requestedLevel = std::min(m_requestedLevel, level); }
+
+private:
+	friend class TextureManager;
+
+	// Bytes of the levels from level on
+	VkDeviceSize getStreamedSize(uint32_t level) const { return m_levelSizes[level]; }
+
+	const Image* m_pPlaceholder = nullptr;
+	std::shared_ptr<Image> m_pImage;
+	uint32_t m_index = 0;
+
+	// all levels stay on the CPU to be streamed in again, KTX2 files only as their mapping. Null when not streamed.
+	std::shared_ptr<const ImageData> m_pData;
+	std::vector<VkDeviceSize> m_levelSizes;	// suffix sums of the level sizes
+	uint32_t m_width = 1;
+	uint32_t m_height = 1;
+	uint32_t m_levelCount = 1;
+	uint32_t m_minLevel = 0;	// coarsest level that may be resident, the tail below it always is
+
+	uint32_t m_requestedLevel = UINT32_MAX;
+	uint32_t m_unrequestedFrames = 0;
+	uint32_t m_targetLevel = 0;	// of the image resident or on its way
+};
+
+// Hands out one shared Texture per texture file, however many materials refer to it, and the samplers to read them with.
+// Files are decoded on the engine thread pool. Each update() records the uploads of the textures decoded since the last
+// one into the upload batch and submits them together without waiting, the textures become resident once that finished.
+// The manager keeps a reference of its own, so a released texture stays loaded for a few frames in case it is requested again.
+// update() then evicts it, by which time no frame still in flight can sample it.
+// Every resident texture also has an element in one bindless descriptor array, so a single descriptor set serves all materials.
+// Elements are only written while no submitted frame can read them, the array is never rebound.
+// Cooked KTX2 textures and ones downsampled on the CPU start with the levels up to STREAMING_TAIL_SIZE texels resident.
+// Each update() then fits the requested levels into the memory budget, coarsening the largest levels nobody asked for
+// recently first, and rebuilds the images whose levels changed. A rebuilt image gets a new array element, the old one
+// is released once no frame in flight reads it. Plain images with GPU blitted levels are uploaded whole instead.
+class TextureManager
+{
+public:
+	// upper bound of the bindless array, lowered to what the device supports
+	static constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+	static constexpr uint32_t PLACEHOLDER_INDEX = 0;
+	// largest side of the coarse levels that are resident right away and never streamed out
+	static constexpr uint32_t STREAMING_TAIL_SIZE = 128;
+	static constexpr VkDeviceSize DEFAULT_BUDGET = 256ull * 1024 * 1024;
+	// staging memory one update() may fill with streamed levels, the uploads of new textures come on top
+	static constexpr VkDeviceSize MAX_STREAMED_BYTES_PER_UPDATE = 32ull * 1024 * 1024;
+
+	TextureManager(Device& device, UploadBatch& uploadBatch);
+	~TextureManager();
+
+	TextureManager(const TextureManager&) = delete;
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	// Failed loads are reported on std::cerr and keep the placeholder
+	std::shared_ptr<Texture> load(const std::string& filepath);
+	// Texture of texels decoded by the caller, like atlas pages. Uploaded by the next update() and shared under name
+	// afterwards, names must not collide with file paths.
+	std::shared_ptr<Texture> create(const std::string& name, ImageData data);
+	// Creates the pages of a built atlas as name#0, name#1, ..., page i of the result backs the regions with page i.
+	// The texels move into the manager.
+	std::vector<std::shared_ptr<Texture>> createAtlasTextures(const std::string& name, TextureAtlas& atlas);
+	VkSampler getSampler(const SamplerDesc& desc = {}) { return m_samplerCache.get(desc); }
+
+	// Call once per frame on the thread that submits to the graphics queue, it never blocks on the GPU.
+	// Destroys textures nothing else has referenced for more than Device::MAX_FRAMES_IN_FLIGHT frames.
+	void update();
+	// Blocks until every texture requested so far is resident or has failed, as for a loading screen
+	void finishLoading();
+
+	uint32_t getTextureCount() const;
+	// Number of textures actually decoded and uploaded so far
+	uint32_t getLoadCount() const;
+	// Requested textures that are neither resident nor failed yet
+	uint32_t getPendingCount() const;
+	// Device memory held by all resident textures, including images waiting to be released after streaming
+	VkDeviceSize getResidentBytes() const;
+	// Bytes the levels requested in the last update() would take, before the budget was applied
+	VkDeviceSize getRequestedBytes() const;
+
+	// Streamed levels are kept within budget bytes as far as the resident tails allow
+	void setBudget(VkDeviceSize budget);
+	VkDeviceSize getBudget() const;
+	uint32_t getSamplerCount() const { return m_samplerCache.getSamplerCount(); }
+
+	// Set with the bindless array at binding 0, a variable count of combined image samplers using the default sampler
+	const DescriptorSetLayout& getDescriptorSetLayout() const { return m_descriptorSetLayout; }
+	VkDescriptorSet getDescriptorSet() const { return m_descriptorSet; }
+	uint32_t getDescriptorCount() const { return m_descriptorCount; }
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<Texture> pTexture;
+		uint32_t unusedFrames = 0;
+	};
+
+	struct DecodedTexture
+	{
+		std::shared_ptr<Texture> pTexture;
+		ImageData data;
+	};
+
+	struct UploadingTexture
+	{
+		std::shared_ptr<Texture> pTexture;
+		std::shared_ptr<Image> pImage;
+	};
+
+	// Replaced by a streamed image, kept until no frame in flight samples it
+	struct RetiredImage
+	{
+		std::shared_ptr<Image> pImage;
+		uint32_t index;
+		uint32_t frames = 0;
+	};
+
+	// Makes the textures of a finished submission resident or switches them to their streamed images
+	void completeUploads();
+	// Records and submits the uploads of every decoded texture and the streamed levels, unless a submission is still in flight
+	void submitUploads();
+	// Picks the level each texture should have resident and records the images of those that changed
+	void streamLevels();
+	void releaseRetiredImages();
+	void createDescriptorSet();
+	// Next free array element, the placeholder's when the array is full
+	uint32_t allocateIndex();
+	void writeDescriptor(uint32_t index, const Image& image);
+
+	Device& m_device;
+	UploadBatch& m_uploadBatch;
+	SamplerCache m_samplerCache;
+	std::unique_ptr<Image> m_pPlaceholder;
+
+	DescriptorSetLayout m_descriptorSetLayout;
+	DescriptorPool m_descriptorPool;
+	VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+	uint32_t m_descriptorCount = 0;
+	uint32_t m_nextIndex = PLACEHOLDER_INDEX + 1;
+	std::vector<uint32_t> m_freeIndices;	// of evicted textures and retired images, only touched by update()
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_decodesDone;
+	uint32_t m_runningDecodes = 0;
+	uint32_t m_pendingCount = 0;
+	uint32_t m_loadCount = 0;
+	std::unordered_map<std::string, Entry> m_textures;
+	std::vector<DecodedTexture> m_decoded;	// waiting for the next update to record their uploads
+
+	std::vector<UploadingTexture> m_uploading;	// in flight, only touched by update()
+	uint32_t m_uploadSubmission = 0;
+	std::vector<RetiredImage> m_retired;	// changed by update() only
+
+	VkDeviceSize m_budget = DEFAULT_BUDGET;
+	VkDeviceSize m_requestedBytes = 0;
+};
+
+}
@@ -0,0 +1,128 @@
+#include "threadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace VulkanEngine
+{
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	for(uint32_t i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	for(std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+ThreadPool& ThreadPool::get()
+{
+	// the calling thread joins parallelFor, so leave one hardware thread for it,
+	// but keep a worker on single core machines so submitted tasks still run
+	static ThreadPool pool{ std::max(2u, std::thread::hardware_concurrency()) - 1 };
+	return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		m_tasks.push(std::move(task));
+	}
+	m_condition.notify_one();
+}
+
+void ThreadPool::parallelFor(uint32_t count, const std::function<void(uint32_t)>& task)
+{
+	struct State
+	{
+		std::atomic<uint32_t> next{ 0 };
+		std::atomic<uint32_t> done{ 0 };
+		std::mutex mutex;
+		std::condition_variable finished;
+		std::exception_ptr exception;	// first one a task threw, guarded by mutex
+	};
+
+	// helpers may be dequeued after this call returned, so the state they touch is shared
+	auto pState = std::make_shared<State>();
+	const std::function<void(uint32_t)>* pTask = &task;
+
+	auto run = [pState, pTask, count]()
+	{
+		for(uint32_t i = pState->next++; i < count; i = pState->next++)
+		{
+			// an exception must not leave a worker, it is handed to the calling thread instead,
+			// and the remaining indices still count as done so the wait below ends
+			try
+			{
+				(*pTask)(i);
+			}
+			catch(...)
+			{
+				std::lock_guard<std::mutex> lock{ pState->mutex };
+				if(!pState->exception)
+				{
+					pState->exception = std::current_exception();
+				}
+			}
+
+			if(++pState->done == count)
+			{
+				std::lock_guard<std::mutex> lock{ pState->mutex };
+				pState->finished.notify_all();
+			}
+		}
+	};
+
+	uint32_t helperCount = std::min(getThreadCount(), count > 0 ? count - 1 : 0);
+	for(uint32_t i = 0; i < helperCount; i++)
+	{
+		submit(run);
+	}
+
+	run();
+
+	std::unique_lock<std::mutex> lock{ pState->mutex };
+	pState->finished.wait(lock, [&]() { return pState->done == count; });
+
+	if(pState->exception)
+	{
+		std::rethrow_exception(pState->exception);
+	}
+}
+
+void ThreadPool::workerLoop()
+{
+	while(true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_condition.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+			if(m_stopping && m_tasks.empty())
+			{
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop();
+		}
+		task();
+	}
+}
+
+}
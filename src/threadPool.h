@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+class ThreadPool
+{
+public:
+	ThreadPool(uint32_t threadCount);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Pool shared by engine systems, sized to the hardware thread count
+	static ThreadPool& get();
+
+	void submit(std::function<void()> task);
+
+	// Runs task(i) for every i in [0, count) and returns once all of them finished.
+	// The calling thread takes part, so this is safe to call from inside a pool task.
+	// When tasks throw, the other indices still run and the first exception is rethrown here.
+	void parallelFor(uint32_t count, const std::function<void(uint32_t)>& task);
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread> m_threads;
+	std::queue<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	bool m_stopping = false;
+};
+
+}
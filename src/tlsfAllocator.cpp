@@ -0,0 +1,272 @@
+#include "tlsfAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace VulkanEngine
+{
+
+// index of the highest set bit, value must not be 0
+static uint32_t findHighestBit(uint64_t value)
+{
+	uint32_t bit = 0;
+	for(uint32_t shift = 32; shift > 0; shift >>= 1)
+	{
+		if(value >> shift)
+		{
+			value >>= shift;
+			bit += shift;
+		}
+	}
+	return bit;
+}
+
+static uint32_t findLowestBit(uint64_t value)
+{
+	return findHighestBit(value & (~value + 1));
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity) : m_capacity(capacity)
+{
+	for(auto& lists : m_freeLists)
+	{
+		std::fill(std::begin(lists), std::end(lists), NO_BLOCK);
+	}
+
+	if(capacity > 0)
+	{
+		uint32_t block = createBlock();
+		m_blocks[block].size = capacity;
+		insertFreeBlock(block);
+	}
+}
+
+uint64_t TlsfAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+	assert(size > 0 && alignment > 0 && (alignment & (alignment - 1)) == 0 && "Range size must be positive and alignment a power of two");
+
+	if(size > m_capacity - m_usedSize || alignment - 1 > m_capacity - size)
+	{
+		return INVALID_OFFSET;
+	}
+
+	// any block that fits size plus the worst case padding in front fits the aligned range
+	uint32_t block = findFreeBlock(size + alignment - 1);
+	if(block == NO_BLOCK)
+	{
+		return INVALID_OFFSET;
+	}
+	removeFreeBlock(block);
+
+	// the padding stays free, its physical neighbours are used so it never merges into an allocated range
+	uint64_t offset = (m_blocks[block].offset + alignment - 1) & ~(alignment - 1);
+	uint64_t padding = offset - m_blocks[block].offset;
+	if(padding > 0)
+	{
+		uint32_t aligned = splitBlock(block, padding);
+		insertFreeBlock(block);
+		block = aligned;
+	}
+
+	if(m_blocks[block].size > size)
+	{
+		insertFreeBlock(splitBlock(block, size));
+	}
+
+	m_usedBlocks[offset] = block;
+	m_usedSize += size;
+	return offset;
+}
+
+void TlsfAllocator::free(uint64_t offset)
+{
+	auto it = m_usedBlocks.find(offset);
+	assert(it != m_usedBlocks.end() && "Freed range was not allocated");
+
+	uint32_t block = it->second;
+	m_usedBlocks.erase(it);
+	m_usedSize -= m_blocks[block].size;
+
+	uint32_t previous = m_blocks[block].previousPhysical;
+	if(previous != NO_BLOCK && m_blocks[previous].free)
+	{
+		removeFreeBlock(previous);
+		mergeBlocks(previous, block);
+		block = previous;
+	}
+
+	uint32_t next = m_blocks[block].nextPhysical;
+	if(next != NO_BLOCK && m_blocks[next].free)
+	{
+		removeFreeBlock(next);
+		mergeBlocks(block, next);
+	}
+
+	insertFreeBlock(block);
+}
+
+uint64_t TlsfAllocator::getLargestFreeRange() const
+{
+	if(m_firstLevelMap == 0)
+	{
+		return 0;
+	}
+
+	// the largest range is in the highest non-empty list, which is not sorted
+	uint32_t firstLevel = findHighestBit(m_firstLevelMap);
+	uint32_t secondLevel = findHighestBit(m_secondLevelMaps[firstLevel]);
+
+	uint64_t largest = 0;
+	for(uint32_t block = m_freeLists[firstLevel][secondLevel]; block != NO_BLOCK; block = m_blocks[block].nextFree)
+	{
+		largest = std::max(largest, m_blocks[block].size);
+	}
+	return largest;
+}
+
+void TlsfAllocator::getSizeClass(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+	if(size < SMALL_SIZE)
+	{
+		firstLevel = 0;
+		secondLevel = static_cast<uint32_t>(size >> (SMALL_SIZE_BITS - SECOND_LEVEL_BITS));
+		return;
+	}
+
+	uint32_t highestBit = findHighestBit(size);
+	firstLevel = highestBit - SMALL_SIZE_BITS + 1;
+	secondLevel = static_cast<uint32_t>(size >> (highestBit - SECOND_LEVEL_BITS)) - SECOND_LEVEL_COUNT;
+}
+
+uint32_t TlsfAllocator::findFreeBlock(uint64_t size) const
+{
+	// rounded up to the next size class, so every block of the class found is large enough
+	uint64_t classWidth = size < SMALL_SIZE ? SMALL_SIZE >> SECOND_LEVEL_BITS : 1ull << (findHighestBit(size) - SECOND_LEVEL_BITS);
+	if(size > ~0ull - classWidth)
+	{
+		return NO_BLOCK;
+	}
+	size = (size + classWidth - 1) & ~(classWidth - 1);
+
+	uint32_t firstLevel, secondLevel;
+	getSizeClass(size, firstLevel, secondLevel);
+
+	uint32_t secondLevelMap = m_secondLevelMaps[firstLevel] & (~0u << secondLevel);
+	if(secondLevelMap == 0)
+	{
+		uint64_t firstLevelMap = firstLevel + 1 < 64 ? m_firstLevelMap & (~0ull << (firstLevel + 1)) : 0;
+		if(firstLevelMap == 0)
+		{
+			return NO_BLOCK;
+		}
+		firstLevel = findLowestBit(firstLevelMap);
+		secondLevelMap = m_secondLevelMaps[firstLevel];
+	}
+
+	return m_freeLists[firstLevel][findLowestBit(secondLevelMap)];
+}
+
+void TlsfAllocator::insertFreeBlock(uint32_t block)
+{
+	uint32_t firstLevel, secondLevel;
+	getSizeClass(m_blocks[block].size, firstLevel, secondLevel);
+
+	uint32_t head = m_freeLists[firstLevel][secondLevel];
+	m_blocks[block].free = true;
+	m_blocks[block].previousFree = NO_BLOCK;
+	m_blocks[block].nextFree = head;
+	if(head != NO_BLOCK)
+	{
+		m_blocks[head].previousFree = block;
+	}
+
+	m_freeLists[firstLevel][secondLevel] = block;
+	m_secondLevelMaps[firstLevel] |= 1u << secondLevel;
+	m_firstLevelMap |= 1ull << firstLevel;
+	m_freeRangeCount++;
+}
+
+void TlsfAllocator::removeFreeBlock(uint32_t block)
+{
+	uint32_t firstLevel, secondLevel;
+	getSizeClass(m_blocks[block].size, firstLevel, secondLevel);
+
+	uint32_t previous = m_blocks[block].previousFree;
+	uint32_t next = m_blocks[block].nextFree;
+	if(previous != NO_BLOCK)
+	{
+		m_blocks[previous].nextFree = next;
+	}
+	else
+	{
+		m_freeLists[firstLevel][secondLevel] = next;
+	}
+	if(next != NO_BLOCK)
+	{
+		m_blocks[next].previousFree = previous;
+	}
+
+	if(m_freeLists[firstLevel][secondLevel] == NO_BLOCK)
+	{
+		m_secondLevelMaps[firstLevel] &= ~(1u << secondLevel);
+		if(m_secondLevelMaps[firstLevel] == 0)
+		{
+			m_firstLevelMap &= ~(1ull << firstLevel);
+		}
+	}
+
+	m_blocks[block].free = false;
+	m_freeRangeCount--;
+}
+
+uint32_t TlsfAllocator::splitBlock(uint32_t block, uint64_t size)
+{
+	uint32_t rest = createBlock();
+	Block& original = m_blocks[block];
+	Block& remainder = m_blocks[rest];
+
+	remainder.offset = original.offset + size;
+	remainder.size = original.size - size;
+	remainder.previousPhysical = block;
+	remainder.nextPhysical = original.nextPhysical;
+	if(original.nextPhysical != NO_BLOCK)
+	{
+		m_blocks[original.nextPhysical].previousPhysical = rest;
+	}
+
+	original.size = size;
+	original.nextPhysical = rest;
+	return rest;
+}
+
+void TlsfAllocator::mergeBlocks(uint32_t previous, uint32_t block)
+{
+	m_blocks[previous].size += m_blocks[block].size;
+	m_blocks[previous].nextPhysical = m_blocks[block].nextPhysical;
+	if(m_blocks[block].nextPhysical != NO_BLOCK)
+	{
+		m_blocks[m_blocks[block].nextPhysical].previousPhysical = previous;
+	}
+	releaseBlock(block);
+}
+
+uint32_t TlsfAllocator::createBlock()
+{
+	if(!m_unusedBlocks.empty())
+	{
+		uint32_t block = m_unusedBlocks.back();
+		m_unusedBlocks.pop_back();
+		m_blocks[block] = {};
+		return block;
+	}
+
+	m_blocks.emplace_back();
+	return static_cast<uint32_t>(m_blocks.size() - 1);
+}
+
+void TlsfAllocator::releaseBlock(uint32_t block)
+{
+	m_unusedBlocks.push_back(block);
+}
+
+}
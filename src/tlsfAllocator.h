@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Pure CPU two level segregated fit allocator handing out ranges of a fixed size address space, independent of any GPU state.
+// Free ranges are kept in lists by size class, found through two bitmaps, so allocating and freeing take constant time
+// however fragmented the space gets. Freed ranges are merged with their free neighbours.
+class TlsfAllocator
+{
+public:
+	static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+	TlsfAllocator(uint64_t capacity);
+
+	TlsfAllocator(const TlsfAllocator&) = delete;
+	TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+	// Returns the offset of a free range of size bytes starting at a multiple of alignment, or INVALID_OFFSET when none is found.
+	// Alignment has to be a power of two. A range is only taken from a size class that is sure to fit it with its alignment,
+	// so allocation can fail while a range that would fit by chance is left.
+	uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+	// Takes back a range returned by allocate
+	void free(uint64_t offset);
+
+	uint64_t getCapacity() const { return m_capacity; }
+	uint64_t getUsedSize() const { return m_usedSize; }
+	uint64_t getFreeSize() const { return m_capacity - m_usedSize; }
+	uint32_t getAllocationCount() const { return static_cast<uint32_t>(m_usedBlocks.size()); }
+	uint32_t getFreeRangeCount() const { return m_freeRangeCount; }
+	uint64_t getLargestFreeRange() const;
+	bool isEmpty() const { return m_usedBlocks.empty(); }
+
+private:
+	static constexpr uint32_t SECOND_LEVEL_BITS = 5;
+	static constexpr uint32_t SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_BITS;
+	// ranges below SMALL_SIZE share the first class, split into lists of equal width
+	static constexpr uint32_t SMALL_SIZE_BITS = 8;
+	static constexpr uint64_t SMALL_SIZE = 1ull << SMALL_SIZE_BITS;
+	static constexpr uint32_t FIRST_LEVEL_COUNT = 64 - SMALL_SIZE_BITS + 1;
+	static constexpr uint32_t NO_BLOCK = ~0u;
+
+	// ranges are blocks of one list through the address space and, when free, of one free list of their size class
+	struct Block
+	{
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t previousPhysical = NO_BLOCK;
+		uint32_t nextPhysical = NO_BLOCK;
+		uint32_t previousFree = NO_BLOCK;
+		uint32_t nextFree = NO_BLOCK;
+		bool free = false;
+	};
+
+	static void getSizeClass(uint64_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+
+	uint32_t findFreeBlock(uint64_t size) const;
+	void insertFreeBlock(uint32_t block);
+	void removeFreeBlock(uint32_t block);
+	// shrinks a block to size bytes and returns a new block for the rest, which is left out of the free lists
+	uint32_t splitBlock(uint32_t block, uint64_t size);
+	// folds block into its physical predecessor, which survives
+	void mergeBlocks(uint32_t previous, uint32_t block);
+
+	uint32_t createBlock();
+	void releaseBlock(uint32_t block);
+
+	uint64_t m_capacity;
+	uint64_t m_usedSize = 0;
+	uint32_t m_freeRangeCount = 0;
+
+	uint64_t m_firstLevelMap = 0;
+	uint32_t m_secondLevelMaps[FIRST_LEVEL_COUNT]{};
+	uint32_t m_freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+
+	std::vector<Block> m_blocks;
+	std::vector<uint32_t> m_unusedBlocks;
+	std::unordered_map<uint64_t, uint32_t> m_usedBlocks;	// offset to block
+};
+
+}
@@ -0,0 +1,69 @@
+#include "uniformRing.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+UniformRing::UniformRing(Device& device, VkDeviceSize frameCapacity) :
+	m_device(device), m_descriptorSetLayout(device), m_descriptorPool(device)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.getPhysicalDevice(), &properties);
+	m_alignment = properties.limits.minUniformBufferOffsetAlignment;
+
+	// every frame starts aligned, the range bound at the last offset of the last frame reaches into the tail
+	m_frameCapacity = (frameCapacity + m_alignment - 1) / m_alignment * m_alignment;
+	VkDeviceSize bufferSize = m_frameCapacity * Device::MAX_FRAMES_IN_FLIGHT + MAX_UNIFORM_SIZE;
+	m_pBuffer = std::make_unique<Buffer>(device, bufferSize, 1, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+	if(m_pBuffer->map() != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to map uniform ring buffer!");
+	}
+
+	m_descriptorSetLayout.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL_GRAPHICS);
+	m_descriptorSetLayout.build();
+
+	m_descriptorPool.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1);
+	m_descriptorPool.setMaxSets(1);
+	m_descriptorPool.build();
+
+	VkDescriptorBufferInfo bufferInfo = m_pBuffer->getBufferInfo(MAX_UNIFORM_SIZE, 0);
+	std::vector<DescriptorDesc> descriptorDescs(1);
+	descriptorDescs[0].binding = 0;
+	descriptorDescs[0].pBufferInfo = &bufferInfo;
+	m_descriptorPool.allocateDescriptorSet(m_descriptorSetLayout, descriptorDescs, m_descriptorSet);
+}
+
+void UniformRing::beginFrame(int frameIndex)
+{
+	m_frameStart = static_cast<VkDeviceSize>(frameIndex) * m_frameCapacity;
+	m_head = m_frameStart;
+	m_flushed = m_frameStart;
+}
+
+uint32_t UniformRing::push(const void* pData, VkDeviceSize size)
+{
+	VkDeviceSize offset = (m_head + m_alignment - 1) / m_alignment * m_alignment;
+	if(size > MAX_UNIFORM_SIZE || offset + size > m_frameStart + m_frameCapacity)
+	{
+		throw std::runtime_error("uniform ring frame is out of space!");
+	}
+
+	std::memcpy(static_cast<char*>(m_pBuffer->getMappedMemory()) + offset, pData, size);
+	m_head = offset + size;
+	return static_cast<uint32_t>(offset);
+}
+
+void UniformRing::flush()
+{
+	// only the bytes written since the last flush, the buffer rounds them out to whole atoms
+	if(m_head > m_flushed)
+	{
+		m_pBuffer->flush(m_head - m_flushed, m_flushed);
+		m_flushed = m_head;
+	}
+}
+
+}
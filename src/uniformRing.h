@@ -0,0 +1,67 @@
+#pragma once
+
+#include "device.h"
+#include "buffer.h"
+#include "descriptor.h"
+
+#include <memory>
+
+namespace VulkanEngine
+{
+
+// Persistently mapped uniform buffer shared by all render passes, split into one part per frame in flight.
+// Passes bump-allocate their uniforms from the part of the current frame and bind them through the one
+// VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC descriptor of the ring at the dynamic offset push returned,
+// so uniforms need neither buffers nor descriptor sets of their own and per-draw data costs one copy.
+class UniformRing
+{
+public:
+	// every offset binds this range, it is the smallest maxUniformBufferRange devices may report
+	static constexpr VkDeviceSize MAX_UNIFORM_SIZE = 16384;
+	static constexpr VkDeviceSize DEFAULT_FRAME_CAPACITY = 256 * 1024;
+
+	UniformRing(Device& device, VkDeviceSize frameCapacity = DEFAULT_FRAME_CAPACITY);
+
+	UniformRing(const UniformRing&) = delete;
+	UniformRing& operator=(const UniformRing&) = delete;
+
+	// Starts over on the part of frameIndex, whose last submission the device has waited for in beginFrame
+	void beginFrame(int frameIndex);
+	// Copies size bytes into the current frame and returns the dynamic offset to bind them at.
+	// Throws when the frame is out of space.
+	uint32_t push(const void* pData, VkDeviceSize size);
+	template<typename T>
+	uint32_t push(const T& data)
+	{
+		static_assert(sizeof(T) <= MAX_UNIFORM_SIZE, "Uniform data does not fit the range of the dynamic descriptor");
+		return push(&data, sizeof(T));
+	}
+	// Makes what was pushed this frame visible to the device, call it before the frame is submitted
+	void flush();
+
+	// binding 0 is the dynamic uniform buffer, visible to all graphics stages
+	const DescriptorSetLayout& getDescriptorSetLayout() const { return m_descriptorSetLayout; }
+	VkDescriptorSet getDescriptorSet() const { return m_descriptorSet; }
+
+	VkDeviceSize getFrameCapacity() const { return m_frameCapacity; }
+	// bytes pushed in the current frame, including alignment
+	VkDeviceSize getFrameUsage() const { return m_head - m_frameStart; }
+
+private:
+	Device& m_device;
+
+	VkDeviceSize m_frameCapacity;
+	VkDeviceSize m_alignment;
+	std::unique_ptr<Buffer> m_pBuffer;
+
+	VkDeviceSize m_frameStart = 0;
+	VkDeviceSize m_head = 0;
+	// start of what has not been flushed yet
+	VkDeviceSize m_flushed = 0;
+
+	DescriptorSetLayout m_descriptorSetLayout;
+	DescriptorPool m_descriptorPool;
+	VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+};
+
+}
@@ -0,0 +1,395 @@
+#include "uploadBatch.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VulkanEngine
+{
+
+// covers the texel and block sizes image copies require their buffer offset to be a multiple of
+static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+UploadBatch::UploadBatch(Device& device, VkDeviceSize stagingCapacity) : m_device(device)
+{
+	m_stagingBuffer = std::make_unique<Buffer>(m_device, stagingCapacity, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	m_stagingBuffer->map();
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = m_device.getCommandPool();
+	allocInfo.commandBufferCount = 1;
+
+	if(vkAllocateCommandBuffers(m_device.getDevice(), &allocInfo, &m_commandBuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate upload command buffer!");
+	}
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	if(vkCreateFence(m_device.getDevice(), &fenceInfo, nullptr, &m_fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create upload fence!");
+	}
+}
+
+UploadBatch::~UploadBatch()
+{
+	flush();
+
+	vkDestroyFence(m_device.getDevice(), m_fence, nullptr);
+	vkFreeCommandBuffers(m_device.getDevice(), m_device.getCommandPool(), 1, &m_commandBuffer);
+}
+
+void UploadBatch::copyToBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	VkBufferCopy copyRegion{};
+	copyRegion.dstOffset = dstOffset;
+	copyRegion.size = size;
+	VkBuffer srcBuffer = stage(data, size, copyRegion.srcOffset);
+
+	vkCmdCopyBuffer(getCommandBuffer(), srcBuffer, dstBuffer, 1, &copyRegion);
+}
+
+void UploadBatch::copyToImage(const void* data, VkDeviceSize size, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount, uint32_t mipLevel)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+
+	VkBufferImageCopy region{};
+	VkBuffer srcBuffer = stage(data, size, region.bufferOffset);
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = mipLevel;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = layerCount;
+
+	region.imageOffset = { 0, 0, 0 };
+	region.imageExtent = { width, height, 1 };
+
+	vkCmdCopyBufferToImage(getCommandBuffer(), srcBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+}
+
+void UploadBatch::transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	VkPipelineStageFlags srcStageMask;
+	VkPipelineStageFlags dstStageMask;
+
+	if(oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+	{
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+		srcStageMask = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+		dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	}
+	else if(oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+	{
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+		dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	}
+	else
+	{
+		throw std::invalid_argument("unsupported layout transition!");
+	}
+
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	vkCmdPipelineBarrier(getCommandBuffer(), srcStageMask, dstStageMask, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void UploadBatch::generateMipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	VkCommandBuffer commandBuffer = getCommandBuffer();
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	int32_t mipWidth = static_cast<int32_t>(width);
+	int32_t mipHeight = static_cast<int32_t>(height);
+
+	for(uint32_t level = 1; level < mipLevels; level++)
+	{
+		// the level above becomes the blit source once its own writes are done
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		int32_t nextWidth = std::max(1, mipWidth / 2);
+		int32_t nextHeight = std::max(1, mipHeight / 2);
+
+		VkImageBlit blit{};
+		blit.srcOffsets[0] = { 0, 0, 0 };
+		blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[0] = { 0, 0, 0 };
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+		vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		mipWidth = nextWidth;
+		mipHeight = nextHeight;
+	}
+
+	// the last level is only ever written
+	barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void UploadBatch::flush()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	if(m_recording)
+	{
+		submit();
+	}
+	waitForSubmission();
+}
+
+uint32_t UploadBatch::submitAsync()
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	if(m_recording)
+	{
+		submit(false);
+	}
+	return m_submitCount;
+}
+
+bool UploadBatch::isComplete(uint32_t submission)
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	if(submission > m_completedCount && m_inFlight && vkGetFenceStatus(m_device.getDevice(), m_fence) == VK_SUCCESS)
+	{
+		waitForSubmission();
+	}
+	return submission <= m_completedCount;
+}
+
+uint32_t UploadBatch::getSubmitCount() const
+{
+	std::lock_guard<std::mutex> lock{ m_mutex };
+	return m_submitCount;
+}
+
+UploadBatch::StagingAllocation UploadBatch::allocateStaging(VkDeviceSize size)
+{
+	StagingAllocation allocation{};
+	allocation.size = size;
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		if(allocateStagingRange(size, 0, allocation.offset))
+		{
+			allocation.buffer = m_stagingBuffer->getBuffer();
+			allocation.pMapped = static_cast<char*>(m_stagingBuffer->getMappedMemory()) + allocation.offset;
+			return allocation;
+		}
+	}
+
+	allocation.offset = 0;
+	allocation.pBuffer = std::make_unique<Buffer>(m_device, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	allocation.pBuffer->map();
+	allocation.buffer = allocation.pBuffer->getBuffer();
+	allocation.pMapped = allocation.pBuffer->getMappedMemory();
+	return allocation;
+}
+
+void UploadBatch::freeStaging(StagingAllocation& allocation)
+{
+	if(allocation.buffer != VK_NULL_HANDLE && !allocation.pBuffer)
+	{
+		std::lock_guard<std::mutex> lock{ m_mutex };
+		for(StagingRange& range : m_stagingRanges)
+		{
+			if(range.submission == 0 && range.offset == allocation.offset)
+			{
+				range.freed = true;
+				break;
+			}
+		}
+		releaseStagingRanges();
+	}
+
+	allocation = {};
+}
+
+VkBuffer UploadBatch::stage(const void* data, VkDeviceSize size, VkDeviceSize& offset)
+{
+	waitForSubmission();
+
+	bool staged = allocateStagingRange(size, m_submitCount + 1, offset);
+	if(!staged && m_recording && size <= m_stagingBuffer->getBufferSize())
+	{
+		// the copies already recorded hold the ring, so they have to finish before it is reused
+		submit();
+		staged = allocateStagingRange(size, m_submitCount + 1, offset);
+	}
+
+	if(!staged)
+	{
+		// too large for the ring or it is held by allocations, gets a buffer of its own that lives until the batch is submitted
+		auto pBuffer = std::make_unique<Buffer>(m_device, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		pBuffer->map();
+		pBuffer->writeToBuffer(const_cast<void*>(data), size);
+		pBuffer->unmap();
+
+		offset = 0;
+		m_dedicatedBuffers.push_back(std::move(pBuffer));
+		return m_dedicatedBuffers.back()->getBuffer();
+	}
+
+	m_stagingBuffer->writeToBuffer(const_cast<void*>(data), size, offset);
+	return m_stagingBuffer->getBuffer();
+}
+
+bool UploadBatch::allocateStagingRange(VkDeviceSize size, uint32_t submission, VkDeviceSize& offset)
+{
+	VkDeviceSize capacity = m_stagingBuffer->getBufferSize();
+	if(m_stagingRanges.empty())
+	{
+		m_stagingHead = 0;
+	}
+
+	offset = (m_stagingHead + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+	VkDeviceSize limit = capacity;
+	if(!m_stagingRanges.empty())
+	{
+		VkDeviceSize tail = m_stagingRanges.front().offset;
+		if(m_stagingHead <= tail)
+		{
+			// already wrapped around, the oldest range is straight ahead
+			limit = tail;
+		}
+		else if(offset + size > capacity)
+		{
+			offset = 0;
+			limit = tail;
+		}
+	}
+
+	if(size == 0 || offset + size > limit)
+	{
+		return false;
+	}
+
+	m_stagingRanges.push_back({ offset, offset + size, submission, false });
+	m_stagingHead = offset + size;
+	return true;
+}
+
+void UploadBatch::releaseStagingRanges()
+{
+	while(!m_stagingRanges.empty())
+	{
+		const StagingRange& range = m_stagingRanges.front();
+		if(range.submission == 0 ? !range.freed : range.submission > m_completedCount)
+		{
+			break;
+		}
+		m_stagingRanges.pop_front();
+	}
+}
+
+VkCommandBuffer UploadBatch::getCommandBuffer()
+{
+	if(!m_recording)
+	{
+		waitForSubmission();
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		// the pool allows resetting single buffers, beginning again resets it implicitly
+		vkBeginCommandBuffer(m_commandBuffer, &beginInfo);
+		m_recording = true;
+	}
+	return m_commandBuffer;
+}
+
+void UploadBatch::submit(bool wait)
+{
+	vkEndCommandBuffer(m_commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &m_commandBuffer;
+
+	if(vkQueueSubmit(m_device.getGraphicsQueue(), 1, &submitInfo, m_fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to submit upload batch!");
+	}
+	m_submitCount++;
+	m_recording = false;
+	m_inFlight = true;
+
+	if(wait)
+	{
+		waitForSubmission();
+	}
+}
+
+void UploadBatch::waitForSubmission()
+{
+	if(!m_inFlight)
+	{
+		return;
+	}
+
+	vkWaitForFences(m_device.getDevice(), 1, &m_fence, VK_TRUE, UINT64_MAX);
+	vkResetFences(m_device.getDevice(), 1, &m_fence);
+
+	m_inFlight = false;
+	m_completedCount = m_submitCount;
+	releaseStagingRanges();
+	m_dedicatedBuffers.clear();
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "device.h"
+#include "buffer.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Collects buffer copies, image copies and layout transitions into one command buffer, so any number of uploads
+// costs a single submit and fence wait instead of a queue round trip each.
+// Source data is copied into a persistent staging ring right away, so callers may release it once a call returns.
+// The recorded work executes on flush() or submitAsync(), or earlier when the staging ring runs full, and destinations
+// must not be read by the GPU before that. Recording is thread-safe, flushing submits to the graphics queue.
+// Data that does not fit the ring gets a temporary staging buffer, freed with the submission that copies it.
+class UploadBatch
+{
+public:
+	static constexpr VkDeviceSize DEFAULT_STAGING_CAPACITY = 32 * 1024 * 1024;
+
+	// Staging memory handed out ahead of recording, for copies the caller records into command buffers of its own
+	struct StagingAllocation
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+		void* pMapped = nullptr;	// at offset, host coherent
+		std::unique_ptr<Buffer> pBuffer;	// set when the ring had no room
+	};
+
+	UploadBatch(Device& device, VkDeviceSize stagingCapacity = DEFAULT_STAGING_CAPACITY);
+	~UploadBatch();
+
+	UploadBatch(const UploadBatch&) = delete;
+	UploadBatch& operator=(const UploadBatch&) = delete;
+
+	void copyToBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+	// The level has to be in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, data holds its tightly packed texels and width and height are its extent
+	void copyToImage(const void* data, VkDeviceSize size, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount, uint32_t mipLevel = 0);
+	// Transitions the first mipLevels levels together
+	void transitionImageLayout(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+	// Fills levels 1 to mipLevels - 1 by blitting each level from the one above with linear filtering. Expects all
+	// levels in VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL with level 0 written and leaves them shader readable.
+	// The format has to support linear blits.
+	void generateMipmaps(VkImage image, uint32_t width, uint32_t height, uint32_t mipLevels);
+
+	// Takes size bytes of the ring, or a temporary buffer when they do not fit, without ever submitting or waiting,
+	// so it is safe on threads that must not touch the queue. The range is held until freeStaging().
+	StagingAllocation allocateStaging(VkDeviceSize size);
+	// The GPU has to be done reading the allocation
+	void freeStaging(StagingAllocation& allocation);
+
+	// Submits everything recorded so far and waits for it, as well as for an earlier asynchronous submission
+	void flush();
+	// Submits everything recorded so far without waiting and returns the submission to poll with isComplete().
+	// Recording waits for it to finish before reusing the command buffer and staging memory.
+	// Returns the latest submission when nothing was recorded.
+	uint32_t submitAsync();
+	bool isComplete(uint32_t submission);
+
+	// Submissions so far, each one waited on with a single fence wait
+	uint32_t getSubmitCount() const;
+
+private:
+	// Ranges are handed out in ring order and released from the oldest one on, so a held range keeps the ones after it
+	struct StagingRange
+	{
+		VkDeviceSize offset;
+		VkDeviceSize end;
+		uint32_t submission;	// the one copying it, 0 for allocations held until freeStaging()
+		bool freed;
+	};
+
+	// Copies data into staging memory, submitting first when it does not fit. Returns the buffer to copy from.
+	VkBuffer stage(const void* data, VkDeviceSize size, VkDeviceSize& offset);
+	// Takes the next size bytes of the ring, false when the free part in front of the oldest range is too short
+	bool allocateStagingRange(VkDeviceSize size, uint32_t submission, VkDeviceSize& offset);
+	// Drops the ranges at the tail of the ring that are freed or whose submission completed
+	void releaseStagingRanges();
+	// Begins recording on the first use after a submit
+	VkCommandBuffer getCommandBuffer();
+	void submit(bool wait = true);
+	// Waits for the submission in flight, if any, and releases its staging memory
+	void waitForSubmission();
+
+	Device& m_device;
+
+	std::unique_ptr<Buffer> m_stagingBuffer;
+	VkDeviceSize m_stagingHead = 0;
+	std::deque<StagingRange> m_stagingRanges;	// oldest first
+	std::vector<std::unique_ptr<Buffer>> m_dedicatedBuffers;	// uploads that did not fit the ring, freed on submit
+
+	VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+	VkFence m_fence = VK_NULL_HANDLE;
+	bool m_recording = false;
+	bool m_inFlight = false;
+	uint32_t m_submitCount = 0;
+	uint32_t m_completedCount = 0;
+
+	mutable std::mutex m_mutex;
+};
+
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+
 namespace VulkanEngine
 {
 
@@ -10,4 +13,38 @@ void hashCombine(std::size_t& seed, const T& v, const Rest&... rest)
 	(hashCombine(seed, rest), ...);
 };
 
-}
\ No newline at end of file
+// Fast non-cryptographic hash over raw bytes, consumes 8 bytes per step
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0x9e3779b97f4a7c15ull)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = seed ^ (size * 0xff51afd7ed558ccdull);
+
+	auto mix = [&hash](uint64_t word)
+	{
+		word *= 0xbf58476d1ce4e5b9ull;
+		word ^= word >> 31;
+		hash = (hash ^ word) * 0x94d049bb133111ebull;
+		hash = (hash << 27) | (hash >> 37);
+	};
+
+	for(; size >= 8; size -= 8, bytes += 8)
+	{
+		uint64_t word;
+		memcpy(&word, bytes, 8);
+		mix(word);
+	}
+
+	if(size > 0)
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		mix(word);
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdull;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+}
@@ -0,0 +1,117 @@
+#include "vertexQuantization.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace VulkanEngine
+{
+
+static float signNotZero(float value)
+{
+	return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+glm::vec2 octahedralEncode(const glm::vec3& normal)
+{
+	float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+	if(l1 == 0.0f)
+	{
+		return glm::vec2{ 0.0f, 0.0f };
+	}
+
+	glm::vec2 encoded{ normal.x / l1, normal.y / l1 };
+	if(normal.z < 0.0f)
+	{
+		encoded = glm::vec2{ (1.0f - std::abs(encoded.y)) * signNotZero(encoded.x), (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y) };
+	}
+	return encoded;
+}
+
+glm::vec3 octahedralDecode(const glm::vec2& encoded)
+{
+	glm::vec3 normal{ encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+	if(normal.z < 0.0f)
+	{
+		normal.x = (1.0f - std::abs(encoded.y)) * signNotZero(encoded.x);
+		normal.y = (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y);
+	}
+	return glm::normalize(normal);
+}
+
+int16_t packSnorm16(float value)
+{
+	return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float unpackSnorm16(int16_t value)
+{
+	return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+QuantizationError quantizeVertices(const Model::Vertex* vertices, uint32_t vertexCount, std::vector<Model::CompactVertex>& compactVertices, glm::mat4& dequantizeMatrix)
+{
+	QuantizationError error{};
+	compactVertices.resize(vertexCount);
+
+	glm::vec3 minimum{ std::numeric_limits<float>::max() };
+	glm::vec3 maximum{ -std::numeric_limits<float>::max() };
+	for(uint32_t v = 0; v < vertexCount; v++)
+	{
+		minimum = glm::min(minimum, vertices[v].position);
+		maximum = glm::max(maximum, vertices[v].position);
+	}
+
+	glm::vec3 center = vertexCount > 0 ? (minimum + maximum) * 0.5f : glm::vec3{ 0.0f };
+	glm::vec3 extent = vertexCount > 0 ? glm::max((maximum - minimum) * 0.5f, glm::vec3{ 1e-20f }) : glm::vec3{ 1.0f };
+
+	dequantizeMatrix = glm::mat4{
+		{ extent.x, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, extent.y, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, extent.z, 0.0f },
+		{ center.x, center.y, center.z, 1.0f } };
+
+	for(uint32_t v = 0; v < vertexCount; v++)
+	{
+		const Model::Vertex& vertex = vertices[v];
+		Model::CompactVertex& compact = compactVertices[v];
+
+		glm::vec3 decodedPosition{};
+		for(int k = 0; k < 3; k++)
+		{
+			compact.position[k] = packSnorm16((vertex.position[k] - center[k]) / extent[k]);
+			decodedPosition[k] = center[k] + unpackSnorm16(compact.position[k]) * extent[k];
+		}
+		compact.position[3] = 0;
+		error.maxPositionError = std::max(error.maxPositionError, glm::length(decodedPosition - vertex.position));
+
+		for(int k = 0; k < 3; k++)
+		{
+			compact.color[k] = static_cast<uint8_t>(std::round(std::clamp(vertex.color[k], 0.0f, 1.0f) * 255.0f));
+		}
+		compact.color[3] = 255;
+
+		glm::vec2 encoded = octahedralEncode(vertex.normal);
+		compact.normal[0] = packSnorm16(encoded.x);
+		compact.normal[1] = packSnorm16(encoded.y);
+
+		// meshes without normals store zero vectors, there is nothing to compare against
+		float normalLength = glm::length(vertex.normal);
+		if(normalLength > 0.0f)
+		{
+			glm::vec3 decodedNormal = octahedralDecode(glm::vec2{ unpackSnorm16(compact.normal[0]), unpackSnorm16(compact.normal[1]) });
+			float cosine = std::clamp(glm::dot(decodedNormal, vertex.normal / normalLength), -1.0f, 1.0f);
+			error.maxNormalError = std::max(error.maxNormalError, glm::degrees(std::acos(cosine)));
+		}
+
+		uint32_t texcoord = glm::packHalf2x16(vertex.texcoord);
+		compact.texcoord[0] = static_cast<uint16_t>(texcoord & 0xffff);
+		compact.texcoord[1] = static_cast<uint16_t>(texcoord >> 16);
+	}
+
+	return error;
+}
+
+}
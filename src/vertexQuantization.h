@@ -0,0 +1,20 @@
+#pragma once
+
+#include "model.h"
+
+#include <vector>
+
+namespace VulkanEngine
+{
+
+glm::vec2 octahedralEncode(const glm::vec3& normal);
+glm::vec3 octahedralDecode(const glm::vec2& encoded);
+
+int16_t packSnorm16(float value);
+float unpackSnorm16(int16_t value);
+
+// Encodes vertices into the compact layout and measures the largest position and normal deviation.
+// Positions are stored relative to the vertex bounds, dequantizeMatrix maps them back to model space.
+QuantizationError quantizeVertices(const Model::Vertex* vertices, uint32_t vertexCount, std::vector<Model::CompactVertex>& compactVertices, glm::mat4& dequantizeMatrix);
+
+}
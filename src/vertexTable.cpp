@@ -0,0 +1,74 @@
+#include "vertexTable.h"
+
+#include "utils.h"
+
+#include <cstring>
+
+namespace VulkanEngine
+{
+
+static_assert(sizeof(Model::Vertex) == 11 * sizeof(float), "Vertex must not contain padding to be hashed bytewise");
+
+VertexTable::VertexTable(size_t expectedCount)
+{
+	// keep the load factor at or below one half
+	size_t capacity = 16;
+	while(capacity < expectedCount * 2)
+	{
+		capacity <<= 1;
+	}
+
+	m_slots.assign(capacity, EMPTY);
+	m_mask = capacity - 1;
+}
+
+uint32_t VertexTable::findOrInsert(const Model::Vertex& vertex, std::vector<Model::Vertex>& vertices)
+{
+	if((m_count + 1) * 2 > m_slots.size())
+	{
+		grow(vertices);
+	}
+
+	size_t slot = hashBytes(&vertex, sizeof(Model::Vertex)) & m_mask;
+	while(m_slots[slot] != EMPTY)
+	{
+		uint32_t index = m_slots[slot];
+		if(memcmp(&vertices[index], &vertex, sizeof(Model::Vertex)) == 0)
+		{
+			return index;
+		}
+		slot = (slot + 1) & m_mask;
+	}
+
+	uint32_t index = static_cast<uint32_t>(vertices.size());
+	vertices.push_back(vertex);
+	m_slots[slot] = index;
+	m_count++;
+	return index;
+}
+
+void VertexTable::grow(const std::vector<Model::Vertex>& vertices)
+{
+	std::vector<uint32_t> slots(m_slots.size() * 2, EMPTY);
+	size_t mask = slots.size() - 1;
+
+	for(uint32_t index : m_slots)
+	{
+		if(index == EMPTY)
+		{
+			continue;
+		}
+
+		size_t slot = hashBytes(&vertices[index], sizeof(Model::Vertex)) & mask;
+		while(slots[slot] != EMPTY)
+		{
+			slot = (slot + 1) & mask;
+		}
+		slots[slot] = index;
+	}
+
+	m_slots.swap(slots);
+	m_mask = mask;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "model.h"
+
+#include <vector>
+
+namespace VulkanEngine
+{
+
+// Flat open-addressing table used to de-duplicate vertices while building an index buffer.
+// Slots only store indices into the vertex array, vertices are hashed and compared bytewise.
+class VertexTable
+{
+public:
+	VertexTable(size_t expectedCount);
+
+	VertexTable(const VertexTable&) = delete;
+	VertexTable& operator=(const VertexTable&) = delete;
+
+	// Returns the index of the vertex equal to the given one, appending it to vertices if there is none yet
+	uint32_t findOrInsert(const Model::Vertex& vertex, std::vector<Model::Vertex>& vertices);
+
+private:
+	static constexpr uint32_t EMPTY = ~0u;
+
+	void grow(const std::vector<Model::Vertex>& vertices);
+
+	std::vector<uint32_t> m_slots;
+	size_t m_mask = 0;
+	size_t m_count = 0;
+};
+
+}
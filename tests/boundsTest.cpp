@@ -0,0 +1,78 @@
+#include "testUtils.h"
+
+#include "bounds.h"
+#include "objParser.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+// position first, then the rest of a Model::Vertex, so the bounds read the same stride as Mesh::computeBounds
+static constexpr size_t VERTEX_FLOAT_COUNT = 11;
+
+// relative slack for float rounding in the sphere radius
+static constexpr float EPSILON = 1e-5f;
+
+static void checkBounds(const std::string& name, const float* positions, size_t positionStride, size_t positionCount)
+{
+	BoundingBox box = computeBoundingBox(positions, positionStride, positionCount);
+	BoundingSphere sphere = computeBoundingSphere(positions, positionStride, positionCount, box);
+
+	float scale = std::max(glm::length(box.getExtents()), 1.0f);
+	bool touchesMin[3] = {};
+	bool touchesMax[3] = {};
+	for(size_t i = 0; i < positionCount; i++)
+	{
+		const float* position = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + positionStride * i);
+		glm::vec3 point{ position[0], position[1], position[2] };
+
+		for(int axis = 0; axis < 3; axis++)
+		{
+			CHECK(point[axis] >= box.min[axis] && point[axis] <= box.max[axis]);
+			touchesMin[axis] |= point[axis] == box.min[axis];
+			touchesMax[axis] |= point[axis] == box.max[axis];
+		}
+		CHECK(glm::length(point - sphere.center) <= sphere.radius + EPSILON * scale);
+	}
+
+	// the box is the tight one, each face has a position on it
+	for(int axis = 0; axis < 3; axis++)
+	{
+		CHECK(touchesMin[axis] && touchesMax[axis]);
+	}
+	// and the sphere no larger than the one around the box corners
+	CHECK(sphere.radius <= glm::length(box.getExtents()) * (1.0f + EPSILON));
+
+	std::printf("%s: %zu positions, radius %g\n", name.c_str(), positionCount, sphere.radius);
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t modelCount = Test::forEachModel(argc, argv, [](const std::string& name, const ObjData& data, const std::vector<uint32_t>&)
+	{
+		size_t positionCount = data.positions.size() / 3;
+		CHECK(positionCount > 0);
+
+		std::vector<float> vertices(positionCount * VERTEX_FLOAT_COUNT, 0.0f);
+		for(size_t i = 0; i < positionCount; i++)
+		{
+			for(size_t c = 0; c < 3; c++)
+			{
+				vertices[i * VERTEX_FLOAT_COUNT + c] = data.positions[i * 3 + c];
+			}
+		}
+
+		checkBounds(name, data.positions.data(), 3 * sizeof(float), positionCount);
+		checkBounds(name + " (vertex stride)", vertices.data(), VERTEX_FLOAT_COUNT * sizeof(float), positionCount);
+	});
+
+	CHECK(modelCount > 0);
+
+	BoundingBox empty = computeBoundingBox(nullptr, 3 * sizeof(float), 0);
+	CHECK(empty.min == glm::vec3(0.0f) && empty.max == glm::vec3(0.0f));
+
+	return Test::failedChecks;
+}
@@ -0,0 +1,287 @@
+#include "testUtils.h"
+
+#include "memoryAllocator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace VulkanEngine;
+
+// Hands out fake memory handles, refusing allocations beyond the size of their heap like a device would
+class FakeBlockSource : public MemoryAllocator::BlockSource
+{
+public:
+	FakeBlockSource(const VkPhysicalDeviceMemoryProperties& memoryProperties) : m_memoryProperties(memoryProperties) {}
+
+	VkDeviceMemory allocateMemory(uint32_t memoryTypeIndex, VkDeviceSize size) override
+	{
+		uint32_t heap = m_memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+		if(heapUsage[heap] + size > m_memoryProperties.memoryHeaps[heap].size)
+		{
+			return VK_NULL_HANDLE;
+		}
+
+		heapUsage[heap] += size;
+		VkDeviceMemory memory = reinterpret_cast<VkDeviceMemory>(static_cast<uintptr_t>(++allocateCount));
+		memories[memory] = { heap, size };
+		return memory;
+	}
+
+	void freeMemory(VkDeviceMemory memory) override
+	{
+		CHECK(memories.count(memory) == 1);
+		heapUsage[memories[memory].first] -= memories[memory].second;
+		memories.erase(memory);
+		mappedCount -= mapped.erase(memory);
+	}
+
+	void* mapMemory(VkDeviceMemory memory) override
+	{
+		mapped[memory] = true;
+		mappedCount++;
+		// never dereferenced, offsets into it only have to be distinct
+		return reinterpret_cast<void*>(static_cast<uintptr_t>(0x10000000));
+	}
+
+	std::map<VkDeviceMemory, std::pair<uint32_t, VkDeviceSize>> memories;	// heap and size
+	std::map<VkDeviceMemory, bool> mapped;
+	VkDeviceSize heapUsage[VK_MAX_MEMORY_HEAPS]{};
+	uint32_t allocateCount = 0;
+	uint32_t mappedCount = 0;
+
+private:
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+};
+
+static constexpr VkDeviceSize MiB = 1024 * 1024;
+static constexpr VkDeviceSize GRANULARITY = 4096;
+static constexpr VkDeviceSize ATOM_SIZE = 64;
+
+// device local type on a large heap, host visible ones on a small heap like the mappable part of VRAM
+static VkPhysicalDeviceMemoryProperties getMemoryProperties()
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties{};
+	memoryProperties.memoryHeapCount = 2;
+	memoryProperties.memoryHeaps[0].size = 8192 * MiB;
+	memoryProperties.memoryHeaps[1].size = 256 * MiB;
+	memoryProperties.memoryTypeCount = 3;
+	memoryProperties.memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+	memoryProperties.memoryTypes[1] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, 1 };
+	memoryProperties.memoryTypes[2] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+	return memoryProperties;
+}
+
+static VkMemoryRequirements getRequirements(VkDeviceSize size, VkDeviceSize alignment)
+{
+	VkMemoryRequirements requirements{};
+	requirements.size = size;
+	requirements.alignment = alignment;
+	requirements.memoryTypeBits = 0x7;
+	return requirements;
+}
+
+static void testBlocks()
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties = getMemoryProperties();
+	FakeBlockSource source{ memoryProperties };
+	{
+		MemoryAllocator allocator{ source, memoryProperties, GRANULARITY, ATOM_SIZE };
+
+		// small resources share one block
+		MemoryAllocation first = allocator.allocate(getRequirements(1 * MiB, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+		MemoryAllocation second = allocator.allocate(getRequirements(1 * MiB, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+		CHECK(source.allocateCount == 1);
+		CHECK(first.memory == second.memory && !first.dedicated);
+		CHECK(first.offset + first.size <= second.offset || second.offset + second.size <= first.offset);
+
+		// an image next to buffers starts and ends on its own granularity page
+		MemoryAllocation image = allocator.allocate(getRequirements(1000, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+		CHECK(image.offset % GRANULARITY == 0 && image.size % GRANULARITY == 0);
+		CHECK(image.wastedSize == image.size - 1000);
+
+		// a full block makes another one
+		std::vector<MemoryAllocation> fill;
+		while(source.allocateCount == 1)
+		{
+			fill.push_back(allocator.allocate(getRequirements(16 * MiB, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true));
+		}
+		CHECK(fill.back().memory != first.memory);
+		CHECK(allocator.getStats().blockCount == 2);
+
+		for(const MemoryAllocation& allocation : fill)
+		{
+			allocator.free(allocation);
+		}
+		allocator.free(first);
+		allocator.free(second);
+		allocator.free(image);
+
+		// one empty block is kept, the other one goes back
+		MemoryAllocator::Stats stats = allocator.getStats();
+		CHECK(stats.blockCount == 1 && stats.allocationCount == 0);
+		CHECK(stats.usedBytes == 0 && stats.wastedBytes == 0);
+		CHECK(source.memories.size() == 1);
+	}
+	CHECK(source.memories.empty());
+}
+
+static void testDedicated()
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties = getMemoryProperties();
+	FakeBlockSource source{ memoryProperties };
+	{
+		MemoryAllocator allocator{ source, memoryProperties, GRANULARITY, ATOM_SIZE };
+
+		// more than half a block gets memory of its own
+		VkDeviceSize size = MemoryAllocator::DEFAULT_BLOCK_SIZE / 2 + 1;
+		MemoryAllocation allocation = allocator.allocate(getRequirements(size, 256), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true);
+		CHECK(allocation.dedicated && allocation.offset == 0);
+		CHECK(source.memories[allocation.memory].second == allocation.size);
+
+		MemoryAllocator::Stats stats = allocator.getStats();
+		CHECK(stats.dedicatedCount == 1 && stats.blockCount == 0);
+		CHECK(stats.usedBytes == size);
+
+		allocator.free(allocation);
+		CHECK(source.memories.empty());
+		CHECK(allocator.getStats().dedicatedCount == 0);
+	}
+}
+
+static void testHeapCap()
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties = getMemoryProperties();
+	FakeBlockSource source{ memoryProperties };
+	{
+		MemoryAllocator allocator{ source, memoryProperties, GRANULARITY, ATOM_SIZE };
+
+		// blocks on the small heap are an eighth of it, and its allocations are padded to whole atoms
+		MemoryAllocation mapped = allocator.allocate(getRequirements(100, 4), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, true);
+		CHECK(source.memories[mapped.memory].second == 32 * MiB);
+		CHECK(mapped.offset % ATOM_SIZE == 0 && mapped.size % ATOM_SIZE == 0);
+		CHECK(mapped.pMapped != nullptr && source.mappedCount == 1);
+
+		// 16 MiB is more than half of such a block, so it is dedicated
+		std::vector<MemoryAllocation> large;
+		bool outOfMemory = false;
+		try
+		{
+			while(true)
+			{
+				large.push_back(allocator.allocate(getRequirements(16 * MiB + 1, 4), VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, true));
+			}
+		}
+		catch(const std::runtime_error&)
+		{
+			outOfMemory = true;
+		}
+
+		CHECK(outOfMemory);
+		CHECK(large.size() == (256 - 32) / 17);
+		CHECK(large.front().dedicated);
+		CHECK(source.heapUsage[1] <= memoryProperties.memoryHeaps[1].size);
+
+		// a failed allocation leaves nothing behind
+		CHECK(allocator.getStats().allocationCount == large.size() + 1);
+
+		for(const MemoryAllocation& allocation : large)
+		{
+			allocator.free(allocation);
+		}
+		allocator.free(mapped);
+	}
+	CHECK(source.memories.empty() && source.mappedCount == 0);
+}
+
+// Random resources of all kinds, none of them may overlap or share a granularity page with a resource of the other tiling
+static void fuzz()
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties = getMemoryProperties();
+	FakeBlockSource source{ memoryProperties };
+	{
+		MemoryAllocator allocator{ source, memoryProperties, GRANULARITY, ATOM_SIZE };
+		std::mt19937 random{ 3 };
+
+		struct Resource
+		{
+			MemoryAllocation allocation;
+			VkDeviceSize size;
+			bool linear;
+		};
+		std::vector<Resource> resources;
+
+		for(int i = 0; i < 20000; i++)
+		{
+			if(resources.empty() || random() % 100 < 52)
+			{
+				VkDeviceSize maxSize = random() % 10 == 0 ? 40 * MiB : 1 * MiB;
+				VkMemoryRequirements requirements = getRequirements(1 + random() % maxSize, VkDeviceSize(1) << (random() % 9));
+				VkMemoryPropertyFlags properties = random() % 3 == 0 ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+				bool linear = random() % 2 == 0;
+
+				try
+				{
+					MemoryAllocation allocation = allocator.allocate(requirements, properties, linear);
+					CHECK(allocation.offset % requirements.alignment == 0 && allocation.size >= requirements.size);
+					resources.push_back({ allocation, requirements.size, linear });
+				}
+				catch(const std::runtime_error&)
+				{
+					// the small heap is full, tolerated as long as it really is
+					CHECK(properties == VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+				}
+			}
+			else
+			{
+				size_t index = random() % resources.size();
+				allocator.free(resources[index].allocation);
+				resources.erase(resources.begin() + index);
+			}
+		}
+
+		for(size_t i = 0; i < resources.size(); i++)
+		{
+			for(size_t j = i + 1; j < resources.size(); j++)
+			{
+				const MemoryAllocation& a = resources[i].allocation;
+				const MemoryAllocation& b = resources[j].allocation;
+				if(a.memory != b.memory)
+				{
+					continue;
+				}
+
+				const MemoryAllocation& low = a.offset < b.offset ? a : b;
+				const MemoryAllocation& high = a.offset < b.offset ? b : a;
+				CHECK(low.offset + low.size <= high.offset);
+				if(resources[i].linear != resources[j].linear)
+				{
+					CHECK((low.offset + low.size - 1) / GRANULARITY != high.offset / GRANULARITY);
+				}
+			}
+		}
+
+		MemoryAllocator::Stats stats = allocator.getStats();
+		std::printf("fuzz: %u blocks, %u dedicated, %u allocations, fragmentation %.3f\n", stats.blockCount, stats.dedicatedCount, stats.allocationCount, stats.getFragmentation());
+
+		for(const Resource& resource : resources)
+		{
+			allocator.free(resource.allocation);
+		}
+		CHECK(allocator.getStats().usedBytes == 0);
+	}
+	CHECK(source.memories.empty() && source.mappedCount == 0);
+}
+
+int main()
+{
+	testBlocks();
+	testDedicated();
+	testHeapCap();
+	fuzz();
+
+	return Test::failedChecks;
+}
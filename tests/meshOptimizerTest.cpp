@@ -0,0 +1,111 @@
+#include "testUtils.h"
+
+#include "meshOptimizer.h"
+#include "objParser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+using Test::Triangle;
+using Test::getTriangleSet;
+
+// Runs the optimizations in the order Mesh::optimize does and checks they only reorder
+static void checkOptimize(const std::string& name, std::vector<uint32_t> indices, const std::vector<float>& positions, bool expectImprovement)
+{
+	size_t vertexCount = positions.size() / 3;
+	std::vector<Triangle> original = getTriangleSet(indices);
+	VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+	std::vector<uint32_t> clusters = optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+	CHECK(!clusters.empty() && clusters[0] == 0);
+	CHECK(std::is_sorted(clusters.begin(), clusters.end()));
+	CHECK(getTriangleSet(indices) == original);
+
+	optimizeOverdraw(indices.data(), indices.size(), clusters, positions.data(), 3 * sizeof(float));
+	CHECK(getTriangleSet(indices) == original);
+	VertexCacheStats after = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+	// vertices move to first use order, so mapping the old triangles gives the new ones
+	size_t usedVertexCount = 0;
+	std::vector<uint32_t> reordered = indices;
+	std::vector<uint32_t> remap = optimizeVertexFetch(reordered.data(), reordered.size(), vertexCount, usedVertexCount);
+	std::vector<uint32_t> mapped(indices.size());
+	for(size_t i = 0; i < indices.size(); i++)
+	{
+		mapped[i] = remap[indices[i]];
+	}
+	CHECK(mapped == reordered);
+	CHECK(usedVertexCount <= vertexCount);
+	uint32_t nextVertex = 0;
+	for(uint32_t index : reordered)
+	{
+		CHECK(index <= nextVertex);
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+	CHECK(nextVertex == usedVertexCount);
+
+	// reordering alone never makes the cache simulation worse, a scrambled order it must improve
+	CHECK(after.acmr <= before.acmr + 1e-6f);
+	if(expectImprovement)
+	{
+		CHECK(after.acmr < before.acmr * 0.75f);
+	}
+
+	std::printf("%s: %zu triangles, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name.c_str(), indices.size() / 3, before.acmr, after.acmr, before.atvr, after.atvr);
+}
+
+// Regular grid of size x size quads with its triangles in random order
+static void testScrambledGrid(uint32_t size)
+{
+	std::vector<float> positions;
+	for(uint32_t y = 0; y <= size; y++)
+	{
+		for(uint32_t x = 0; x <= size; x++)
+		{
+			positions.insert(positions.end(), { static_cast<float>(x), static_cast<float>(y), 0.0f });
+		}
+	}
+
+	std::vector<Triangle> triangles;
+	for(uint32_t y = 0; y < size; y++)
+	{
+		for(uint32_t x = 0; x < size; x++)
+		{
+			uint32_t corner = y * (size + 1) + x;
+			triangles.push_back({ corner, corner + 1, corner + size + 1 });
+			triangles.push_back({ corner + 1, corner + size + 2, corner + size + 1 });
+		}
+	}
+	std::shuffle(triangles.begin(), triangles.end(), std::mt19937{ 5 });
+
+	std::vector<uint32_t> indices;
+	for(const Triangle& triangle : triangles)
+	{
+		indices.insert(indices.end(), triangle.begin(), triangle.end());
+	}
+
+	checkOptimize("scrambled grid", indices, positions, true);
+}
+
+int main(int argc, char** argv)
+{
+	testScrambledGrid(64);
+
+	// the models index positions directly, the other attributes play no part in the order
+	uint32_t modelCount = Test::forEachModel(argc, argv, [](const std::string& name, const ObjData& data, const std::vector<uint32_t>& indices)
+	{
+		checkOptimize(name, indices, data.positions, false);
+	});
+	CHECK(modelCount > 0);
+
+	// an empty mesh comes back unchanged
+	std::vector<uint32_t> clusters = optimizeVertexCache(nullptr, 0, 0);
+	CHECK(clusters.empty());
+
+	return Test::failedChecks;
+}
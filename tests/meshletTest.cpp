@@ -0,0 +1,91 @@
+#include "testUtils.h"
+
+#include "meshlet.h"
+#include "objParser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+// Meshlets have to tile the index buffer in order, stay within both limits and bound their vertices
+static void checkMeshlets(const std::string& name, std::vector<uint32_t> indices, const std::vector<float>& positions, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	std::vector<Test::Triangle> original = Test::getTriangleSet(indices);
+	std::vector<Meshlet> meshlets = buildMeshlets(indices.data(), indices.size(), positions.data(), 3 * sizeof(float), positions.size() / 3,
+		false, maxVertices, maxTriangles);
+
+	// only the order of whole triangles changes
+	CHECK(Test::getTriangleSet(indices) == original);
+
+	uint32_t nextIndex = 0;
+	uint32_t maxVertexCount = 0;
+	for(const Meshlet& meshlet : meshlets)
+	{
+		CHECK(meshlet.firstIndex == nextIndex);
+		CHECK(meshlet.indexCount > 0 && meshlet.indexCount % 3 == 0);
+		CHECK(meshlet.indexCount / 3 <= maxTriangles);
+		CHECK(meshlet.vertexOffset == 0);
+		nextIndex = meshlet.firstIndex + meshlet.indexCount;
+
+		std::vector<uint32_t> vertices(indices.begin() + meshlet.firstIndex, indices.begin() + nextIndex);
+		std::sort(vertices.begin(), vertices.end());
+		vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+		CHECK(meshlet.vertexCount == vertices.size());
+		CHECK(meshlet.vertexCount <= maxVertices);
+		maxVertexCount = std::max(maxVertexCount, meshlet.vertexCount);
+
+		for(uint32_t vertex : vertices)
+		{
+			glm::vec3 position{ positions[3 * vertex], positions[3 * vertex + 1], positions[3 * vertex + 2] };
+			CHECK(glm::length(position - meshlet.center) <= meshlet.radius * 1.0001f + 1e-6f);
+		}
+	}
+	CHECK(nextIndex == indices.size());
+
+	std::printf("%s: %zu triangles in %zu meshlets of at most %u/%u vertices, %.1f triangles on average\n", name.c_str(), indices.size() / 3,
+		meshlets.size(), maxVertexCount, maxVertices, meshlets.empty() ? 0.0f : static_cast<float>(indices.size() / 3) / meshlets.size());
+}
+
+static void testGrid(uint32_t size)
+{
+	std::vector<float> positions;
+	for(uint32_t y = 0; y <= size; y++)
+	{
+		for(uint32_t x = 0; x <= size; x++)
+		{
+			positions.insert(positions.end(), { static_cast<float>(x), static_cast<float>(y), 0.0f });
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	for(uint32_t y = 0; y < size; y++)
+	{
+		for(uint32_t x = 0; x < size; x++)
+		{
+			uint32_t corner = y * (size + 1) + x;
+			indices.insert(indices.end(), { corner, corner + 1, corner + size + 1, corner + 1, corner + size + 2, corner + size + 1 });
+		}
+	}
+
+	checkMeshlets("grid", indices, positions, MAX_MESHLET_VERTICES, MAX_MESHLET_TRIANGLES);
+	// at the default limits the vertices run out first on a grid, here the triangles do
+	checkMeshlets("grid, small limits", indices, positions, 16, 8);
+}
+
+int main(int argc, char** argv)
+{
+	testGrid(64);
+
+	uint32_t modelCount = Test::forEachModel(argc, argv, [](const std::string& name, const ObjData& data, const std::vector<uint32_t>& indices)
+	{
+		checkMeshlets(name, indices, data.positions, MAX_MESHLET_VERTICES, MAX_MESHLET_TRIANGLES);
+	});
+	CHECK(modelCount > 0);
+
+	CHECK(buildMeshlets(nullptr, 0, nullptr, 3 * sizeof(float), 0).empty());
+
+	return Test::failedChecks;
+}
@@ -0,0 +1,154 @@
+#include "testUtils.h"
+
+#include "mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace VulkanEngine;
+
+static std::vector<uint8_t> createImage(uint32_t width, uint32_t height, uint32_t seed)
+{
+	std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+	std::mt19937 random{ seed };
+	for(uint8_t& value : pixels)
+	{
+		value = static_cast<uint8_t>(random());
+	}
+	return pixels;
+}
+
+static float decodeSrgb(uint8_t value)
+{
+	float linear = value / 255.0f;
+	return linear <= 0.04045f ? linear / 12.92f : std::pow((linear + 0.055f) / 1.055f, 2.4f);
+}
+
+static float encodeSrgb(float linear)
+{
+	float value = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+	return value * 255.0f;
+}
+
+static void testLevelCount()
+{
+	CHECK(getMipLevelCount(1, 1) == 1);
+	CHECK(getMipLevelCount(2, 1) == 2);
+	CHECK(getMipLevelCount(256, 256) == 9);
+	CHECK(getMipLevelCount(257, 100) == 9);
+	CHECK(getMipLevelCount(640, 480) == 10);
+	CHECK(getMipLevelCount(1, 1024) == 11);
+}
+
+// The 2x2 box filter against a scalar reference, exact for unorm and within one step for srgb
+static void testDownsample(uint32_t width, uint32_t height)
+{
+	std::vector<uint8_t> src = createImage(width, height, width * 1000 + height);
+	uint32_t dstWidth = std::max(1u, width / 2);
+	uint32_t dstHeight = std::max(1u, height / 2);
+	std::vector<uint8_t> unorm(static_cast<size_t>(dstWidth) * dstHeight * 4);
+	std::vector<uint8_t> srgb(unorm.size());
+	downsampleRgba8(src.data(), width, height, unorm.data(), false);
+	downsampleRgba8(src.data(), width, height, srgb.data(), true);
+
+	for(uint32_t y = 0; y < dstHeight; y++)
+	{
+		for(uint32_t x = 0; x < dstWidth; x++)
+		{
+			// an odd last row or column is dropped, a side of 1 is read twice
+			uint32_t xs[2] = { 2 * x, std::min(2 * x + 1, width - 1) };
+			uint32_t ys[2] = { 2 * y, std::min(2 * y + 1, height - 1) };
+
+			for(uint32_t c = 0; c < 4; c++)
+			{
+				uint32_t sum = 0;
+				float linearSum = 0.0f;
+				for(uint32_t sy : ys)
+				{
+					for(uint32_t sx : xs)
+					{
+						uint8_t value = src[(static_cast<size_t>(sy) * width + sx) * 4 + c];
+						sum += value;
+						linearSum += decodeSrgb(value);
+					}
+				}
+
+				size_t index = (static_cast<size_t>(y) * dstWidth + x) * 4 + c;
+				CHECK(unorm[index] == (sum + 2) / 4);
+				if(c < 3)
+				{
+					CHECK(std::fabs(srgb[index] - encodeSrgb(linearSum / 4.0f)) <= 1.0f);
+				}
+				else
+				{
+					// alpha is coverage, averaged as it is
+					CHECK(srgb[index] == (sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+static void testChain(uint32_t width, uint32_t height, bool srgb)
+{
+	std::vector<uint8_t> pixels = createImage(width, height, 7);
+	std::vector<size_t> offsets = generateMipChain(pixels, width, height, srgb);
+
+	uint32_t levelCount = getMipLevelCount(width, height);
+	CHECK(offsets.size() == levelCount + 1);
+	CHECK(offsets.back() == pixels.size());
+	CHECK(offsets[levelCount] - offsets[levelCount - 1] == 4);
+
+	// every level is the previous one filtered down
+	for(uint32_t level = 1; level < levelCount; level++)
+	{
+		uint32_t levelWidth = std::max(1u, width >> level);
+		uint32_t levelHeight = std::max(1u, height >> level);
+		CHECK(offsets[level + 1] - offsets[level] == static_cast<size_t>(levelWidth) * levelHeight * 4);
+
+		std::vector<uint8_t> expected(offsets[level + 1] - offsets[level]);
+		downsampleRgba8(pixels.data() + offsets[level - 1], std::max(1u, width >> (level - 1)), std::max(1u, height >> (level - 1)), expected.data(), srgb);
+		CHECK(std::equal(expected.begin(), expected.end(), pixels.begin() + offsets[level]));
+	}
+}
+
+// A flat color stays exactly that color down the whole chain
+static void testConstant(bool srgb)
+{
+	std::vector<uint8_t> pixels(37 * 19 * 4);
+	for(size_t i = 0; i < pixels.size(); i += 4)
+	{
+		pixels[i + 0] = 10;
+		pixels[i + 1] = 128;
+		pixels[i + 2] = 250;
+		pixels[i + 3] = 77;
+	}
+
+	generateMipChain(pixels, 37, 19, srgb);
+	for(size_t i = 0; i < pixels.size(); i += 4)
+	{
+		CHECK(pixels[i + 0] == 10 && pixels[i + 1] == 128 && pixels[i + 2] == 250 && pixels[i + 3] == 77);
+	}
+}
+
+int main()
+{
+	testLevelCount();
+
+	// even and odd sides, sides of 1, and widths long enough for the vectorized rows and their tails
+	uint32_t sizes[][2] = { { 2, 2 }, { 3, 3 }, { 1, 8 }, { 8, 1 }, { 16, 16 }, { 17, 9 }, { 64, 33 }, { 255, 128 } };
+	for(const uint32_t* size : sizes)
+	{
+		testDownsample(size[0], size[1]);
+	}
+
+	testChain(256, 256, false);
+	testChain(300, 17, true);
+	testChain(1, 64, false);
+	testConstant(false);
+	testConstant(true);
+
+	return Test::failedChecks;
+}
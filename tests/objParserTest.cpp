@@ -0,0 +1,68 @@
+#include "testUtils.h"
+
+#include "objParser.h"
+
+#include <cstring>
+#include <stdexcept>
+
+using namespace VulkanEngine;
+
+static bool parses(const char* text, ObjData& data)
+{
+	data = {};
+	try
+	{
+		parseObj(text, std::strlen(text), data);
+		return true;
+	}
+	catch(const std::runtime_error&)
+	{
+		return false;
+	}
+}
+
+static void testValid()
+{
+	ObjData data;
+	const char* text =
+		"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+		"vn 0 0 1\nvt 0 0\nvt 1 1\n"
+		"f 1/1/1 2/2/1 3/2/1 4/1/1\n"
+		"f -4//-1 -3//-1 -2//-1\n"
+		"f 1 2 3\n";
+	CHECK(parses(text, data));
+	CHECK(data.positions.size() == 12 && data.normals.size() == 3 && data.texcoords.size() == 4);
+	CHECK(data.indices.size() == 12);
+
+	// relative indices resolve against what was defined so far
+	CHECK(data.indices[6].position == 0 && data.indices[6].normal == 0 && data.indices[6].texcoord == -1);
+	CHECK(data.indices[8].position == 2);
+
+	// corners without normals or texcoords mark them -1
+	CHECK(data.indices[9].normal == -1 && data.indices[9].texcoord == -1);
+}
+
+static void testOutOfRange()
+{
+	ObjData data;
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nf 1 2 4\n", data));
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nf -4 -2 -1\n", data));
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvn 0 0 1\nf 1//1 2//1 3//2\n", data));
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nf 1/2 2/1 3/1\n", data));
+
+	// relative normal and texcoord indices reaching back past the first one
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvn 0 0 1\nf 1//-3 2//-1 3//-1\n", data));
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nf 1/-1 2/-1 3/-5\n", data));
+
+	// one before the first element must not pass as a missing attribute
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvn 0 0 1\nf 1//-2 2//-1 3//-1\n", data));
+	CHECK(!parses("v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nf 1/-2 2/-1 3/-1\n", data));
+}
+
+int main()
+{
+	testValid();
+	testOutOfRange();
+
+	return Test::failedChecks;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "objParser.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Minimal checks shared by the test executables. A failing check reports itself and the test keeps going,
+// so one run shows every failure, and main returns the failure count to ctest.
+
+namespace VulkanEngine::Test
+{
+
+inline int failedChecks = 0;
+
+using Triangle = std::array<uint32_t, 3>;
+
+// Triangles rotated to start at their smallest index, which keeps the winding, then sorted, so index buffers
+// holding the same triangles in any order compare equal
+inline std::vector<Triangle> getTriangleSet(const std::vector<uint32_t>& indices)
+{
+	std::vector<Triangle> triangles;
+	for(size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		Triangle triangle{ indices[i], indices[i + 1], indices[i + 2] };
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+// Parses every OBJ file in the models directory ctest passes as the first argument and calls
+// function(name, data, indices), indices holding the position index of each corner. Returns the file count.
+template<typename Function>
+uint32_t forEachModel(int argc, char** argv, Function&& function)
+{
+	std::filesystem::path modelsDir = argc > 1 ? argv[1] : "models";
+
+	uint32_t modelCount = 0;
+	for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(modelsDir))
+	{
+		if(entry.path().extension() != ".obj")
+		{
+			continue;
+		}
+
+		ObjData data;
+		parseObj(entry.path().string(), data);
+		std::vector<uint32_t> indices;
+		indices.reserve(data.indices.size());
+		for(const ObjIndex& index : data.indices)
+		{
+			indices.push_back(static_cast<uint32_t>(index.position));
+		}
+
+		function(entry.path().filename().string(), data, indices);
+		modelCount++;
+	}
+	return modelCount;
+}
+
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if(!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			VulkanEngine::Test::failedChecks++; \
+		} \
+	} while(false)
@@ -0,0 +1,199 @@
+#include "testUtils.h"
+
+#include "textureAtlas.h"
+
+// textureAtlas.cpp decodes files with stb_image, the engine compiles its implementation in image.cpp
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace VulkanEngine;
+
+struct Texture
+{
+	std::vector<uint8_t> texels;
+	uint32_t width;
+	uint32_t height;
+};
+
+static Texture createTexture(uint32_t width, uint32_t height, uint32_t seed)
+{
+	Texture texture{ std::vector<uint8_t>(static_cast<size_t>(width) * height * 4), width, height };
+	std::mt19937 random{ seed };
+	for(uint8_t& value : texture.texels)
+	{
+		value = static_cast<uint8_t>(random());
+	}
+	return texture;
+}
+
+// Texel of the region's level 0 in page texels, the region itself starts at (0, 0)
+static uint32_t getOriginX(const AtlasRegion& region, const ImageData& page) { return static_cast<uint32_t>(region.offset.x * page.width + 0.5f); }
+static uint32_t getOriginY(const AtlasRegion& region, const ImageData& page) { return static_cast<uint32_t>(region.offset.y * page.height + 0.5f); }
+
+// The cell a region was packed into, its texture and gutter rounded up to whole GUTTER units
+static uint32_t getCellSize(uint32_t size) { return (size + 3 * TextureAtlas::GUTTER - 1) / TextureAtlas::GUTTER * TextureAtlas::GUTTER; }
+
+static std::vector<uint32_t> addAll(TextureAtlas& atlas, const std::vector<Texture>& textures)
+{
+	std::vector<uint32_t> regions;
+	for(const Texture& texture : textures)
+	{
+		regions.push_back(atlas.add(texture.texels.data(), texture.width, texture.height));
+	}
+	return regions;
+}
+
+// Every texture is copied to its region, and the gutter around it repeats the nearest edge texel
+static void testRegions()
+{
+	std::vector<Texture> textures = { createTexture(20, 12, 1), createTexture(33, 7, 2), createTexture(16, 16, 3), createTexture(1, 1, 4) };
+
+	TextureAtlas atlas{ 128 };
+	std::vector<uint32_t> regions = addAll(atlas, textures);
+	atlas.build(false);
+	CHECK(atlas.getPageCount() == 1);
+
+	const ImageData& page = atlas.getPage(0);
+	CHECK(page.width % TextureAtlas::GUTTER == 0 && page.height % TextureAtlas::GUTTER == 0);
+	CHECK(page.mipLevels == TextureAtlas::MIP_LEVELS);
+
+	const int gutter = static_cast<int>(TextureAtlas::GUTTER);
+	for(size_t i = 0; i < textures.size(); i++)
+	{
+		const Texture& texture = textures[i];
+		const AtlasRegion& region = atlas.getRegion(regions[i]);
+		CHECK(region.page == 0);
+		CHECK(region.scale.x * page.width == static_cast<float>(texture.width));
+		CHECK(region.scale.y * page.height == static_cast<float>(texture.height));
+
+		uint32_t originX = getOriginX(region, page);
+		uint32_t originY = getOriginY(region, page);
+		CHECK(originX % TextureAtlas::GUTTER == 0 && originY % TextureAtlas::GUTTER == 0);
+
+		for(int y = -gutter; y < static_cast<int>(texture.height) + gutter; y++)
+		{
+			for(int x = -gutter; x < static_cast<int>(texture.width) + gutter; x++)
+			{
+				int sourceX = std::clamp(x, 0, static_cast<int>(texture.width) - 1);
+				int sourceY = std::clamp(y, 0, static_cast<int>(texture.height) - 1);
+				const uint8_t* expected = texture.texels.data() + (static_cast<size_t>(sourceY) * texture.width + sourceX) * 4;
+				const uint8_t* actual = page.texels.data() + (static_cast<size_t>(static_cast<int>(originY) + y) * page.width + static_cast<int>(originX) + x) * 4;
+				CHECK(std::memcmp(expected, actual, 4) == 0);
+			}
+		}
+
+		// texcoords are clamped into the region
+		CHECK(region.remap({ 0.0f, 0.0f }) == region.offset);
+		CHECK(region.remap({ 1.0f, 1.0f }) == region.offset + region.scale);
+		CHECK(region.remap({ -0.5f, 2.0f }) == region.offset + glm::vec2(0.0f, region.scale.y));
+	}
+}
+
+// Changing one texture leaves every texel of its neighbours' cells untouched in every level, so no level filters
+// across two regions. The cells are not multiples of the coarser texels, a smaller gutter would show here.
+static void testMipIsolation()
+{
+	std::vector<Texture> textures = { createTexture(20, 9, 1), createTexture(20, 9, 2), createTexture(20, 9, 3), createTexture(20, 9, 4) };
+
+	TextureAtlas atlas{ 256 };
+	std::vector<uint32_t> regions = addAll(atlas, textures);
+	atlas.build(true);
+
+	// same sizes pack the same way
+	std::vector<Texture> changed = textures;
+	changed[1] = createTexture(20, 9, 99);
+	TextureAtlas changedAtlas{ 256 };
+	addAll(changedAtlas, changed);
+	changedAtlas.build(true);
+
+	const ImageData& page = atlas.getPage(0);
+	const ImageData& changedPage = changedAtlas.getPage(0);
+	CHECK(page.width == changedPage.width && page.height == changedPage.height && page.mipLevels == changedPage.mipLevels);
+
+	for(size_t i = 0; i < textures.size(); i++)
+	{
+		const AtlasRegion& region = atlas.getRegion(regions[i]);
+		uint32_t cellX = getOriginX(region, page) - TextureAtlas::GUTTER;
+		uint32_t cellY = getOriginY(region, page) - TextureAtlas::GUTTER;
+		uint32_t cellWidth = getCellSize(textures[i].width);
+		uint32_t cellHeight = getCellSize(textures[i].height);
+
+		bool levelsEqual = true;
+		for(uint32_t level = 0; level < page.mipLevels; level++)
+		{
+			// every texel of the level that covers part of the cell
+			uint32_t levelWidth = std::max(1u, page.width >> level);
+			uint32_t beginX = cellX >> level;
+			uint32_t endX = (cellX + cellWidth + (1u << level) - 1) >> level;
+			uint32_t beginY = cellY >> level;
+			uint32_t endY = (cellY + cellHeight + (1u << level) - 1) >> level;
+
+			for(uint32_t y = beginY; y < endY; y++)
+			{
+				size_t rowOffset = (static_cast<size_t>(y) * levelWidth + beginX) * 4;
+				levelsEqual &= std::memcmp(page.getLevelData(level) + rowOffset, changedPage.getLevelData(level) + rowOffset, static_cast<size_t>(endX - beginX) * 4) == 0;
+			}
+		}
+		CHECK(levelsEqual == (i != 1));
+	}
+}
+
+static void testPages()
+{
+	// only three of these fit on a page with their gutters
+	std::vector<Texture> textures(7, createTexture(24, 24, 5));
+
+	TextureAtlas atlas{ 64 };
+	std::vector<uint32_t> regions = addAll(atlas, textures);
+	atlas.build(false);
+	CHECK(atlas.getPageCount() > 1);
+
+	uint64_t pageTexels = 0;
+	for(uint32_t page = 0; page < atlas.getPageCount(); page++)
+	{
+		CHECK(atlas.getPage(page).width <= 64 && atlas.getPage(page).height <= 64);
+		pageTexels += static_cast<uint64_t>(atlas.getPage(page).width) * atlas.getPage(page).height;
+	}
+	for(uint32_t region : regions)
+	{
+		CHECK(atlas.getRegion(region).page < atlas.getPageCount());
+	}
+
+	float occupancy = atlas.getOccupancy();
+	CHECK(occupancy == static_cast<float>(textures.size() * 24 * 24) / static_cast<float>(pageTexels));
+
+	// handing the pages over keeps the regions and occupancy
+	std::vector<ImageData> pages = atlas.takePages();
+	CHECK(atlas.getPageCount() == 0);
+	CHECK(atlas.getOccupancy() == occupancy);
+	for(uint32_t region : regions)
+	{
+		CHECK(atlas.getRegion(region).page < pages.size());
+	}
+
+	bool threw = false;
+	try
+	{
+		atlas.add(textures[0].texels.data(), 64 - 2 * TextureAtlas::GUTTER + 1, 1);
+	}
+	catch(const std::runtime_error&)
+	{
+		threw = true;
+	}
+	CHECK(threw);
+}
+
+int main()
+{
+	testRegions();
+	testMipIsolation();
+	testPages();
+
+	return Test::failedChecks;
+}
@@ -0,0 +1,68 @@
+#include "testUtils.h"
+
+#include "threadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace VulkanEngine;
+
+static void testParallelFor(ThreadPool& threadPool)
+{
+	std::vector<std::atomic<uint32_t>> runs(1000);
+	threadPool.parallelFor(static_cast<uint32_t>(runs.size()), [&](uint32_t i) { runs[i]++; });
+	for(const std::atomic<uint32_t>& count : runs)
+	{
+		CHECK(count == 1);
+	}
+
+	// nested calls from inside pool tasks finish too, the calling threads help out
+	std::atomic<uint32_t> nestedRuns{ 0 };
+	threadPool.parallelFor(8, [&](uint32_t)
+	{
+		threadPool.parallelFor(8, [&](uint32_t) { nestedRuns++; });
+	});
+	CHECK(nestedRuns == 64);
+
+	threadPool.parallelFor(0, [&](uint32_t) { CHECK(false); });
+}
+
+static void testExceptions(ThreadPool& threadPool)
+{
+	// tasks throwing on the workers and on the calling thread reach the caller once, after every other index ran
+	std::atomic<uint32_t> completed{ 0 };
+	bool caught = false;
+	try
+	{
+		threadPool.parallelFor(100, [&](uint32_t i)
+		{
+			if(i % 10 == 3)
+			{
+				throw std::runtime_error("task " + std::to_string(i));
+			}
+			completed++;
+		});
+	}
+	catch(const std::runtime_error& e)
+	{
+		caught = std::string(e.what()).rfind("task ", 0) == 0;
+	}
+	CHECK(caught);
+	CHECK(completed == 90);
+
+	// and the pool keeps working afterwards
+	std::atomic<uint32_t> runs{ 0 };
+	threadPool.parallelFor(100, [&](uint32_t) { runs++; });
+	CHECK(runs == 100);
+}
+
+int main()
+{
+	ThreadPool threadPool{ 3 };
+	testParallelFor(threadPool);
+	testExceptions(threadPool);
+
+	return Test::failedChecks;
+}
@@ -0,0 +1,85 @@
+#include "testUtils.h"
+
+#include "tlsfAllocator.h"
+
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <random>
+
+using namespace VulkanEngine;
+
+// Random allocations and frees against a map of the live ranges, which must never overlap or leave the space
+static void fuzz(uint64_t capacity, uint32_t seed)
+{
+	TlsfAllocator allocator{ capacity };
+	std::map<uint64_t, uint64_t> live;	// offset to size
+	std::mt19937_64 random{ seed };
+	uint32_t failedCount = 0;
+
+	for(int i = 0; i < 200000; i++)
+	{
+		if(live.empty() || random() % 100 < 55)
+		{
+			uint64_t size = 1 + random() % (capacity / (1 + random() % 64));
+			uint64_t alignment = 1ull << (random() % 12);
+			uint64_t offset = allocator.allocate(size, alignment);
+			if(offset == TlsfAllocator::INVALID_OFFSET)
+			{
+				failedCount++;
+				continue;
+			}
+
+			CHECK(offset % alignment == 0);
+			CHECK(offset + size <= capacity);
+			auto next = live.lower_bound(offset);
+			CHECK(next == live.end() || offset + size <= next->first);
+			CHECK(next == live.begin() || std::prev(next)->first + std::prev(next)->second <= offset);
+			live[offset] = size;
+		}
+		else
+		{
+			auto range = std::next(live.begin(), random() % live.size());
+			allocator.free(range->first);
+			live.erase(range);
+		}
+
+		if(i % 1000 == 0)
+		{
+			uint64_t usedSize = 0;
+			for(const auto& range : live)
+			{
+				usedSize += range.second;
+			}
+			CHECK(allocator.getUsedSize() == usedSize);
+			CHECK(allocator.getAllocationCount() == live.size());
+		}
+	}
+
+	for(const auto& range : live)
+	{
+		allocator.free(range.first);
+	}
+
+	// freed neighbours merge, so the space ends up as one range again
+	CHECK(allocator.isEmpty());
+	CHECK(allocator.getFreeRangeCount() == 1);
+	CHECK(allocator.getLargestFreeRange() == capacity);
+	std::printf("capacity %llu: %u of the allocations failed\n", static_cast<unsigned long long>(capacity), failedCount);
+}
+
+int main()
+{
+	fuzz(1000, 1);
+	fuzz(1ull << 20, 2);
+	fuzz((1ull << 26) + 123, 3);
+
+	TlsfAllocator allocator{ 4096 };
+	uint64_t offset = allocator.allocate(4096);
+	CHECK(offset == 0);
+	CHECK(allocator.allocate(1) == TlsfAllocator::INVALID_OFFSET);
+	allocator.free(offset);
+	CHECK(allocator.allocate(100, 1024) % 1024 == 0);
+
+	return Test::failedChecks;
+}
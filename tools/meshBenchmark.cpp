@@ -0,0 +1,384 @@
+// Times the CPU side of mesh import: OBJ files cooked from scratch against the same meshes mapped from their cache,
+// vertex de-duplication with VertexTable against std::unordered_map, and parseObj against tinyobjloader.
+// Usage: MeshBenchmark [--synthetic triangles] [OBJ files or directories...]
+// Without files it reads the models directory. A wavy grid of about the given number of triangles is generated into
+// a temporary OBJ file and benchmarked along with them, DEFAULT_SYNTHETIC_TRIANGLES unless given, none for 0.
+
+#include "meshCache.h"
+#include "model.h"
+#include "objParser.h"
+#include "threadPool.h"
+#include "utils.h"
+#include "vertexQuantization.h"
+#include "vertexTable.h"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifndef ENGINE_DIR
+#define ENGINE_DIR "../"
+#endif
+
+namespace std
+{
+// the hash Mesh::load used with std::unordered_map before VertexTable
+template<>
+struct hash<VulkanEngine::Model::Vertex>
+{
+	size_t operator()(VulkanEngine::Model::Vertex const& vertex) const
+	{
+		size_t seed = 0;
+		VulkanEngine::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.texcoord);
+		return seed;
+	}
+};
+}
+
+using namespace VulkanEngine;
+
+static constexpr uint32_t RUN_COUNT = 9;
+static constexpr uint32_t DEFAULT_SYNTHETIC_TRIANGLES = 1000000;
+
+// results of reads that are only timed go here, so the compiler cannot drop the reads
+static volatile uint64_t g_sink = 0;
+
+// Median wall time of the runs in milliseconds, the first run is part of it so file system caches are warm for all but it
+template<typename Function>
+static double measure(Function&& function)
+{
+	std::vector<double> times(RUN_COUNT);
+	for(double& time : times)
+	{
+		auto start = std::chrono::steady_clock::now();
+		function();
+		time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	std::nth_element(times.begin(), times.begin() + RUN_COUNT / 2, times.end());
+	return times[RUN_COUNT / 2];
+}
+
+// Writes a grid of side x side quads with positions, texcoords and normals of a sine wave, so the same file comes out
+// on every machine. Each vertex is shared by up to six triangles like in a typical closed mesh.
+static std::string writeSyntheticObj(uint32_t triangleCount)
+{
+	uint32_t side = std::max(1u, static_cast<uint32_t>(std::sqrt(triangleCount / 2.0)));
+	std::filesystem::path filepath = std::filesystem::temp_directory_path() / ("synthetic_grid_" + std::to_string(2ull * side * side) + ".obj");
+
+	std::ofstream file{ filepath, std::ios::trunc };
+	if(!file)
+	{
+		throw std::runtime_error("failed to write synthetic obj!");
+	}
+
+	// fits two faces of 10 digit indices
+	char line[256];
+	for(uint32_t y = 0; y <= side; y++)
+	{
+		for(uint32_t x = 0; x <= side; x++)
+		{
+			float u = static_cast<float>(x) / side;
+			float v = static_cast<float>(y) / side;
+			float height = 0.05f * std::sin(u * 25.0f) * std::cos(v * 17.0f);
+			glm::vec3 normal = glm::normalize(glm::vec3{ -1.25f * std::cos(u * 25.0f) * std::cos(v * 17.0f), 1.0f, 0.85f * std::sin(u * 25.0f) * std::sin(v * 17.0f) });
+
+			int length = std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", u, height, v, u, v, normal.x, normal.y, normal.z);
+			file.write(line, length);
+		}
+	}
+
+	for(uint32_t y = 0; y < side; y++)
+	{
+		for(uint32_t x = 0; x < side; x++)
+		{
+			uint32_t a = y * (side + 1) + x + 1;
+			uint32_t b = a + 1;
+			uint32_t c = a + side + 1;
+			uint32_t d = c + 1;
+			int length = std::snprintf(line, sizeof(line), "f %u/%u/%u %u/%u/%u %u/%u/%u\nf %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c, c, c, b, b, b, d, d, d, c, c, c);
+			file.write(line, length);
+		}
+	}
+
+	if(!file)
+	{
+		throw std::runtime_error("failed to write synthetic obj!");
+	}
+	return filepath.string();
+}
+
+// The cache is cooked with every step, the cleanup needs the same config to find its file
+static Model::LoadConfig getCacheConfig()
+{
+	Model::LoadConfig config{};
+	config.generateLods = true;
+	config.splitFor16BitIndices = true;
+	config.buildMeshlets = true;
+	return config;
+}
+
+// Cold is what createModelFromFile does without a cache, warm what it does with one before staging the data.
+// Also reports how far the compact vertex format moves positions and normals, to tell whether it is safe for the mesh.
+static void benchmarkMeshCache(const std::string& filepath)
+{
+	Model::LoadConfig config = getCacheConfig();
+
+	Model::Mesh mesh{};
+	Model::Mesh::OptimizeStats stats{};
+	double cold = measure([&]()
+	{
+		mesh = {};
+		mesh.load(filepath);
+		stats = mesh.optimize();
+		mesh.generateLods();
+		mesh.splitFor16BitIndices();
+		mesh.buildMeshlets();
+		MeshCache::write(filepath, config, mesh);
+	});
+
+	// touches every page the upload would copy, so the mapping is paged in like it would be
+	double warm = measure([&]()
+	{
+		std::unique_ptr<MeshCache> pCache = MeshCache::open(filepath, config);
+		if(!pCache)
+		{
+			throw std::runtime_error("failed to open mesh cache!");
+		}
+
+		Model::MeshData meshData = pCache->getMeshData();
+		const uint8_t* vertices = reinterpret_cast<const uint8_t*>(meshData.vertices);
+		const uint8_t* indices = static_cast<const uint8_t*>(meshData.indices);
+		uint64_t checksum = 0;
+		size_t indexSize = meshData.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		for(size_t i = 0; i < meshData.vertexCount * sizeof(Model::Vertex); i += 64)
+		{
+			checksum += vertices[i];
+		}
+		for(size_t i = 0; i < meshData.indexCount * indexSize; i += 64)
+		{
+			checksum += indices[i];
+		}
+		g_sink = checksum;
+	});
+
+	std::vector<Model::CompactVertex> compactVertices;
+	glm::mat4 dequantizeMatrix{ 1.0f };
+	QuantizationError error = quantizeVertices(mesh.vertices.data(), static_cast<uint32_t>(mesh.vertices.size()), compactVertices, dequantizeMatrix);
+	float diagonal = glm::length(mesh.boundingBox.max - mesh.boundingBox.min);
+
+	std::printf("%-28s %8zu vertices %8zu triangles  cold %9.3f ms  warm %7.3f ms  %6.1fx  ACMR %.3f -> %.3f  compact error %.2e (%.5f%% of bounds) %.3f deg\n",
+		std::filesystem::path(filepath).filename().string().c_str(), mesh.vertices.size(), mesh.lods.empty() ? mesh.indices.size() / 3 : mesh.lods[0].indexCount / 3,
+		cold, warm, cold / std::max(warm, 1e-6), stats.before.acmr, stats.after.acmr,
+		error.maxPositionError, diagonal > 0.0f ? 100.0f * error.maxPositionError / diagonal : 0.0f, error.maxNormalError);
+	std::fflush(stdout);
+}
+
+// Both de-duplicate every corner of the file on one thread, starting from the size hint Mesh::load gives
+static void benchmarkVertexTable(const std::string& filepath)
+{
+	ObjData obj;
+	parseObj(filepath, obj);
+
+	std::vector<Model::Vertex> corners(obj.indices.size());
+	for(size_t i = 0; i < corners.size(); i++)
+	{
+		const ObjIndex& index = obj.indices[i];
+		Model::Vertex& corner = corners[i];
+		corner.position = { obj.positions[3 * index.position + 0], obj.positions[3 * index.position + 1], obj.positions[3 * index.position + 2] };
+		corner.color = { obj.colors[3 * index.position + 0], obj.colors[3 * index.position + 1], obj.colors[3 * index.position + 2] };
+		if(index.normal >= 0)
+		{
+			corner.normal = { obj.normals[3 * index.normal + 0], obj.normals[3 * index.normal + 1], obj.normals[3 * index.normal + 2] };
+		}
+		if(index.texcoord >= 0)
+		{
+			corner.texcoord = { obj.texcoords[2 * index.texcoord + 0], obj.texcoords[2 * index.texcoord + 1] };
+		}
+	}
+	size_t expectedCount = obj.positions.size() / 3;
+
+	std::vector<Model::Vertex> tableVertices;
+	std::vector<uint32_t> tableIndices(corners.size());
+	double table = measure([&]()
+	{
+		tableVertices.clear();
+		VertexTable uniqueVertices{ expectedCount };
+		for(size_t i = 0; i < corners.size(); i++)
+		{
+			tableIndices[i] = uniqueVertices.findOrInsert(corners[i], tableVertices);
+		}
+	});
+
+	std::vector<Model::Vertex> mapVertices;
+	std::vector<uint32_t> mapIndices(corners.size());
+	double map = measure([&]()
+	{
+		mapVertices.clear();
+		std::unordered_map<Model::Vertex, uint32_t> uniqueVertices;
+		uniqueVertices.reserve(expectedCount);
+		for(size_t i = 0; i < corners.size(); i++)
+		{
+			auto result = uniqueVertices.try_emplace(corners[i], static_cast<uint32_t>(mapVertices.size()));
+			if(result.second)
+			{
+				mapVertices.push_back(corners[i]);
+			}
+			mapIndices[i] = result.first->second;
+		}
+	});
+
+	if(tableIndices != mapIndices || tableVertices.size() != mapVertices.size())
+	{
+		throw std::runtime_error("failed to benchmark vertex de-duplication: results differ!");
+	}
+
+	std::printf("%-28s %8zu corners  %8zu unique  VertexTable %8.3f ms (%5.1f ns/corner)  unordered_map %8.3f ms (%5.1f ns/corner)  %4.1fx\n",
+		std::filesystem::path(filepath).filename().string().c_str(), corners.size(), tableVertices.size(),
+		table, table * 1e6 / std::max<size_t>(corners.size(), 1), map, map * 1e6 / std::max<size_t>(corners.size(), 1), map / std::max(table, 1e-6));
+	std::fflush(stdout);
+}
+
+// Both read the same file, parseObj on the engine thread pool and tinyobj on one thread as Mesh::load used it before.
+// parseObj only splits files of more than a MiB per chunk, so smaller ones show its single thread speed.
+static void benchmarkObjParser(const std::string& filepath)
+{
+	// the pool workers and the calling thread, which takes part in parallelFor
+	uint32_t threadCount = ThreadPool::get().getThreadCount() + 1;
+
+	ObjData obj;
+	double parser = measure([&]()
+	{
+		obj = {};
+		parseObj(filepath, obj);
+	});
+
+	tinyobj::attrib_t attrib;
+	std::vector<tinyobj::shape_t> shapes;
+	double tinyobj = measure([&]()
+	{
+		attrib = {};
+		shapes.clear();
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+		if(!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str()))
+		{
+			throw std::runtime_error(warn + err);
+		}
+	});
+
+	// all shapes form one triangle list in file order, like parseObj returns it
+	bool arraysMatch = attrib.vertices == obj.positions && attrib.colors == obj.colors && attrib.normals == obj.normals && attrib.texcoords == obj.texcoords;
+	size_t mismatchCount = arraysMatch ? 0 : 1;
+	size_t corner = 0;
+	for(const tinyobj::shape_t& shape : shapes)
+	{
+		for(const tinyobj::index_t& index : shape.mesh.indices)
+		{
+			const ObjIndex* pIndex = corner < obj.indices.size() ? &obj.indices[corner] : nullptr;
+			if(!pIndex || pIndex->position != index.vertex_index || pIndex->normal != index.normal_index || pIndex->texcoord != index.texcoord_index)
+			{
+				mismatchCount++;
+			}
+			corner++;
+		}
+	}
+	if(mismatchCount > 0 || corner != obj.indices.size())
+	{
+		throw std::runtime_error("failed to benchmark obj parsing: results differ!");
+	}
+
+	double megabytes = static_cast<double>(std::filesystem::file_size(filepath)) / (1024.0 * 1024.0);
+	std::printf("%-28s %8.2f MiB  parseObj on %2u threads %9.3f ms (%7.1f MiB/s)  tinyobj %9.3f ms (%7.1f MiB/s)  %5.1fx\n",
+		std::filesystem::path(filepath).filename().string().c_str(), megabytes, threadCount,
+		parser, megabytes * 1000.0 / std::max(parser, 1e-6), tinyobj, megabytes * 1000.0 / std::max(tinyobj, 1e-6), tinyobj / std::max(parser, 1e-6));
+	std::fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t syntheticTriangles = DEFAULT_SYNTHETIC_TRIANGLES;
+	std::vector<std::filesystem::path> paths;
+	for(int i = 1; i < argc; i++)
+	{
+		if(std::string(argv[i]) == "--synthetic" && i + 1 < argc)
+		{
+			syntheticTriangles = static_cast<uint32_t>(std::stoul(argv[++i]));
+			continue;
+		}
+		paths.push_back(argv[i]);
+	}
+	if(paths.empty())
+	{
+		paths.push_back(std::string(ENGINE_DIR) + "models");
+	}
+
+	std::vector<std::string> files;
+	for(const std::filesystem::path& path : paths)
+	{
+		if(!std::filesystem::is_directory(path))
+		{
+			files.push_back(path.string());
+			continue;
+		}
+
+		for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path))
+		{
+			if(entry.path().extension() == ".obj")
+			{
+				files.push_back(entry.path().string());
+			}
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	std::string syntheticFile;
+	int result = 0;
+	try
+	{
+		if(syntheticTriangles > 0)
+		{
+			syntheticFile = writeSyntheticObj(syntheticTriangles);
+			files.push_back(syntheticFile);
+		}
+
+		for(const std::string& file : files)
+		{
+			benchmarkMeshCache(file);
+		}
+		for(const std::string& file : files)
+		{
+			benchmarkVertexTable(file);
+		}
+		for(const std::string& file : files)
+		{
+			benchmarkObjParser(file);
+		}
+	}
+	catch(const std::exception& e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		result = 1;
+	}
+
+	if(!syntheticFile.empty())
+	{
+		std::error_code error;
+		std::filesystem::remove(syntheticFile, error);
+		std::filesystem::remove(MeshCache::getCachePath(syntheticFile, getCacheConfig()), error);
+	}
+	return result;
+}
@@ -0,0 +1,90 @@
+// Offline texture cooker: decodes an image, builds its mip chain and writes every level block-compressed to KTX2.
+// Usage: TextureCompressor <input image> <output.ktx2> [bc1|bc3|bc7] [linear]
+
+#include "blockCompression.h"
+#include "ktx2.h"
+#include "mipmap.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+using namespace VulkanEngine;
+
+static bool parseBlockFormat(const char* name, BlockFormat& format)
+{
+	if(std::strcmp(name, "bc1") == 0)
+	{
+		format = BlockFormat::BC1;
+	}
+	else if(std::strcmp(name, "bc3") == 0)
+	{
+		format = BlockFormat::BC3;
+	}
+	else if(std::strcmp(name, "bc7") == 0)
+	{
+		format = BlockFormat::BC7;
+	}
+	else
+	{
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BlockFormat format = BlockFormat::BC7;
+	if(argc < 3 || argc > 5 || (argc >= 4 && !parseBlockFormat(argv[3], format)) || (argc == 5 && std::strcmp(argv[4], "linear") != 0))
+	{
+		std::fprintf(stderr, "usage: %s <input image> <output.ktx2> [bc1|bc3|bc7] [linear]\n", argv[0]);
+		return 1;
+	}
+	// color textures are sRGB unless told otherwise, normal and data maps should pass linear
+	bool srgb = argc < 5;
+
+	int texWidth, texHeight, texChannels;
+	stbi_uc* pixels = stbi_load(argv[1], &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	if(!pixels)
+	{
+		std::fprintf(stderr, "failed to load %s: %s\n", argv[1], stbi_failure_reason());
+		return 1;
+	}
+
+	uint32_t width = static_cast<uint32_t>(texWidth);
+	uint32_t height = static_cast<uint32_t>(texHeight);
+	std::vector<uint8_t> chain(pixels, pixels + static_cast<size_t>(width) * height * 4);
+	stbi_image_free(pixels);
+
+	std::vector<size_t> levelOffsets = generateMipChain(chain, width, height, srgb);
+	uint32_t levelCount = static_cast<uint32_t>(levelOffsets.size() - 1);
+
+	std::vector<std::vector<uint8_t>> levels(levelCount);
+	for(uint32_t level = 0; level < levelCount; level++)
+	{
+		levels[level] = compressImage(chain.data() + levelOffsets[level], std::max(1u, width >> level), std::max(1u, height >> level), format);
+	}
+
+	try
+	{
+		Ktx2File::write(argv[2], getVkFormat(format, srgb), width, height, levels);
+	}
+	catch(const std::exception& e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	size_t compressedSize = 0;
+	for(const std::vector<uint8_t>& level : levels)
+	{
+		compressedSize += level.size();
+	}
+	std::printf("%s: %ux%u, %u levels, %zu KiB -> %zu KiB\n", argv[2], width, height, levelCount, chain.size() / 1024, compressedSize / 1024);
+	return 0;
+}